@@ -0,0 +1,5 @@
+file(WRITE "${CURRENT_PACKAGES_DIR}/include/vcpkg-remote-build-dep.h" "")
+foreach(feature IN LISTS FEATURES)
+    file(WRITE "${CURRENT_PACKAGES_DIR}/include/vcpkg-remote-build-dep-${feature}.h" "")
+endforeach()
+file(WRITE "${CURRENT_PACKAGES_DIR}/share/${PORT}/copyright" "")
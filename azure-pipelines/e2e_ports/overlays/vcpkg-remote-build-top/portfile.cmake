@@ -0,0 +1,2 @@
+file(WRITE "${CURRENT_PACKAGES_DIR}/include/vcpkg-remote-build-top.h" "")
+file(WRITE "${CURRENT_PACKAGES_DIR}/share/${PORT}/copyright" "")
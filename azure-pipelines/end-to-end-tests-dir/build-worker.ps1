@@ -0,0 +1,34 @@
+if ($IsLinux -or $IsMacOS) {
+    . $PSScriptRoot/../end-to-end-tests-prelude.ps1
+
+    # The worker is this vcpkg with its own scratch buildtrees; both sides share $ArchiveRoot as the binary cache.
+    $workerBuildtrees = Join-Path $TestingRoot 'worker-buildtrees'
+    $workerArgs = @(
+        "--x-build-worker='$VcpkgExe' --x-buildtrees-root='$workerBuildtrees' --overlay-ports='$PSScriptRoot/../e2e_ports/overlays'",
+        "--x-binarysource=clear;files,$ArchiveRoot,readwrite",
+        "--host-triplet",
+        $Triplet
+    )
+
+    # The dependency is requested without its default feature; the worker building the top port must resolve the
+    # same features, or the top port's ABI differs and it cannot be restored here.
+    $CurrentTest = "Remote build with resolved features"
+    Refresh-TestRoot
+    Run-Vcpkg -TestArgs ($commonArgs + $workerArgs + @("install", "vcpkg-remote-build-dep[core,b]", "vcpkg-remote-build-top"))
+    Throw-IfFailed
+    Require-FileExists "$installRoot/$Triplet/include/vcpkg-remote-build-top.h"
+    Require-FileExists "$installRoot/$Triplet/include/vcpkg-remote-build-dep-b.h"
+    Require-FileNotExists "$installRoot/$Triplet/include/vcpkg-remote-build-dep-a.h"
+    Require-FileExists "$buildtreesRoot/vcpkg-remote-build-top/remote-$Triplet.log"
+
+    # Dependencies installed before the remote build keep their installed features on the worker.
+    $CurrentTest = "Remote build with installed dependencies"
+    Refresh-TestRoot
+    Run-Vcpkg -TestArgs ($commonArgs + $workerArgs + @("install", "vcpkg-remote-build-dep[core,b]"))
+    Throw-IfFailed
+    Remove-Item -Recurse -Force $ArchiveRoot -ErrorAction SilentlyContinue
+    Run-Vcpkg -TestArgs ($commonArgs + $workerArgs + @("install", "vcpkg-remote-build-top"))
+    Throw-IfFailed
+    Require-FileExists "$installRoot/$Triplet/include/vcpkg-remote-build-top.h"
+    Require-FileNotExists "$installRoot/$Triplet/include/vcpkg-remote-build-dep-a.h"
+}
@@ -5,6 +5,7 @@
 #include <vcpkg/base/optional.h>
 #include <vcpkg/base/view.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -28,6 +29,10 @@ namespace vcpkg
                                      const Path& downloaded_path,
                                      const std::string& sha512);
 
+    // Takes the lock which keeps vcpkg processes from downloading the file with `sha512` into the directory of
+    // `download_path` at the same time. Callers should check whether the file was downloaded while they waited.
+    std::unique_ptr<IExclusiveFileLock> lock_download(Filesystem& fs, const Path& download_path, StringView sha512);
+
     View<std::string> azure_blob_headers();
 
     std::vector<int> download_files(Filesystem& fs, View<std::pair<std::string, Path>> url_pairs);
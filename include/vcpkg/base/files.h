@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <system_error>
+#include <vector>
 
 #if defined(_WIN32)
 #define VCPKG_PREFERRED_SEPARATOR "\\"
@@ -202,6 +203,36 @@ namespace vcpkg
         int put(int c) const noexcept { return ::fputc(c, m_fs); }
     };
 
+    // A read-only view of the contents of a file, which is mapped into memory rather than copied when the file is
+    // a regular file. Like read_contents, the view excludes a leading UTF-8 byte-order mark. Moving a MappedFile does
+    // not move the contents, so views of them stay valid.
+    struct MappedFile
+    {
+        MappedFile() = default;
+        explicit MappedFile(const Path& file_path, std::error_code& ec) noexcept;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        ~MappedFile();
+
+        StringView contents() const noexcept;
+        // the contents, including any byte-order mark
+        StringView bytes() const noexcept
+        {
+            return m_mapping ? StringView{m_mapping, m_mapping_size} : StringView{m_copy.data(), m_copy.size()};
+        }
+
+    private:
+        void unmap() noexcept;
+
+        const char* m_mapping = nullptr;
+        size_t m_mapping_size = 0;
+        // the contents of files which cannot be mapped, like pipes
+        std::vector<char> m_copy;
+    };
+
     struct IExclusiveFileLock
     {
         virtual ~IExclusiveFileLock() = default;
@@ -217,6 +248,12 @@ namespace vcpkg
         virtual std::vector<std::string> read_lines(const Path& file_path, std::error_code& ec) const = 0;
         std::vector<std::string> read_lines(const Path& file_path, LineInfo li) const;
 
+        // prefer this to read_contents and read_lines for large files which vcpkg writes and only ever replaces by
+        // renaming a new file over them, like listfiles; a mapped file which is truncated while mapped raises SIGBUS
+        // on access. Iterate lines with Strings::lines.
+        virtual MappedFile map_for_read(const Path& file_path, std::error_code& ec) const = 0;
+        MappedFile map_for_read(const Path& file_path, LineInfo li) const;
+
         virtual Path find_file_recursively_up(const Path& starting_dir,
                                               const Path& filename,
                                               std::error_code& ec) const = 0;
@@ -276,6 +313,13 @@ namespace vcpkg
         void remove_all_inside(const Path& base, std::error_code& ec);
         void remove_all_inside(const Path& base, LineInfo li);
 
+        // Renames `base` into a ".vcpkg-trash" directory next to it and removes it on a background thread, so that
+        // `base` can be recreated immediately. If it cannot be renamed, it is removed before returning. Callers which
+        // list the parent of `base` must skip ".vcpkg-trash", which is removed once it is empty.
+        virtual void remove_all_in_background(const Path& base, std::error_code& ec, Path& failure_point) = 0;
+        void remove_all_in_background(const Path& base, std::error_code& ec);
+        void remove_all_in_background(const Path& base, LineInfo li);
+
         bool exists(const Path& target, std::error_code& ec) const;
         bool exists(const Path& target, LineInfo li) const;
 
@@ -324,6 +368,23 @@ namespace vcpkg
         virtual FileType symlink_status(const Path& target, std::error_code& ec) const = 0;
         FileType symlink_status(const Path& target, LineInfo li) const noexcept;
 
+        virtual uint64_t file_size(const Path& target, std::error_code& ec) const = 0;
+        uint64_t file_size(const Path& target, LineInfo li) const;
+
+        // returns the last write time of target in nanoseconds since an implementation-defined epoch;
+        // only meaningful when compared against other results of last_write_time on the same machine
+        virtual int64_t last_write_time(const Path& target, std::error_code& ec) const = 0;
+        int64_t last_write_time(const Path& target, LineInfo li) const;
+
+        // returns whether target has its owner execute permission set; always false on Windows
+        virtual bool is_executable(const Path& target, std::error_code& ec) const = 0;
+        bool is_executable(const Path& target, LineInfo li) const;
+
+        // creates target if it doesn't exist, readable and writable by all users regardless of the umask, and sets its
+        // last write time to now; for files that several users update in a shared directory
+        virtual void touch_shared(const Path& target, std::error_code& ec) = 0;
+        void touch_shared(const Path& target, LineInfo li);
+
         virtual Path absolute(const Path& target, std::error_code& ec) const = 0;
         Path absolute(const Path& target, LineInfo li) const;
 
@@ -352,11 +413,21 @@ namespace vcpkg
                                                                              std::error_code&) = 0;
         std::unique_ptr<IExclusiveFileLock> take_exclusive_file_lock(const Path& lockfile, LineInfo li);
 
+        // waits forever for the file lock; any number of shared locks may be held at once,
+        // but they exclude, and are excluded by, exclusive locks on the same file
+        virtual std::unique_ptr<IExclusiveFileLock> take_shared_file_lock(const Path& lockfile, std::error_code&) = 0;
+        std::unique_ptr<IExclusiveFileLock> take_shared_file_lock(const Path& lockfile, LineInfo li);
+
         // waits, at most, 1.5 seconds, for the file lock
         virtual std::unique_ptr<IExclusiveFileLock> try_take_exclusive_file_lock(const Path& lockfile,
                                                                                  std::error_code&) = 0;
         std::unique_ptr<IExclusiveFileLock> try_take_exclusive_file_lock(const Path& lockfile, LineInfo li);
 
+        // waits, at most, 1.5 seconds, for the file lock
+        virtual std::unique_ptr<IExclusiveFileLock> try_take_shared_file_lock(const Path& lockfile,
+                                                                              std::error_code&) = 0;
+        std::unique_ptr<IExclusiveFileLock> try_take_shared_file_lock(const Path& lockfile, LineInfo li);
+
         virtual std::vector<Path> find_from_PATH(const std::string& name) const = 0;
 
         virtual ReadFilePointer open_for_read(const Path& file_path, std::error_code& ec) const = 0;
@@ -368,6 +439,9 @@ namespace vcpkg
 
     Filesystem& get_real_filesystem();
 
+    // blocks until everything passed to Filesystem::remove_all_in_background has been removed
+    void wait_for_background_removals();
+
     static constexpr const char* FILESYSTEM_INVALID_CHARACTERS = R"(\/:*?"<>|)";
 
     bool has_invalid_chars_for_filesystem(const std::string& s);
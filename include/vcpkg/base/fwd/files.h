@@ -5,4 +5,5 @@ namespace vcpkg
     struct IgnoreErrors;
     struct Filesystem;
     struct Path;
+    struct IExclusiveFileLock;
 }
@@ -3,9 +3,13 @@
 #include <vcpkg/base/checks.h>
 #include <vcpkg/base/lineinfo.h>
 #include <vcpkg/base/messages.h>
+#include <vcpkg/base/span.h>
+
+#include <stdint.h>
 
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace vcpkg::Graphs
@@ -58,25 +62,45 @@ namespace vcpkg::Graphs
         }
 
         template<class V, class U>
-        void topological_sort_internal(const V& vertex,
-                                       const AdjacencyProvider<V, U>& f,
-                                       std::unordered_map<V, ExplorationStatus>& exploration_status,
-                                       std::vector<U>& sorted,
-                                       Randomizer* randomizer)
+        struct TopologicalSortFrame
         {
-            ExplorationStatus& status = exploration_status[vertex];
+            V vertex;
+            size_t id;
+            U data;
+            std::vector<V> neighbours;
+            size_t next_neighbour;
+        };
+    }
+
+    // Depth-first topological sort: each vertex comes after everything in its adjacency list. The traversal keeps
+    // an explicit stack, so deep graphs cannot exhaust the call stack, and each discovered vertex gets a dense id so
+    // its exploration status is a vector lookup.
+    template<class Range, class V, class U>
+    std::vector<U> topological_sort(Range starting_vertices, const AdjacencyProvider<V, U>& f, Randomizer* randomizer)
+    {
+        std::vector<U> sorted;
+        std::unordered_map<V, size_t> ids;
+        std::vector<ExplorationStatus> exploration_status;
+        std::vector<details::TopologicalSortFrame<V, U>> stack;
+
+        const auto visit = [&](const V& vertex) {
+            const auto id = ids.emplace(vertex, exploration_status.size());
+            if (id.second)
+            {
+                exploration_status.push_back(ExplorationStatus::NOT_EXPLORED);
+            }
+
+            ExplorationStatus& status = exploration_status[id.first->second];
             switch (status)
             {
                 case ExplorationStatus::FULLY_EXPLORED: return;
                 case ExplorationStatus::PARTIALLY_EXPLORED:
                 {
+                    // the partially explored vertices are exactly those on the stack
                     msg::println(msgGraphCycleDetected, msg::package_name = vertex);
-                    for (auto&& node : exploration_status)
+                    for (auto&& frame : stack)
                     {
-                        if (node.second == ExplorationStatus::PARTIALLY_EXPLORED)
-                        {
-                            msg::println(msgGraphCycleDetectedElement, msg::package_name = node.first);
-                        }
+                        msg::println(msgGraphCycleDetectedElement, msg::package_name = frame.vertex);
                     }
                     Checks::exit_fail(VCPKG_LINE_INFO);
                 }
@@ -86,31 +110,75 @@ namespace vcpkg::Graphs
                     U vertex_data = f.load_vertex_data(vertex);
                     auto neighbours = f.adjacency_list(vertex_data);
                     details::shuffle(neighbours, randomizer);
-                    for (const V& neighbour : neighbours)
-                        topological_sort_internal(neighbour, f, exploration_status, sorted, randomizer);
-
-                    sorted.push_back(std::move(vertex_data));
-                    status = ExplorationStatus::FULLY_EXPLORED;
+                    stack.push_back({vertex, id.first->second, std::move(vertex_data), std::move(neighbours), 0});
                     return;
                 }
                 default: Checks::unreachable(VCPKG_LINE_INFO);
             }
-        }
-    }
-
-    template<class Range, class V, class U>
-    std::vector<U> topological_sort(Range starting_vertices, const AdjacencyProvider<V, U>& f, Randomizer* randomizer)
-    {
-        std::vector<U> sorted;
-        std::unordered_map<V, ExplorationStatus> exploration_status;
+        };
 
         details::shuffle(starting_vertices, randomizer);
 
         for (auto&& vertex : starting_vertices)
         {
-            details::topological_sort_internal(vertex, f, exploration_status, sorted, randomizer);
+            visit(vertex);
+            while (!stack.empty())
+            {
+                auto& top = stack.back();
+                if (top.next_neighbour < top.neighbours.size())
+                {
+                    // copied, since visiting may grow the stack and move `top`
+                    const V neighbour = top.neighbours[top.next_neighbour++];
+                    visit(neighbour);
+                }
+                else
+                {
+                    exploration_status[top.id] = ExplorationStatus::FULLY_EXPLORED;
+                    sorted.push_back(std::move(top.data));
+                    stack.pop_back();
+                }
+            }
         }
 
         return sorted;
     }
+
+    // A directed graph over the vertices [0, vertex_count()), stored as one flat edge array indexed by offsets. An
+    // edge from `a` to `b` means that `a` depends on `b`, as with AdjacencyProvider.
+    struct DenseGraph
+    {
+        DenseGraph(size_t vertex_count, View<std::pair<uint32_t, uint32_t>> edges);
+
+        size_t vertex_count() const { return m_edge_starts.size() - 1; }
+        View<uint32_t> dependencies(uint32_t vertex) const
+        {
+            return {m_edges.data() + m_edge_starts[vertex], m_edge_starts[vertex + 1] - m_edge_starts[vertex]};
+        }
+
+    private:
+        std::vector<size_t> m_edge_starts;
+        std::vector<uint32_t> m_edges;
+    };
+
+    struct TopologicalLevels
+    {
+        // every vertex comes after its dependencies
+        std::vector<uint32_t> order;
+        // Level i is order[level_starts[i], level_starts[i + 1]). Vertices depend only on vertices in earlier levels,
+        // so all of a level can be processed in parallel once the levels before it are done.
+        std::vector<size_t> level_starts;
+        // If the graph is cyclic, the vertices of one cycle, each depending on the next. Vertices on or depending on
+        // a cycle are left out of `order`.
+        std::vector<uint32_t> cycle;
+
+        size_t level_count() const { return level_starts.size() - 1; }
+        View<uint32_t> level(size_t index) const
+        {
+            return {order.data() + level_starts[index], level_starts[index + 1] - level_starts[index]};
+        }
+    };
+
+    // Kahn's algorithm, one level at a time: level 0 holds the vertices without dependencies, and each later level
+    // the vertices whose last dependency was in the level before. Vertices within a level are in ascending order.
+    TopologicalLevels topological_levels(const DenseGraph& graph);
 }
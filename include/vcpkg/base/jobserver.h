@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vcpkg/base/fwd/system.process.h>
+
+#include <vcpkg/base/optional.h>
+#include <vcpkg/base/stringview.h>
+
+#include <stddef.h>
+
+#include <string>
+
+namespace vcpkg
+{
+    // The jobserver shares one budget of get_concurrency() jobs between vcpkg's own parallel work and every build it
+    // launches, using GNU make's protocol: each job beyond the first needs a token taken from a shared pipe (a named
+    // semaphore on Windows) and gives it back when it is done. If vcpkg is itself run by a make jobserver (MAKEFLAGS
+    // carries --jobserver-auth), it joins that jobserver instead of creating one, or creates its own if joining fails.
+    // Either way MAKEFLAGS is removed from vcpkg's environment and the jobserver's descriptors are close-on-exec; only
+    // port builds are given the jobserver, by add_jobserver_to_environment.
+    //
+    // Must be called once at startup, before any threads or subprocesses are created. Until it is called, tokens are
+    // always granted.
+    void initialize_jobserver();
+
+    // The MAKEFLAGS that let a port build take part in the jobserver, or nullopt if there is no jobserver.
+    Optional<std::string> get_jobserver_makeflags();
+
+    // Gives the process launched with `env` the jobserver: its MAKEFLAGS, and the descriptors they name.
+    void add_jobserver_to_environment(Environment& env);
+
+    struct JobserverAuth
+    {
+        // the "R,W" descriptor pair used by the pipe protocol
+        int read_fd = -1;
+        int write_fd = -1;
+        // the path after "fifo:" on POSIX, or the semaphore name on Windows
+        std::string name;
+    };
+
+    // parses the last --jobserver-auth= (or the older --jobserver-fds=) option out of a MAKEFLAGS value
+    Optional<JobserverAuth> parse_jobserver_auth(StringView makeflags);
+
+    // Takes up to `count` job tokens without waiting for any; returns how many were taken.
+    size_t try_acquire_job_tokens(size_t count);
+    void release_job_tokens(size_t count);
+
+    struct JobTokens
+    {
+        explicit JobTokens(size_t wanted) : m_count(try_acquire_job_tokens(wanted)) { }
+        JobTokens(const JobTokens&) = delete;
+        JobTokens& operator=(const JobTokens&) = delete;
+        ~JobTokens() { release_job_tokens(m_count); }
+
+        size_t count() const noexcept { return m_count; }
+
+    private:
+        size_t m_count;
+    };
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vcpkg/base/jobserver.h>
+#include <vcpkg/base/system.h>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <vector>
+
+namespace vcpkg
+{
+    // runs `work` on up to min(get_concurrency(), work_count) threads, including the calling thread,
+    // and waits for all of them to return; each thread beyond the calling one holds a jobserver token
+    template<class F>
+    void execute_in_parallel(size_t work_count, F&& work)
+    {
+        const auto num_threads =
+            static_cast<size_t>(std::max(1, std::min(get_concurrency(), static_cast<int>(work_count))));
+
+        JobTokens tokens(num_threads - 1);
+        std::vector<std::future<void>> workers;
+        workers.reserve(tokens.count());
+        for (size_t x = 0; x < tokens.count(); ++x)
+        {
+            workers.emplace_back(std::async(std::launch::async | std::launch::deferred, [&work]() { work(); }));
+        }
+
+        work();
+
+        for (auto&& w : workers)
+        {
+            w.get();
+        }
+    }
+
+    // calls cb(*(first + i)) for each i in [0, work_count), distributing the calls across threads
+    template<class RandomIt, class F>
+    void parallel_for_each_n(RandomIt first, size_t work_count, F&& cb)
+    {
+        if (work_count == 0)
+        {
+            return;
+        }
+
+        if (work_count == 1)
+        {
+            cb(*first);
+            return;
+        }
+
+        std::atomic<size_t> work_item{0};
+        execute_in_parallel(work_count, [&]() {
+            for (size_t item = work_item.fetch_add(1); item < work_count; item = work_item.fetch_add(1))
+            {
+                cb(*(first + item));
+            }
+        });
+    }
+
+    // sets *(out_first + i) = cb(*(first + i)) for each i in [0, work_count), distributing the calls across threads
+    template<class RandomIt, class OutRandomIt, class F>
+    void parallel_transform(RandomIt first, size_t work_count, OutRandomIt out_first, F&& cb)
+    {
+        if (work_count == 0)
+        {
+            return;
+        }
+
+        if (work_count == 1)
+        {
+            *out_first = cb(*first);
+            return;
+        }
+
+        std::atomic<size_t> work_item{0};
+        execute_in_parallel(work_count, [&]() {
+            for (size_t item = work_item.fetch_add(1); item < work_count; item = work_item.fetch_add(1))
+            {
+                *(out_first + item) = cb(*(first + item));
+            }
+        });
+    }
+}
@@ -10,6 +10,7 @@
 #include <limits.h>
 
 #include <algorithm>
+#include <iterator>
 #include <vector>
 
 namespace vcpkg::Strings::details
@@ -312,6 +313,61 @@ namespace vcpkg::Strings
         std::string previous_partial_line;
     };
 
+    // Iterates over the lines of a string without copying them, breaking lines like LinesStream: \r\n, \r, and \n
+    // each end a line, and the text after the last line break, even if empty, is the last line.
+    struct LineIterator
+    {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = StringView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const StringView*;
+        using reference = const StringView&;
+
+        LineIterator() = default;
+        explicit LineIterator(StringView text) noexcept : m_rest(text.begin()), m_last(text.end()), m_has_rest(true)
+        {
+            ++*this;
+        }
+
+        reference operator*() const noexcept { return m_line; }
+        pointer operator->() const noexcept { return &m_line; }
+
+        LineIterator& operator++() noexcept;
+        LineIterator operator++(int) noexcept
+        {
+            auto result = *this;
+            ++*this;
+            return result;
+        }
+
+        friend bool operator==(const LineIterator& lhs, const LineIterator& rhs) noexcept
+        {
+            return lhs.m_done == rhs.m_done && (lhs.m_done || lhs.m_line.data() == rhs.m_line.data());
+        }
+        friend bool operator!=(const LineIterator& lhs, const LineIterator& rhs) noexcept { return !(lhs == rhs); }
+
+    private:
+        // the text after m_line; m_has_rest is false once m_line is the last line
+        const char* m_rest = nullptr;
+        const char* m_last = nullptr;
+        StringView m_line;
+        bool m_has_rest = false;
+        bool m_done = true;
+    };
+
+    struct LineRange
+    {
+        explicit LineRange(StringView text) noexcept : m_text(text) { }
+
+        LineIterator begin() const noexcept { return LineIterator{m_text}; }
+        LineIterator end() const noexcept { return LineIterator{}; }
+
+    private:
+        StringView m_text;
+    };
+
+    inline LineRange lines(StringView text) noexcept { return LineRange{text}; }
+
     struct LinesCollector
     {
         void on_data(StringView sv);
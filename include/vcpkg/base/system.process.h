@@ -3,6 +3,7 @@
 #include <vcpkg/base/fwd/system.process.h>
 
 #include <vcpkg/base/files.h>
+#include <vcpkg/base/optional.h>
 #include <vcpkg/base/view.h>
 #include <vcpkg/base/zstringview.h>
 
@@ -86,18 +87,35 @@ namespace vcpkg
         std::string output;
     };
 
+    // The resources used by a process and all of the descendants it waited for.
+    struct ProcessResourceUsage
+    {
+        uint64_t user_cpu_us = 0;
+        uint64_t system_cpu_us = 0;
+        // of the largest single process in the tree
+        uint64_t peak_rss_bytes = 0;
+        uint64_t blocks_read = 0;
+        uint64_t blocks_written = 0;
+    };
+
+    std::string format_resource_usage(const ProcessResourceUsage& usage);
+
     struct Environment
     {
 #if defined(_WIN32)
         std::wstring m_env_data;
 #else  // ^^^ _WIN32 // !_WIN32 vvv
         std::string m_env_data;
+        // close-on-exec descriptors which cmd_execute_and_stream_data passes on to the launched process anyway
+        std::vector<int> m_inherited_fds;
 #endif // ^^^ !_WIN32
     };
 
     const Environment& get_clean_environment();
     Environment get_modified_clean_environment(const std::unordered_map<std::string, std::string>& extra_env,
                                                StringView prepend_to_path = {});
+    // Sets name=value in env for the launched process, on top of what env already holds.
+    void add_environment_variable(Environment& env, StringView name, StringView value);
 
     struct WorkingDirectory
     {
@@ -125,6 +143,13 @@ namespace vcpkg
                                                      Encoding encoding = Encoding::Utf8,
                                                      EchoInDebug echo_in_debug = EchoInDebug::Hide);
 
+    // Like cmd_execute_and_capture_output, except that the process reads its standard input from `input_file`.
+    ExitCodeAndOutput cmd_execute_and_capture_output_with_input_file(
+        const Command& cmd_line,
+        const Path& input_file,
+        const WorkingDirectory& wd = default_working_directory,
+        const Environment& env = default_environment);
+
     std::vector<ExitCodeAndOutput> cmd_execute_and_capture_output_parallel(
         View<Command> cmd_lines,
         const WorkingDirectory& wd = default_working_directory,
@@ -136,11 +161,14 @@ namespace vcpkg
                                      const Environment& env = default_environment,
                                      Encoding encoding = Encoding::Utf8);
 
+    // If `resource_usage` is not null, it receives the resources used by the process tree; this is only collected on
+    // POSIX systems and is left empty elsewhere.
     int cmd_execute_and_stream_data(const Command& cmd_line,
                                     std::function<void(StringView)> data_cb,
                                     const WorkingDirectory& wd = default_working_directory,
                                     const Environment& env = default_environment,
-                                    Encoding encoding = Encoding::Utf8);
+                                    Encoding encoding = Encoding::Utf8,
+                                    Optional<ProcessResourceUsage>* resource_usage = nullptr);
 
     uint64_t get_subproccess_stats();
 
@@ -127,6 +127,13 @@ namespace vcpkg
         /// Returns a vector where each index corresponds to the matching index in `actions`.
         std::vector<CacheAvailability> precheck(View<Dependencies::InstallPlanAction> actions);
 
+        /// Returns whether `action` has been restored into the packages directory by this cache.
+        bool is_restored(const Dependencies::InstallPlanAction& action) const;
+
+        /// Forgets whether `action` is known to be cached and asks the providers again, restoring it if one has it.
+        /// Used after another process has pushed it or changed the packages directory.
+        void refresh_status(const Dependencies::InstallPlanAction& action);
+
     private:
         std::unordered_map<std::string, CacheStatus> m_status;
         std::vector<std::unique_ptr<IBinaryProvider>> m_providers;
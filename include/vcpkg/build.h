@@ -17,6 +17,7 @@
 #include <vcpkg/vcpkgpaths.h>
 
 #include <array>
+#include <functional>
 #include <map>
 #include <set>
 #include <vector>
@@ -152,6 +153,14 @@ namespace vcpkg::Build
         YES
     };
 
+    enum class BuildOutput
+    {
+        // every line of the build's output is echoed to the console
+        FULL = 0,
+        // only status lines are echoed; the end of the log is printed if the build fails
+        TAIL
+    };
+
     struct BuildPackageOptions
     {
         BuildMissing build_missing;
@@ -165,6 +174,7 @@ namespace vcpkg::Build
         PurgeDecompressFailure purge_decompress_failure;
         Editable editable;
         BackcompatFeatures backcompat_features;
+        BuildOutput build_output;
     };
 
     static constexpr BuildPackageOptions default_build_package_options{
@@ -179,6 +189,7 @@ namespace vcpkg::Build
         Build::PurgeDecompressFailure::YES,
         Build::Editable::NO,
         Build::BackcompatFeatures::ALLOW,
+        Build::BuildOutput::FULL,
     };
 
     static constexpr BuildPackageOptions backcompat_prohibiting_package_options{
@@ -193,6 +204,7 @@ namespace vcpkg::Build
         Build::PurgeDecompressFailure::YES,
         Build::Editable::NO,
         Build::BackcompatFeatures::PROHIBIT,
+        Build::BuildOutput::FULL,
     };
 
     struct BuildResultCounts
@@ -262,6 +274,8 @@ namespace vcpkg::Build
         BuildResult code;
         std::vector<FeatureSpec> unmet_dependencies;
         std::unique_ptr<BinaryControlFile> binary_control_file;
+        // of the port's build, if it ran and the platform reports it
+        Optional<ProcessResourceUsage> resource_usage;
     };
 
     ExtendedBuildResult build_package(const VcpkgCmdArguments& args,
@@ -271,6 +285,48 @@ namespace vcpkg::Build
                                       const IBuildLogsRecorder& build_logs_recorder,
                                       const StatusParagraphs& status_db);
 
+    // Decides where the packages of an install plan are built.
+    struct IBuildExecutor
+    {
+        virtual ~IBuildExecutor() = default;
+
+        // Called once before the plan is installed. An executor which can build several packages at once may build
+        // `actions` ahead of time here; those packages must afterwards be restorable from `binary_cache`.
+        virtual void prebuild(const VcpkgPaths& paths,
+                              View<Dependencies::InstallPlanAction> actions,
+                              BinaryCache& binary_cache,
+                              const StatusParagraphs& status_db);
+
+        // Whether prebuild builds several packages at once, so that the order of the plan changes how long it takes.
+        virtual bool builds_concurrently() const { return false; }
+
+        // Builds `action` into the packages directory, like build_package.
+        virtual ExtendedBuildResult build(const VcpkgCmdArguments& args,
+                                          const VcpkgPaths& paths,
+                                          const Dependencies::InstallPlanAction& action,
+                                          BinaryCache& binary_cache,
+                                          const IBuildLogsRecorder& build_logs_recorder,
+                                          const StatusParagraphs& status_db) = 0;
+    };
+
+    // Builds each package on this machine with build_package.
+    struct LocalBuildExecutor final : IBuildExecutor
+    {
+        ExtendedBuildResult build(const VcpkgCmdArguments& args,
+                                  const VcpkgPaths& paths,
+                                  const Dependencies::InstallPlanAction& action,
+                                  BinaryCache& binary_cache,
+                                  const IBuildLogsRecorder& build_logs_recorder,
+                                  const StatusParagraphs& status_db) override;
+    };
+
+    // Sends builds to the worker commands in `args.build_workers`, each of which must run `vcpkg x-build-worker` on a
+    // builder equivalent to this machine; see build.remote.cpp.
+    std::unique_ptr<IBuildExecutor> make_remote_build_executor(const VcpkgCmdArguments& args);
+
+    // Returns the executor chosen by `args`: remote when --x-build-worker is passed, otherwise local.
+    std::unique_ptr<IBuildExecutor> make_build_executor(const VcpkgCmdArguments& args);
+
     enum class BuildPolicy
     {
         EMPTY_PACKAGE,
@@ -350,6 +406,8 @@ namespace vcpkg::Build
         std::string id;
         std::string version;
         std::string hash;
+        // the CMAKE_C_COMPILER and CMAKE_CXX_COMPILER the toolchain resolved, if the detection scripts reported them
+        std::vector<std::string> paths;
     };
 
     struct AbiInfo
@@ -362,10 +420,20 @@ namespace vcpkg::Build
         Optional<const CompilerInfo&> compiler_info;
     };
 
+    // Computes the ABIs of the install actions in plan order. If `on_computed` is set, it is called with n after the
+    // first n install actions have theirs, so that work on them can start while the rest are computed.
     void compute_all_abis(const VcpkgPaths& paths,
                           Dependencies::ActionPlan& action_plan,
                           const CMakeVars::CMakeVarProvider& var_provider,
-                          const StatusParagraphs& status_db);
+                          const StatusParagraphs& status_db,
+                          const std::function<void(size_t)>& on_computed = nullptr);
+
+    // appends the path, size, and modification time of `file`, for keys that must change whenever the file does
+    void append_file_identity(std::string& key_material, const Filesystem& fs, const Path& file);
+
+    // Appends the environment variables that can change which compiler a build uses and how it is invoked.
+    // `extra_env_vars` are tracked in addition to the usual compiler variables.
+    void append_build_environment_identity(std::string& key_material, View<std::string> extra_env_vars);
 
     struct EnvCache
     {
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vcpkg/base/fwd/files.h>
+
+#include <vcpkg/fwd/dependencies.h>
+#include <vcpkg/fwd/installedpaths.h>
+
+#include <vcpkg/base/optional.h>
+#include <vcpkg/base/span.h>
+
+#include <vcpkg/packagespec.h>
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vcpkg
+{
+    // How long the last successful build of each port took, how much memory it used, and how large its package was,
+    // by port and triplet, as recorded in installed/vcpkg/build-history.json. Used to schedule builds, to estimate how
+    // long they will take, and to keep them within a memory budget.
+    struct BuildHistory
+    {
+        struct Entry
+        {
+            uint64_t build_time_us = 0;
+            uint64_t package_size = 0;
+            // of the largest process of the build, 0 if unknown
+            uint64_t peak_rss_bytes = 0;
+        };
+
+        // a missing or malformed history is empty
+        static BuildHistory load(const Filesystem& fs, const InstalledPaths& installed);
+
+        bool empty() const noexcept { return m_entries.empty(); }
+        Optional<const Entry&> get(const PackageSpec& spec) const;
+        void set(const PackageSpec& spec, const Entry& entry);
+
+        // the recorded build time of `spec`; ports which were never built are assumed to take as long as the average
+        // recorded port, so that the order of unknown ports only depends on the shape of the plan
+        uint64_t estimated_build_time_us(const PackageSpec& spec) const;
+
+        // Writes the history, replacing the file atomically. Failing to write it only loses the records.
+        void save(Filesystem& fs, const InstalledPaths& installed) const;
+
+    private:
+        // keyed by PackageSpec::to_string()
+        std::map<std::string, Entry> m_entries;
+        uint64_t m_total_build_time_us = 0;
+    };
+
+    // Records a successful build of `spec` in the history of `installed`, which other processes may also be updating.
+    // An unknown peak_rss_bytes keeps the one recorded before.
+    void record_build(Filesystem& fs,
+                      const InstalledPaths& installed,
+                      const PackageSpec& spec,
+                      const BuildHistory::Entry& entry);
+
+    // the total size of the files in `package_dir`, for BuildHistory::Entry::package_size
+    uint64_t get_package_size(const Filesystem& fs, const Path& package_dir);
+
+    // The estimated build time of each action plus that of the slowest chain of actions in `actions` depending on it,
+    // by index into `actions`, in which every action comes after its dependencies.
+    std::vector<uint64_t> remaining_critical_paths(View<Dependencies::InstallPlanAction> actions,
+                                                   const BuildHistory& history);
+
+    // Reorders `actions`, in which every action comes after its dependencies, so that it still does, and so that of the
+    // actions whose dependencies have all come before, the one with the longest remaining critical path comes first.
+    // Starting the slowest chains of builds first shortens plans whose builds run concurrently.
+    void order_by_critical_path(std::vector<Dependencies::InstallPlanAction>& actions, const BuildHistory& history);
+}
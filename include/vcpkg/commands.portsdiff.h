@@ -1,9 +1,47 @@
 #pragma once
 
+#include <vcpkg/fwd/paragraphparser.h>
+
+#include <vcpkg/base/stringview.h>
+#include <vcpkg/base/view.h>
+
 #include <vcpkg/commands.interface.h>
+#include <vcpkg/versions.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace vcpkg::Commands::PortsDiff
 {
+    struct UpdatedPort
+    {
+        std::string port;
+        VersionDiff version_diff;
+    };
+
+    struct PortChanges
+    {
+        std::vector<std::string> added_ports;
+        std::vector<std::string> removed_ports;
+        std::vector<UpdatedPort> updated_ports;
+    };
+
+    PortChanges find_port_changes(const std::map<std::string, Version>& previous_names_and_versions,
+                                  const std::map<std::string, Version>& current_names_and_versions);
+
+    // The input for `git cat-file --batch` which reads the vcpkg.json and then the CONTROL file of each port in
+    // `port_trees`, a port name and its tree object each.
+    std::string make_port_files_batch(View<std::pair<std::string, std::string>> port_trees);
+
+    // Reads the versions of the ports in `port_trees` from the output of `git cat-file --batch` for the input
+    // make_port_files_batch gives for them. Ports whose files are missing or do not parse are added to `errors`.
+    std::map<std::string, Version> parse_port_files_batch(View<std::pair<std::string, std::string>> port_trees,
+                                                          StringView batch_output,
+                                                          std::vector<std::unique_ptr<ParseControlErrorInfo>>& errors);
+
     void perform_and_exit(const VcpkgCmdArguments& args, const VcpkgPaths& paths);
 
     struct PortsDiffCommand : PathsCommand
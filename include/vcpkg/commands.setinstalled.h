@@ -15,7 +15,8 @@ namespace vcpkg::Commands::SetInstalled
                              Dependencies::ActionPlan action_plan,
                              DryRun dry_run,
                              const Optional<Path>& pkgsconfig_path,
-                             Triplet host_triplet);
+                             Triplet host_triplet,
+                             const Optional<std::string>& manifest_inputs_fingerprint = nullopt);
     void perform_and_exit(const VcpkgCmdArguments& args,
                           const VcpkgPaths& paths,
                           Triplet default_triplet,
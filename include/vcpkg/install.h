@@ -69,16 +69,26 @@ namespace vcpkg::Install
         SUCCESS,
     };
 
-    void install_package_and_write_listfile(Filesystem& fs, const Path& source_dir, const InstallDir& destination_dir);
+    // `replaced_files` are the sorted listfile paths of the files a removed version of the package left in the
+    // installed tree; those which already have the contents being installed are not copied again
+    void install_package_and_write_listfile(Filesystem& fs,
+                                            const Path& source_dir,
+                                            const InstallDir& destination_dir,
+                                            View<std::string> replaced_files = {});
 
     void install_files_and_write_listfile(Filesystem& fs,
                                           const Path& source_dir,
                                           const std::vector<Path>& files,
-                                          const InstallDir& destination_dir);
+                                          const InstallDir& destination_dir,
+                                          View<std::string> replaced_files = {});
 
+    // `replaced_files` are the listfile paths of the files a removed version of the package left in the installed
+    // tree, as returned by Remove::perform_replace_plan_action; the package is installed over them, and any it does not
+    // have are removed
     InstallResult install_package(const VcpkgPaths& paths,
                                   const BinaryControlFile& binary_paragraph,
-                                  StatusParagraphs* status_db);
+                                  StatusParagraphs* status_db,
+                                  std::vector<std::string> replaced_files = {});
 
     InstallSummary perform(const VcpkgCmdArguments& args,
                            Dependencies::ActionPlan& action_plan,
@@ -120,4 +130,26 @@ namespace vcpkg::Install
     };
 
     void track_install_plan(Dependencies::ActionPlan& plan);
+
+    // The inputs of a manifest-mode install that are only known once its ABIs are computed.
+    struct ManifestBuildInputs
+    {
+        // the VCPKG_ENV_PASSTHROUGH variables of every triplet in the plan
+        std::set<std::string> env_vars;
+        // the compilers the triplets' toolchains resolved
+        std::set<std::string> compilers;
+        // the directories the plan's ports were loaded from, and the registry files their versions were resolved from
+        std::set<std::string> port_inputs;
+        // false if some package's ABI depends on a compiler whose path the detection scripts did not report
+        bool complete = true;
+    };
+
+    ManifestBuildInputs collect_manifest_build_inputs(const VcpkgPaths& paths,
+                                                      View<Dependencies::InstallPlanAction> actions);
+
+    // Records that a manifest-mode install whose inputs hash to `inputs_fingerprint` completed, so that repeating it
+    // (as the CMake toolchain does on every configure) can return before resolving versions or computing ABIs.
+    void write_manifest_install_fingerprint(const VcpkgPaths& paths,
+                                            StringView inputs_fingerprint,
+                                            const ManifestBuildInputs& build_inputs);
 }
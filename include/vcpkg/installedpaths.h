@@ -19,7 +19,12 @@ namespace vcpkg
         Path vcpkg_dir_status_file() const { return vcpkg_dir() / "status"; }
         Path vcpkg_dir_info() const { return vcpkg_dir() / "info"; }
         Path vcpkg_dir_updates() const { return vcpkg_dir() / "updates"; }
+        Path vcpkg_dir_replaced() const { return vcpkg_dir() / "replaced"; }
+        Path vcpkg_dir_status_lock() const { return vcpkg_dir() / "status.lock"; }
         Path lockfile_path() const { return vcpkg_dir() / "vcpkg-lock.json"; }
+        Path build_history_path() const { return vcpkg_dir() / "build-history.json"; }
+        Path build_history_lock() const { return vcpkg_dir() / "build-history.lock"; }
+        Path manifest_fingerprint_path() const { return vcpkg_dir() / "manifest-install.fingerprint"; }
         Path triplet_dir(Triplet t) const { return m_root / t.canonical_name(); }
         Path share_dir(const PackageSpec& p) const { return triplet_dir(p.triplet()) / "share" / p.name(); }
         Path usage_file(const PackageSpec& p) const { return share_dir(p) / "usage"; }
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <vcpkg/base/fwd/span.h>
+
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/optional.h>
+#include <vcpkg/base/strings.h>
+
+#include <stdint.h>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace vcpkg
+{
+    // A sorted list of paths, front-coded: each path is stored as the length of the prefix it shares with the path
+    // before it, followed by the rest of it. Every RESTART_INTERVAL-th path is stored whole, so that a path can be
+    // found by decoding only the paths after the closest whole one.
+    struct FrontCodedPaths
+    {
+        static constexpr uint32_t RESTART_INTERVAL = 16;
+
+        // `sorted_paths` must be sorted
+        static std::string encode(View<std::string> sorted_paths);
+        // The result views `bytes`. Returns nullopt if `bytes` is not a valid encoding.
+        static Optional<FrontCodedPaths> decode(StringView bytes);
+
+        struct const_iterator
+        {
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = StringView;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const StringView*;
+            using reference = StringView;
+
+            // the view is invalidated by incrementing the iterator
+            StringView operator*() const noexcept { return m_path; }
+
+            const_iterator& operator++();
+            const_iterator operator++(int)
+            {
+                auto result = *this;
+                ++*this;
+                return result;
+            }
+
+            friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) noexcept
+            {
+                return lhs.m_index == rhs.m_index;
+            }
+            friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) noexcept
+            {
+                return !(lhs == rhs);
+            }
+
+        private:
+            friend FrontCodedPaths;
+            // `next` is the encoding of the path at `index`
+            const_iterator(const char* next, uint32_t index, uint32_t count);
+            void decode_path();
+
+            const char* m_next;
+            uint32_t m_index;
+            uint32_t m_count;
+            std::string m_path;
+        };
+
+        const_iterator begin() const { return const_iterator{m_entries.data(), 0, m_count}; }
+        const_iterator end() const { return const_iterator{nullptr, m_count, m_count}; }
+        size_t size() const noexcept { return m_count; }
+
+        bool contains(StringView path) const;
+
+    private:
+        FrontCodedPaths(uint32_t count, StringView restarts, StringView entries)
+            : m_count(count), m_restarts(restarts), m_entries(entries)
+        {
+        }
+
+        uint32_t m_count;
+        // little-endian uint32_t offsets into m_entries of every RESTART_INTERVAL-th path
+        StringView m_restarts;
+        StringView m_entries;
+    };
+
+    // The paths a package installed, relative to the installed tree, as recorded in its listfile,
+    // installed/vcpkg/info/<package>.list. That file is text, one path per line, for older vcpkg versions and exported
+    // packages' scripts; a front-coded copy of it, <package>.list.fc, is used instead while it is up to date.
+    struct Listfile
+    {
+        Listfile() = default;
+
+        static Listfile load(const Filesystem& fs, const Path& listfile_path, std::error_code& ec);
+        static Listfile load(const Filesystem& fs, const Path& listfile_path, LineInfo li);
+
+        // nullptr unless the front-coded copy is in use
+        const FrontCodedPaths* front_coded_paths() const noexcept { return m_paths.get(); }
+
+        // Calls `cb` with each path; directories end in '/'. The view is only valid during the call.
+        template<class Fn>
+        void for_each(Fn cb) const
+        {
+            if (auto paths = m_paths.get())
+            {
+                for (auto&& path : *paths)
+                {
+                    cb(path);
+                }
+
+                return;
+            }
+
+            for (auto line : Strings::lines(m_file.contents()))
+            {
+                line = Strings::trim(line);
+                if (!line.empty())
+                {
+                    cb(line);
+                }
+            }
+        }
+
+    private:
+        MappedFile m_file;
+        Optional<FrontCodedPaths> m_paths;
+    };
+
+    Path front_coded_listfile_path(const Path& listfile_path);
+
+    // writes the listfile and its front-coded copy
+    void write_listfile(Filesystem& fs, const Path& listfile_path, std::vector<std::string> paths);
+
+    // Writes the front-coded copy of the existing listfile `listfile_path`, whose paths are `paths`. Other processes
+    // may read the copy as soon as it exists.
+    void write_front_coded_listfile(Filesystem& fs,
+                                    const Path& listfile_path,
+                                    std::vector<std::string> paths,
+                                    std::error_code& ec);
+
+    // removes the listfile and its front-coded copy
+    void remove_listfile(Filesystem& fs, const Path& listfile_path, LineInfo li);
+}
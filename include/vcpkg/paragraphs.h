@@ -4,8 +4,10 @@
 #include <vcpkg/fwd/registries.h>
 
 #include <vcpkg/base/expected.h>
+#include <vcpkg/base/optional.h>
 
 #include <vcpkg/binaryparagraph.h>
+#include <vcpkg/versions.h>
 
 namespace vcpkg::Paragraphs
 {
@@ -23,6 +25,10 @@ namespace vcpkg::Paragraphs
     ParseExpected<SourceControlFile> try_load_port(const Filesystem& fs, const Path& port_directory);
     ParseExpected<SourceControlFile> try_load_port_text(const std::string& text, StringView origin, bool is_manifest);
 
+    // Reads only the version of the port in `port_directory`, which is much cheaper than loading the whole port.
+    // Returns nullopt if the version can't be read; try_load_port reports why.
+    Optional<Version> try_load_port_version(const Filesystem& fs, const Path& port_directory);
+
     ExpectedS<BinaryControlFile> try_load_cached_package(const Filesystem& fs,
                                                          const Path& package_dir,
                                                          const PackageSpec& spec);
@@ -16,6 +16,10 @@ namespace vcpkg::PortFileProvider
         virtual ~PortFileProvider() = default;
         virtual ExpectedS<const SourceControlFileAndLocation&> get_control_file(const std::string& src_name) const = 0;
         virtual std::vector<const SourceControlFileAndLocation*> load_all_control_files() const = 0;
+
+        // The version of each port that get_control_file would load, or nullopt for ports it does not know.
+        // Implementations may find the versions without loading the ports.
+        virtual std::vector<Optional<Version>> get_versions(View<std::string> port_names) const;
     };
 
     struct MapPortFileProvider : PortFileProvider
@@ -38,11 +42,18 @@ namespace vcpkg::PortFileProvider
         virtual ExpectedS<const SourceControlFileAndLocation&> get_control_file(
             const VersionSpec& version_spec) const = 0;
         virtual void load_all_control_files(std::map<std::string, const SourceControlFileAndLocation*>& out) const = 0;
+
+        // Loads the control files for a batch of versions at once, which implementations may do in parallel.
+        // Returns the loaded control files in the order of version_specs, or nullptr for any that failed; failures are
+        // reported by a later get_control_file call.
+        virtual std::vector<const SourceControlFileAndLocation*> prefetch_control_files(
+            View<VersionSpec> version_specs) const;
     };
 
     struct IBaselineProvider
     {
         virtual Optional<Version> get_baseline_version(StringView port_name) const = 0;
+        virtual std::vector<Optional<Version>> get_baseline_versions(View<std::string> port_names) const;
         virtual ~IBaselineProvider() = default;
     };
 
@@ -58,6 +69,7 @@ namespace vcpkg::PortFileProvider
         explicit PathsPortFileProvider(const vcpkg::VcpkgPaths& paths, View<std::string> overlay_ports);
         ExpectedS<const SourceControlFileAndLocation&> get_control_file(const std::string& src_name) const override;
         std::vector<const SourceControlFileAndLocation*> load_all_control_files() const override;
+        std::vector<Optional<Version>> get_versions(View<std::string> port_names) const override;
 
     private:
         std::unique_ptr<IBaselineProvider> m_baseline;
@@ -12,8 +12,11 @@
 #include <vcpkg/versiondeserializers.h>
 #include <vcpkg/versions.h>
 
+#include <stdint.h>
+
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <system_error>
 #include <vector>
@@ -44,11 +47,19 @@ namespace vcpkg
         };
 
         Entry get_or_fetch(const VcpkgPaths& paths, StringView repo, StringView reference);
+        ExpectedS<Entry> try_get_or_fetch(const VcpkgPaths& paths, StringView repo, StringView reference);
 
         LockDataType lockdata;
         bool modified = false;
+
+    private:
+        // guards lockdata and modified, so that registries may be fetched concurrently
+        std::unique_ptr<std::mutex> m_mutex = std::make_unique<std::mutex>();
     };
 
+    // An entry is not thread safe, but different entries may be used concurrently (see
+    // IVersionedPortfileProvider::prefetch_control_files), so any state they share through their registry must be
+    // synchronized.
     struct RegistryEntry
     {
         virtual View<Version> get_port_versions() const = 0;
@@ -71,8 +82,20 @@ namespace vcpkg
 
         virtual Optional<Version> get_baseline_version(StringView port_name) const = 0;
 
+        // get_baseline_version for each of `port_names`; implementations may look them up in parallel
+        virtual std::vector<Optional<Version>> get_baseline_versions(View<std::string> port_names) const;
+
         virtual Optional<Path> get_path_to_baseline_version(StringView port_name) const;
 
+        // performs ahead of time any slow work, like network fetches, that lookups in this registry will need.
+        // may be called concurrently with prefetch() on other registries. Failures are not reported here;
+        // they are reported by the lookups that need the data.
+        virtual void prefetch() const;
+
+        // Appends the local files and directories which lookups of `port_name` read, and which may change while the
+        // registry's configuration stays the same. Registries whose contents are pinned to a git commit have none.
+        virtual void get_mutable_inputs(StringView port_name, std::vector<Path>& out) const;
+
         virtual ~RegistryImplementation() = default;
     };
 
@@ -111,6 +134,8 @@ namespace vcpkg
         // Returns the null pointer if there is no registry set up for that name
         const RegistryImplementation* registry_for_port(StringView port_name) const;
         Optional<Version> baseline_for_port(StringView port_name) const;
+        // baseline_for_port for each of `port_names`, asking each registry for all of its ports at once
+        std::vector<Optional<Version>> baseline_for_ports(View<std::string> port_names) const;
 
         View<Registry> registries() const { return registries_; }
 
@@ -118,6 +143,9 @@ namespace vcpkg
 
         bool is_default_builtin_registry() const;
 
+        // prefetches all registries in parallel
+        void prefetch() const;
+
         // returns whether the registry set has any modifications to the default
         // (i.e., whether `default_registry` was set, or `registries` had any entries)
         // for checking against the registry feature flag.
@@ -187,4 +215,40 @@ namespace vcpkg
     private:
         VersionDbEntryDeserializer underlying;
     };
+
+    // The versions files of a git registry's versions tree, packed into one file which is memory-mapped and binary
+    // searched by port name, so that looking up a port does not open and parse its own versions file. Versions trees
+    // are immutable, so a database is built once per tree, by the first process to use it, and kept next to the tree
+    // rather than in it.
+    struct PackedVersionsDb
+    {
+        // <registry_versions>.versions.db
+        static Path path_for(const Path& registry_versions);
+
+        // an empty database
+        PackedVersionsDb() = default;
+
+        // the database of the versions tree `registry_versions`, in which every versions file must be valid
+        static ExpectedS<std::string> pack(const Filesystem& fs, const Path& registry_versions);
+        static ExpectedS<PackedVersionsDb> open(const Filesystem& fs, const Path& db_path);
+        // opens path_for(`registry_versions`), first building it if it doesn't exist or is not valid
+        static ExpectedS<PackedVersionsDb> load_or_build(Filesystem& fs, const Path& registry_versions);
+
+        // the entries of the versions file of `port_name`, or nullopt if the registry does not have one
+        Optional<std::vector<VersionDbEntry>> find(StringView port_name) const;
+        std::vector<std::string> port_names() const;
+
+    private:
+        explicit PackedVersionsDb(MappedFile&& file) : m_file(std::move(file)) { }
+
+        StringView port_name(uint32_t port) const;
+
+        MappedFile m_file;
+        uint32_t m_port_count = 0;
+        uint32_t m_entry_count = 0;
+        // views into m_file
+        const char* m_ports = nullptr;
+        const char* m_entries = nullptr;
+        StringView m_strings;
+    };
 }
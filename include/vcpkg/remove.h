@@ -1,11 +1,19 @@
 #pragma once
 
+#include <vcpkg/base/files.h>
+
 #include <vcpkg/fwd/dependencies.h>
+#include <vcpkg/fwd/installedpaths.h>
+#include <vcpkg/fwd/packagespec.h>
 #include <vcpkg/fwd/vcpkgcmdarguments.h>
 #include <vcpkg/fwd/vcpkgpaths.h>
 
 #include <vcpkg/commands.interface.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace vcpkg::Remove
 {
     enum class Purge : bool
@@ -19,6 +27,48 @@ namespace vcpkg::Remove
                                     const Purge purge,
                                     StatusParagraphs* status_db);
 
+    // The listfiles of the packages removed by perform_replace_plan_action, whose files are still in the installed
+    // tree. They are kept in a directory of installed/vcpkg/replaced/ owned by this process until the new packages are
+    // installed over the files, so that remove_abandoned_replaced_files can remove them if vcpkg is interrupted before
+    // then. A single lock on the directory, taken when the first package is replaced, tells other processes to leave
+    // it alone.
+    class ReplacedListfiles
+    {
+    public:
+        ReplacedListfiles(Filesystem& fs, const InstalledPaths& installed);
+        ReplacedListfiles(const ReplacedListfiles&) = delete;
+        ReplacedListfiles& operator=(const ReplacedListfiles&) = delete;
+        ~ReplacedListfiles();
+
+        // creates the directory and takes its lock if this is the first package replaced
+        Path listfile_path(const PackageSpec& spec);
+
+        // removes the listfile of `spec`, whose files have been installed over or removed
+        void release(const PackageSpec& spec);
+
+    private:
+        Filesystem& m_fs;
+        Path m_dir;
+        std::unique_ptr<IExclusiveFileLock> m_lock;
+    };
+
+    // Removes a package which the same plan installs again. Like perform_remove_plan_action, except that the package's
+    // files are left in the installed tree, so the new package can be installed over them; they must be removed with
+    // remove_installed_files if it is not. Either way, `replaced_listfiles.release()` must be called afterwards.
+    // Returns the listfile paths of the files, sorted.
+    std::vector<std::string> perform_replace_plan_action(const VcpkgPaths& paths,
+                                                         const Dependencies::RemovePlanAction& action,
+                                                         StatusParagraphs* status_db,
+                                                         ReplacedListfiles& replaced_listfiles);
+
+    // Removes the files of replaced packages left behind by vcpkg processes which exited before installing the new
+    // packages, except those which installed packages own.
+    void remove_abandoned_replaced_files(Filesystem& fs, const InstalledPaths& installed, StatusParagraphs& status_db);
+
+    // Removes `paths`, listfile paths relative to `installed_root`, in parallel. Directories, which end in '/', are
+    // removed afterwards, deepest first, if they are empty.
+    void remove_installed_files(Filesystem& fs, const Path& installed_root, std::vector<std::string> paths);
+
     extern const CommandStructure COMMAND_STRUCTURE;
 
     struct RemoveCommand : Commands::TripletCommand
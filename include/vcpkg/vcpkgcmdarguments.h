@@ -163,6 +163,16 @@ namespace vcpkg
         constexpr static StringLiteral CMAKE_SCRIPT_ARG = "x-cmake-args";
         std::vector<std::string> cmake_args;
 
+        // each is a command line which runs vcpkg on a build worker, e.g. "ssh builder1 /opt/vcpkg/vcpkg"
+        constexpr static StringLiteral BUILD_WORKER_ARG = "x-build-worker";
+        std::vector<std::string> build_workers;
+
+        // in MiB; builds whose recorded peak memory use would exceed it with the usual number of jobs run fewer
+        constexpr static StringLiteral BUILD_MEMORY_BUDGET_ARG = "x-build-memory-budget";
+        std::unique_ptr<std::string> build_memory_budget;
+        // build_memory_budget, checked to be a positive number when the arguments are parsed
+        Optional<uint64_t> build_memory_budget_mib;
+
         constexpr static StringLiteral EXACT_ABI_TOOLS_VERSIONS_SWITCH = "x-abi-tools-use-exact-versions";
         Optional<bool> exact_abi_tools_versions;
 
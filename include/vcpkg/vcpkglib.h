@@ -6,24 +6,39 @@
 
 #include <vcpkg/base/sortedvector.h>
 
+#include <vcpkg/listfile.h>
 #include <vcpkg/statusparagraphs.h>
 
+#include <memory>
+
 namespace vcpkg
 {
+    // Takes the lock which serializes changes to the status database, and to the files it tracks, among the vcpkg
+    // processes sharing `installed`.
+    std::unique_ptr<IExclusiveFileLock> lock_status_database(Filesystem& fs, const InstalledPaths& installed);
+
     StatusParagraphs database_load_check(Filesystem& fs, const InstalledPaths& installed);
 
+    // Brings `status_db` up to date with changes other processes have made to `installed`, updating paragraphs in
+    // place so that views into `status_db` stay valid. Requires lock_status_database.
+    void database_refresh(Filesystem& fs, const InstalledPaths& installed, StatusParagraphs& status_db);
+
+    // Requires lock_status_database, held since the last database_refresh.
     void write_update(Filesystem& fs, const InstalledPaths& installed, const StatusParagraph& p);
 
-    struct StatusParagraphAndAssociatedFiles
+    struct StatusParagraphAndListfile
     {
-        StatusParagraph pgh;
-        SortedVector<std::string> files;
+        const StatusParagraph* pgh;
+        Listfile listfile;
     };
 
     std::vector<InstalledPackageView> get_installed_ports(const StatusParagraphs& status_db);
-    std::vector<StatusParagraphAndAssociatedFiles> get_installed_files(Filesystem& fs,
-                                                                       const InstalledPaths& installed,
-                                                                       const StatusParagraphs& status_db);
+
+    // Loads the listfiles of the installed packages, bringing listfiles written by older versions of vcpkg up to date
+    // and writing the front-coded copies which are missing.
+    std::vector<StatusParagraphAndListfile> get_installed_listfiles(Filesystem& fs,
+                                                                    const InstalledPaths& installed,
+                                                                    const StatusParagraphs& status_db);
 
     std::string shorten_text(const std::string& desc, const size_t length);
 } // namespace vcpkg
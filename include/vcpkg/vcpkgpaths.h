@@ -76,6 +76,12 @@ namespace vcpkg
         Path package_dir(const PackageSpec& spec) const;
         Path build_dir(const PackageSpec& spec) const;
         Path build_dir(const std::string& package_name) const;
+
+        // Locks for directories which vcpkg processes using the same packages and buildtrees roots share; each waits
+        // for the lock. The package directory of `spec` is held from building or restoring it until it is installed.
+        // A port's buildtree is shared by all of its triplets.
+        std::unique_ptr<IExclusiveFileLock> lock_package_dir(const PackageSpec& spec) const;
+        std::unique_ptr<IExclusiveFileLock> lock_build_dir(const std::string& package_name) const;
         Path build_info_file_path(const PackageSpec& spec) const;
 
         bool is_valid_triplet(Triplet t) const;
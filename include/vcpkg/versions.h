@@ -3,6 +3,7 @@
 #include <vcpkg/base/fwd/format.h>
 #include <vcpkg/base/fwd/stringview.h>
 
+#include <vcpkg/base/cache.h>
 #include <vcpkg/base/expected.h>
 
 namespace vcpkg
@@ -133,6 +134,43 @@ namespace vcpkg
 
     VerComp compare(const DateVersion& a, const DateVersion& b);
 
+    // A version parsed once into a form which is cheap to compare repeatedly.
+    // Dot versions keep their numeric components and prerelease identifiers; date versions keep the year, month, and
+    // day followed by their numeric identifiers. `prefix` packs the first three numeric components (if they fit), so
+    // most comparisons between different versions are decided by a single integer comparison.
+    struct VersionKey
+    {
+        struct PrereleaseIdentifier
+        {
+            bool is_numeric = false;
+            uint64_t number = 0;
+            std::string text;
+        };
+
+        VersionScheme scheme = VersionScheme::String;
+        std::string text;
+        std::vector<uint64_t> numbers;
+        std::vector<PrereleaseIdentifier> identifiers;
+        uint64_t prefix = 0;
+        bool has_prefix = false;
+
+        static ExpectedL<VersionKey> try_parse(StringView text, VersionScheme scheme);
+    };
+
+    // Orders keys the same way as comparing the corresponding DotVersion or DateVersion objects, or the raw text for
+    // the string scheme. Returns VerComp::unk if the schemes of a and b cannot be compared.
+    VerComp compare(const VersionKey& a, const VersionKey& b);
+
+    // Remembers the parsed VersionKey for each (scheme, text) pair; not thread safe.
+    struct VersionKeyCache
+    {
+        // exits if text is not a valid version in scheme
+        const VersionKey& get(VersionScheme scheme, const std::string& text) const;
+
+    private:
+        Cache<std::string, VersionKey> m_keys[4];
+    };
+
     enum class VersionConstraintKind
     {
         None,
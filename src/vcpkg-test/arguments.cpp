@@ -117,6 +117,17 @@ TEST_CASE ("VcpkgCmdArguments from argument sequence with valued options", "[arg
     }
 }
 
+TEST_CASE ("build memory budget parse", "[arguments]")
+{
+    std::vector<std::string> t = {"--x-build-memory-budget=2048", "install"};
+    auto v = VcpkgCmdArguments::create_from_arg_sequence(t.data(), t.data() + t.size());
+    REQUIRE(v.build_memory_budget_mib.value_or_exit(VCPKG_LINE_INFO) == 2048);
+
+    t = {"install"};
+    auto without = VcpkgCmdArguments::create_from_arg_sequence(t.data(), t.data() + t.size());
+    REQUIRE(!without.build_memory_budget_mib.has_value());
+}
+
 TEST_CASE ("vcpkg_root parse with arg separator", "[arguments]")
 {
     std::vector<std::string> t = {"--vcpkg-root", "C:\\vcpkg"};
@@ -0,0 +1,157 @@
+#include <catch2/catch.hpp>
+
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/strings.h>
+
+#include <vcpkg/buildhistory.h>
+#include <vcpkg/dependencies.h>
+#include <vcpkg/installedpaths.h>
+
+#include <vcpkg-test/util.h>
+
+#include <thread>
+
+using namespace vcpkg;
+using namespace vcpkg::Test;
+using Dependencies::InstallPlanAction;
+
+namespace
+{
+    InstallPlanAction make_action(const std::string& name, std::vector<std::string> dependencies)
+    {
+        InstallPlanAction action;
+        action.spec = PackageSpec{name, X64_WINDOWS};
+        action.plan_type = Dependencies::InstallPlanType::BUILD_AND_INSTALL;
+        for (auto&& dependency : dependencies)
+        {
+            action.package_dependencies.emplace_back(dependency, X64_WINDOWS);
+        }
+
+        return action;
+    }
+
+    std::vector<std::string> names(const std::vector<InstallPlanAction>& actions)
+    {
+        return Util::fmap(actions, [](const InstallPlanAction& action) { return action.spec.name(); });
+    }
+
+    void set_build_time(BuildHistory& history, const std::string& name, uint64_t build_time_us)
+    {
+        BuildHistory::Entry entry;
+        entry.build_time_us = build_time_us;
+        history.set(PackageSpec{name, X64_WINDOWS}, entry);
+    }
+}
+
+TEST_CASE ("order_by_critical_path", "[buildhistory]")
+{
+    // zlib <- png, zlib <- qt; fmt and llvm are independent
+    std::vector<InstallPlanAction> actions;
+    actions.push_back(make_action("fmt", {}));
+    actions.push_back(make_action("zlib", {}));
+    actions.push_back(make_action("png", {"zlib"}));
+    actions.push_back(make_action("llvm", {}));
+    actions.push_back(make_action("qt", {"zlib", "png"}));
+
+    SECTION ("without a history the longest chains come first")
+    {
+        order_by_critical_path(actions, BuildHistory{});
+        CHECK(names(actions) == std::vector<std::string>{"zlib", "png", "fmt", "llvm", "qt"});
+    }
+
+    SECTION ("recorded build times")
+    {
+        BuildHistory history;
+        set_build_time(history, "fmt", 10);
+        set_build_time(history, "zlib", 10);
+        set_build_time(history, "png", 10);
+        set_build_time(history, "llvm", 1000);
+        set_build_time(history, "qt", 500);
+        CHECK(remaining_critical_paths(actions, history) == std::vector<uint64_t>{10, 520, 510, 1000, 500});
+
+        order_by_critical_path(actions, history);
+        CHECK(names(actions) == std::vector<std::string>{"llvm", "zlib", "png", "qt", "fmt"});
+    }
+
+    SECTION ("ports without a record are assumed to take the average")
+    {
+        BuildHistory history;
+        set_build_time(history, "llvm", 100);
+        set_build_time(history, "fmt", 300);
+        CHECK(history.estimated_build_time_us(PackageSpec{"qt", X64_WINDOWS}) == 200);
+
+        order_by_critical_path(actions, history);
+        CHECK(names(actions) == std::vector<std::string>{"zlib", "png", "fmt", "qt", "llvm"});
+    }
+}
+
+TEST_CASE ("BuildHistory round trip", "[buildhistory]")
+{
+    auto& fs = get_real_filesystem();
+    const InstalledPaths installed(base_temporary_directory() / "build-history");
+    fs.remove_all(installed.root(), VCPKG_LINE_INFO);
+    CHECK(BuildHistory::load(fs, installed).empty());
+
+    BuildHistory::Entry entry;
+    entry.build_time_us = 1234567;
+    entry.package_size = 89;
+    entry.peak_rss_bytes = 4096;
+    record_build(fs, installed, PackageSpec{"zlib", X64_WINDOWS}, entry);
+    entry.build_time_us = 7;
+    entry.peak_rss_bytes = 0;
+    record_build(fs, installed, PackageSpec{"fmt", X64_WINDOWS}, entry);
+
+    const auto history = BuildHistory::load(fs, installed);
+    auto zlib = history.get(PackageSpec{"zlib", X64_WINDOWS});
+    REQUIRE(zlib);
+    CHECK(zlib.get()->build_time_us == 1234567);
+    CHECK(zlib.get()->package_size == 89);
+    CHECK(zlib.get()->peak_rss_bytes == 4096);
+    CHECK(history.get(PackageSpec{"fmt", X64_WINDOWS}).value_or_exit(VCPKG_LINE_INFO).peak_rss_bytes == 0);
+    CHECK(history.estimated_build_time_us(PackageSpec{"fmt", X64_WINDOWS}) == 7);
+    CHECK(!history.get(PackageSpec{"zlib", X86_WINDOWS}));
+
+    // a remote build, whose memory use is unknown, keeps the recorded one
+    entry.build_time_us = 1000;
+    record_build(fs, installed, PackageSpec{"zlib", X64_WINDOWS}, entry);
+    zlib = BuildHistory::load(fs, installed).get(PackageSpec{"zlib", X64_WINDOWS});
+    REQUIRE(zlib);
+    CHECK(zlib.get()->build_time_us == 1000);
+    CHECK(zlib.get()->peak_rss_bytes == 4096);
+
+    fs.write_contents(installed.build_history_path(), "{\"version\": 2}", VCPKG_LINE_INFO);
+    CHECK(BuildHistory::load(fs, installed).empty());
+
+    fs.remove_all(installed.root(), VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("record_build from several threads", "[buildhistory]")
+{
+    auto& fs = get_real_filesystem();
+    const InstalledPaths installed(base_temporary_directory() / "build-history-threads");
+    fs.remove_all(installed.root(), VCPKG_LINE_INFO);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([&, i] {
+            BuildHistory::Entry entry;
+            entry.build_time_us = static_cast<uint64_t>(i + 1);
+            record_build(fs, installed, PackageSpec{Strings::concat("port", i), X64_WINDOWS}, entry);
+        });
+    }
+
+    for (auto&& thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto history = BuildHistory::load(fs, installed);
+    for (int i = 0; i < 8; ++i)
+    {
+        const PackageSpec spec{Strings::concat("port", i), X64_WINDOWS};
+        CHECK(history.estimated_build_time_us(spec) == static_cast<uint64_t>(i + 1));
+    }
+
+    fs.remove_all(installed.root(), VCPKG_LINE_INFO);
+}
@@ -67,6 +67,7 @@ TEST_CASE ("list of commands is correct", "[commands]")
         "use",
         "version",
         "x-add-version",
+        "x-build-worker",
         "x-check-support",
         "x-ci-clean",
         "x-ci-verify-versions",
@@ -56,6 +56,15 @@ struct MockVersionedPortfileProvider : PortFileProvider::IVersionedPortfileProvi
 
     virtual View<vcpkg::Version> get_port_versions(StringView) const override { Checks::unreachable(VCPKG_LINE_INFO); }
 
+    mutable std::vector<std::vector<std::string>> prefetch_batches;
+
+    std::vector<const SourceControlFileAndLocation*> prefetch_control_files(
+        View<vcpkg::VersionSpec> version_specs) const override
+    {
+        prefetch_batches.push_back(Util::fmap(version_specs, [](const VersionSpec& vs) { return vs.to_string(); }));
+        return IVersionedPortfileProvider::prefetch_control_files(version_specs);
+    }
+
     SourceControlFileAndLocation& emplace(std::string&& name,
                                           Version&& version,
                                           VersionScheme scheme = VersionScheme::String)
@@ -605,6 +614,47 @@ TEST_CASE ("version install transitive relaxed", "[versionplan]")
     check_name_and_version(install_plan.install_actions[1], "a", {"3", 0});
 }
 
+TEST_CASE ("version install prefetches breadth first", "[versionplan]")
+{
+    MockBaselineProvider bp;
+    bp.v["a"] = {"2", 0};
+    bp.v["b"] = {"2", 0};
+    bp.v["c"] = {"1", 0};
+
+    MockVersionedPortfileProvider vp;
+    vp.emplace("a", {"2", 0}, VersionScheme::Relaxed);
+    vp.emplace("a", {"3", 0}, VersionScheme::Relaxed).source_control_file->core_paragraph->dependencies = {
+        Dependency{"b", {}, {}, DependencyConstraint{VersionConstraintKind::Minimum, "3"}},
+    };
+    vp.emplace("b", {"2", 0}, VersionScheme::Relaxed);
+    vp.emplace("b", {"3", 0}, VersionScheme::Relaxed).source_control_file->core_paragraph->dependencies = {
+        Dependency{"c"},
+    };
+    vp.emplace("c", {"1", 0}, VersionScheme::Relaxed);
+
+    MockCMakeVarProvider var_provider;
+
+    auto install_plan =
+        unwrap(create_versioned_install_plan(vp,
+                                             bp,
+                                             var_provider,
+                                             {
+                                                 Dependency{"a", {}, {}, {VersionConstraintKind::Minimum, "3", 0}},
+                                             },
+                                             {},
+                                             toplevel_spec()));
+
+    REQUIRE(install_plan.size() == 3);
+    check_name_and_version(install_plan.install_actions[0], "c", {"1", 0});
+    check_name_and_version(install_plan.install_actions[1], "b", {"3", 0});
+    check_name_and_version(install_plan.install_actions[2], "a", {"3", 0});
+
+    REQUIRE(vp.prefetch_batches.size() == 3);
+    CHECK(vp.prefetch_batches[0] == std::vector<std::string>{"a@3", "a@2"});
+    CHECK(vp.prefetch_batches[1] == std::vector<std::string>{"b@3", "b@2"});
+    CHECK(vp.prefetch_batches[2] == std::vector<std::string>{"c@1"});
+}
+
 TEST_CASE ("version install diamond relaxed", "[versionplan]")
 {
     MockBaselineProvider bp;
@@ -817,6 +867,56 @@ TEST_CASE ("version sort date", "[versionplan]")
     CHECK(versions[8].original_string == "2021-01-01.10");
 }
 
+TEST_CASE ("version key compare", "[versionplan]")
+{
+    const std::vector<std::string> relaxed{"1",
+                                           "1.0",
+                                           "1.0.0-alpha",
+                                           "1.0.0-alpha.1",
+                                           "1.0.0-alpha.beta",
+                                           "1.0.0-1",
+                                           "1.0.0",
+                                           "1.0.0+build",
+                                           "1.0.0.1",
+                                           "1.2.3",
+                                           "1.10",
+                                           "3000000.1",
+                                           "3000000.1.1-rc",
+                                           "3000000.1.1"};
+    for (auto&& a : relaxed)
+    {
+        for (auto&& b : relaxed)
+        {
+            INFO(a << " vs " << b);
+            CHECK(compare(unwrap(VersionKey::try_parse(a, VersionScheme::Relaxed)),
+                          unwrap(VersionKey::try_parse(b, VersionScheme::Relaxed))) ==
+                  compare(unwrap(DotVersion::try_parse_relaxed(a)), unwrap(DotVersion::try_parse_relaxed(b))));
+        }
+    }
+
+    const std::vector<std::string> dates{
+        "2020-12-25", "2020-12-31", "2021-01-01", "2021-01-01.1", "2021-01-01.1.0", "2021-01-01.10"};
+    for (auto&& a : dates)
+    {
+        for (auto&& b : dates)
+        {
+            INFO(a << " vs " << b);
+            CHECK(compare(unwrap(VersionKey::try_parse(a, VersionScheme::Date)),
+                          unwrap(VersionKey::try_parse(b, VersionScheme::Date))) ==
+                  compare(unwrap(DateVersion::try_parse(a)), unwrap(DateVersion::try_parse(b))));
+        }
+    }
+
+    VersionKeyCache keys;
+    const auto& semver = keys.get(VersionScheme::Semver, "1.2.3");
+    CHECK(&semver == &keys.get(VersionScheme::Semver, "1.2.3"));
+    CHECK(semver.has_prefix);
+    CHECK(compare(semver, keys.get(VersionScheme::Relaxed, "1.2.3.1")) == VerComp::lt);
+    CHECK(compare(semver, keys.get(VersionScheme::Date, "2021-01-01")) == VerComp::unk);
+    CHECK(compare(keys.get(VersionScheme::String, "b"), keys.get(VersionScheme::String, "a")) == VerComp::gt);
+    CHECK_FALSE(VersionKey::try_parse("1.2", VersionScheme::Semver).has_value());
+}
+
 TEST_CASE ("version install simple semver", "[versionplan]")
 {
     MockBaselineProvider bp;
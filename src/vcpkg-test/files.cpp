@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <random>
+#include <thread>
 #include <vector>
 
 #include <vcpkg-test/util.h>
@@ -682,6 +683,39 @@ TEST_CASE ("remove all", "[files]")
     CHECK_EC_ON_FILE(temp_dir, ec);
 }
 
+TEST_CASE ("shared and exclusive file locks", "[files]")
+{
+    urbg_t urbg;
+
+    auto& fs = setup();
+
+    auto temp_dir = base_temporary_directory() / get_random_filename(urbg);
+    INFO("temp dir is: " << temp_dir.native());
+
+    fs.create_directory(temp_dir, VCPKG_LINE_INFO);
+    const auto lockfile = temp_dir / "file.lock";
+    {
+        std::error_code ec;
+        auto first = fs.try_take_shared_file_lock(lockfile, ec);
+        REQUIRE(!ec);
+        auto second = fs.try_take_shared_file_lock(lockfile, ec);
+        REQUIRE(!ec);
+
+        auto exclusive = fs.try_take_exclusive_file_lock(lockfile, ec);
+        CHECK(ec);
+    }
+
+    {
+        std::error_code ec;
+        auto exclusive = fs.try_take_exclusive_file_lock(lockfile, ec);
+        REQUIRE(!ec);
+        auto shared = fs.try_take_shared_file_lock(lockfile, ec);
+        CHECK(ec);
+    }
+
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+}
+
 TEST_CASE ("remove all symlinks", "[files]")
 {
     urbg_t urbg;
@@ -727,6 +761,55 @@ TEST_CASE ("remove all symlinks", "[files]")
     CHECK_EC_ON_FILE(temp_dir, ec);
 }
 
+TEST_CASE ("remove all in background", "[files]")
+{
+    urbg_t urbg;
+
+    auto& fs = setup();
+
+    auto temp_dir = base_temporary_directory() / get_random_filename(urbg);
+    INFO("temp dir is: " << temp_dir.native());
+
+    fs.create_directory(temp_dir, VCPKG_LINE_INFO);
+    // nothing to remove, so no trash directory is created
+    fs.remove_all_in_background(temp_dir / "missing", VCPKG_LINE_INFO);
+    CHECK(fs.get_files_non_recursive(temp_dir, VCPKG_LINE_INFO).empty());
+
+    const auto tree = temp_dir / "tree";
+    create_directory_tree(urbg, fs, tree);
+    const auto trash = temp_dir / ".vcpkg-trash";
+    fs.create_directory(trash, VCPKG_LINE_INFO);
+    // left behind by a process which exited before removing it
+    create_directory_tree(urbg, fs, trash / "abandoned");
+    fs.write_contents(trash / "abandoned.lock", "", VCPKG_LINE_INFO);
+    // still in use by another process
+    create_directory_tree(urbg, fs, trash / "live");
+    auto live_lock = fs.take_exclusive_file_lock(trash / "live.lock", VCPKG_LINE_INFO);
+
+    // the tree is moved out of the way before returning, so it can be recreated at once
+    fs.remove_all_in_background(tree, VCPKG_LINE_INFO);
+    REQUIRE_FALSE(fs.exists(tree, VCPKG_LINE_INFO));
+    fs.create_directory(tree, VCPKG_LINE_INFO);
+
+    wait_for_background_removals();
+    CHECK(fs.exists(tree, VCPKG_LINE_INFO));
+    CHECK_FALSE(fs.exists(trash / "abandoned", VCPKG_LINE_INFO));
+    CHECK_FALSE(fs.exists(trash / "abandoned.lock", VCPKG_LINE_INFO));
+    CHECK(fs.exists(trash / "live", VCPKG_LINE_INFO));
+
+    // once the other process is gone, the trash directory is removed when it is empty
+    live_lock.reset();
+    fs.remove_all_in_background(tree, VCPKG_LINE_INFO);
+    wait_for_background_removals();
+    CHECK_FALSE(fs.exists(tree, VCPKG_LINE_INFO));
+    CHECK_FALSE(fs.exists(trash, VCPKG_LINE_INFO));
+
+    std::error_code ec;
+    Path fp;
+    fs.remove_all(temp_dir, ec, fp);
+    CHECK_EC_ON_FILE(fp, ec);
+}
+
 TEST_CASE ("get_files_recursive_symlinks", "[files]")
 {
     do_filesystem_enumeration_test(
@@ -942,6 +1025,59 @@ TEST_CASE ("copy_symlink", "[files]")
     CHECK_EC_ON_FILE(temp_dir, ec);
 }
 
+TEST_CASE ("file_size and last_write_time", "[files]")
+{
+    auto& fs = setup();
+    auto temp_dir = base_temporary_directory() / "file_size_and_last_write_time";
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+    fs.create_directories(temp_dir, VCPKG_LINE_INFO);
+
+    const auto file = temp_dir / "file.txt";
+    fs.write_contents(file, "hello", VCPKG_LINE_INFO);
+    CHECK(fs.file_size(file, VCPKG_LINE_INFO) == 5);
+    CHECK(fs.last_write_time(file, VCPKG_LINE_INFO) != 0);
+
+    std::error_code ec;
+    fs.file_size(temp_dir / "missing.txt", ec);
+    CHECK(ec);
+    ec.clear();
+    fs.last_write_time(temp_dir / "missing.txt", ec);
+    CHECK(ec);
+
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("touch_shared", "[files]")
+{
+    auto& fs = setup();
+    auto temp_dir = base_temporary_directory() / "touch_shared";
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+    fs.create_directories(temp_dir, VCPKG_LINE_INFO);
+
+    const auto file = temp_dir / "marker";
+    fs.touch_shared(file, VCPKG_LINE_INFO);
+    CHECK(fs.is_regular_file(file));
+    CHECK(fs.file_size(file, VCPKG_LINE_INFO) == 0);
+#if !defined(_WIN32)
+    struct stat s;
+    REQUIRE(::stat(file.c_str(), &s) == 0);
+    CHECK((s.st_mode & 0777) == 0666);
+#endif // ^^^ !_WIN32
+
+    fs.write_contents(file, "contents", VCPKG_LINE_INFO);
+    const auto before = fs.last_write_time(file, VCPKG_LINE_INFO);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    fs.touch_shared(file, VCPKG_LINE_INFO);
+    CHECK(fs.last_write_time(file, VCPKG_LINE_INFO) > before);
+    CHECK(fs.read_contents(file, VCPKG_LINE_INFO) == "contents");
+
+    std::error_code ec;
+    fs.touch_shared(temp_dir / "missing" / "marker", ec);
+    CHECK(ec);
+
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+}
+
 TEST_CASE ("LinesCollector", "[files]")
 {
     using Strings::LinesCollector;
@@ -974,6 +1110,64 @@ TEST_CASE ("LinesCollector", "[files]")
     CHECK(lc.extract() == std::vector<std::string>{"", "abc", ""});
 }
 
+static std::vector<std::string> collect_lines(StringView text)
+{
+    std::vector<std::string> result;
+    for (auto line : Strings::lines(text))
+    {
+        result.push_back(line.to_string());
+    }
+
+    return result;
+}
+
+TEST_CASE ("Strings::lines", "[files]")
+{
+    CHECK(collect_lines("") == std::vector<std::string>{""});
+    CHECK(collect_lines({"a\nb\r\nc\rd\r\r\n\ne\n\rx", 16}) ==
+          std::vector<std::string>{"a", "b", "c", "d", "", "", "e", "", "x"});
+    CHECK(collect_lines("\r\nhello \r\n\r\nworld") == std::vector<std::string>{"", "hello ", "", "world"});
+    CHECK(collect_lines("\r\n\r\n\r\n") == std::vector<std::string>{"", "", "", ""});
+    CHECK(collect_lines("a\r") == std::vector<std::string>{"a", ""});
+    CHECK(collect_lines("\rabc\n") == std::vector<std::string>{"", "abc", ""});
+}
+
+TEST_CASE ("map_for_read", "[files]")
+{
+    urbg_t urbg;
+
+    auto& fs = setup();
+
+    auto temp_dir = base_temporary_directory() / get_random_filename(urbg);
+    INFO("temp dir is: " << temp_dir.native());
+
+    fs.create_directory(temp_dir, VCPKG_LINE_INFO);
+    const auto empty_file = temp_dir / "empty.txt";
+    fs.write_contents(empty_file, "", VCPKG_LINE_INFO);
+    CHECK(fs.map_for_read(empty_file, VCPKG_LINE_INFO).contents().empty());
+
+    const auto bom_file = temp_dir / "bom.txt";
+    fs.write_contents(bom_file, "\xEF\xBB\xBFhello\nworld\n", VCPKG_LINE_INFO);
+    {
+        auto mapped = fs.map_for_read(bom_file, VCPKG_LINE_INFO);
+        CHECK(mapped.contents() == "hello\nworld\n");
+        CHECK(mapped.bytes().size() == 15);
+
+        const auto contents = mapped.contents();
+        auto moved = std::move(mapped);
+        CHECK(mapped.contents().empty());
+        CHECK(moved.contents().data() == contents.data());
+        CHECK(collect_lines(moved.contents()) == std::vector<std::string>{"hello", "world", ""});
+    }
+
+    std::error_code ec;
+    auto missing = fs.map_for_read(temp_dir / "missing.txt", ec);
+    CHECK(ec);
+    CHECK(missing.contents().empty());
+
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+}
+
 TEST_CASE ("find_file_recursively_up", "[files]")
 {
     auto& fs = setup();
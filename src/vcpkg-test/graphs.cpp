@@ -0,0 +1,75 @@
+#include <catch2/catch.hpp>
+
+#include <vcpkg/base/graphs.h>
+
+#include <string>
+#include <vector>
+
+using namespace vcpkg;
+using namespace vcpkg::Graphs;
+
+namespace
+{
+    using Edge = std::pair<uint32_t, uint32_t>;
+
+    // vertex n depends on vertex n + 1, up to `length`
+    struct ChainAdjacencyProvider final : AdjacencyProvider<int, int>
+    {
+        explicit ChainAdjacencyProvider(int length) : length(length) { }
+
+        std::vector<int> adjacency_list(const int& vertex) const override
+        {
+            if (vertex + 1 < length) return {vertex + 1};
+            return {};
+        }
+        std::string to_string(const int& vertex) const override { return std::to_string(vertex); }
+        int load_vertex_data(const int& vertex) const override { return vertex; }
+
+        int length;
+    };
+
+    std::vector<uint32_t> to_vector(View<uint32_t> view) { return {view.begin(), view.end()}; }
+}
+
+TEST_CASE ("topological_sort handles deep graphs", "[graphs]")
+{
+    constexpr int length = 200000;
+    const auto sorted = topological_sort(std::vector<int>{0}, ChainAdjacencyProvider{length}, nullptr);
+    REQUIRE(sorted.size() == length);
+    CHECK(sorted.front() == length - 1);
+    CHECK(sorted.back() == 0);
+}
+
+TEST_CASE ("topological_levels", "[graphs]")
+{
+    // 0 -> {1, 2}, 1 -> 3, 2 -> 3, 4 stands alone, 5 -> 0
+    const std::vector<Edge> edges{{0, 1}, {0, 2}, {1, 3}, {2, 3}, {5, 0}};
+    const DenseGraph graph(6, edges);
+    CHECK(to_vector(graph.dependencies(0)) == std::vector<uint32_t>{1, 2});
+    CHECK(graph.dependencies(4).size() == 0);
+
+    const auto levels = topological_levels(graph);
+    CHECK(levels.order == std::vector<uint32_t>{3, 4, 1, 2, 0, 5});
+    REQUIRE(levels.level_count() == 4);
+    CHECK(to_vector(levels.level(0)) == std::vector<uint32_t>{3, 4});
+    CHECK(to_vector(levels.level(1)) == std::vector<uint32_t>{1, 2});
+    CHECK(to_vector(levels.level(2)) == std::vector<uint32_t>{0});
+    CHECK(to_vector(levels.level(3)) == std::vector<uint32_t>{5});
+    CHECK(levels.cycle.empty());
+
+    const auto empty = topological_levels(DenseGraph(0, {}));
+    CHECK(empty.order.empty());
+    CHECK(empty.level_count() == 0);
+}
+
+TEST_CASE ("topological_levels reports a cycle", "[graphs]")
+{
+    // 0 -> 1 -> 2 -> 3 -> 1, and 4 -> 0; 5 is fine
+    const std::vector<Edge> edges{{0, 1}, {1, 2}, {2, 3}, {3, 1}, {4, 0}};
+    const auto levels = topological_levels(DenseGraph(6, edges));
+    CHECK(levels.order == std::vector<uint32_t>{5});
+    CHECK(levels.cycle == std::vector<uint32_t>{1, 2, 3});
+
+    const std::vector<Edge> self_loop{{0, 0}};
+    CHECK(topological_levels(DenseGraph(1, self_loop)).cycle == std::vector<uint32_t>{0});
+}
@@ -1,8 +1,17 @@
 #include <catch2/catch.hpp>
 
+#include <vcpkg/base/files.h>
+
 #include <vcpkg/install.h>
+#include <vcpkg/installedpaths.h>
+#include <vcpkg/listfile.h>
+#include <vcpkg/remove.h>
+#include <vcpkg/vcpkglib.h>
+
+#include <vcpkg-test/util.h>
 
 using namespace vcpkg;
+using namespace vcpkg::Test;
 
 TEST_CASE ("get_cmake_add_library_names", "[install]")
 {
@@ -138,3 +147,135 @@ cmake_policy(POP)
     res = Install::get_cmake_add_library_names("add_library(foo) add_library(foo) add_library(foo)");
     CHECK(res == std::vector<std::string>{"foo", "foo", "foo"});
 }
+
+TEST_CASE ("install over the files of a replaced package", "[install]")
+{
+    auto& fs = get_real_filesystem();
+    const auto temp_dir = base_temporary_directory() / "install-replaced";
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+    const auto package_dir = temp_dir / "packages" / "zlib_x86-windows";
+    fs.create_directories(package_dir / "include", VCPKG_LINE_INFO);
+    fs.write_contents(package_dir / "include" / "same.h", "same", VCPKG_LINE_INFO);
+    fs.write_contents(package_dir / "include" / "changed.h", "new", VCPKG_LINE_INFO);
+    fs.write_contents(package_dir / "include" / "added.h", "added", VCPKG_LINE_INFO);
+
+    const InstalledPaths installed(temp_dir / "installed");
+    const auto triplet_dir = installed.root() / "x86-windows";
+    fs.create_directories(triplet_dir / "include", VCPKG_LINE_INFO);
+    fs.create_directories(triplet_dir / "lib" / "old", VCPKG_LINE_INFO);
+    fs.write_contents(triplet_dir / "include" / "same.h", "same", VCPKG_LINE_INFO);
+    fs.write_contents(triplet_dir / "include" / "changed.h", "old", VCPKG_LINE_INFO);
+    fs.write_contents(triplet_dir / "include" / "removed.h", "removed", VCPKG_LINE_INFO);
+    fs.write_contents(triplet_dir / "lib" / "old" / "zlib.lib", "lib", VCPKG_LINE_INFO);
+    // another package's file in a directory which is no longer the replaced package's
+    fs.create_directories(triplet_dir / "share" / "other", VCPKG_LINE_INFO);
+    fs.write_contents(triplet_dir / "share" / "other" / "copyright", "other", VCPKG_LINE_INFO);
+    const std::vector<std::string> replaced_files{
+        "x86-windows/",
+        "x86-windows/include/",
+        "x86-windows/include/changed.h",
+        "x86-windows/include/removed.h",
+        "x86-windows/include/same.h",
+        "x86-windows/lib/",
+        "x86-windows/lib/old/",
+        "x86-windows/lib/old/zlib.lib",
+        "x86-windows/share/",
+    };
+
+    BinaryParagraph pgh;
+    pgh.spec = PackageSpec{"zlib", X86_WINDOWS};
+    pgh.version = "1.2.11";
+    const auto install_dir = Install::InstallDir::from_destination_root(installed, X86_WINDOWS, pgh);
+    fs.create_directories(installed.vcpkg_dir_info(), VCPKG_LINE_INFO);
+    Install::install_package_and_write_listfile(fs, package_dir, install_dir, replaced_files);
+
+    CHECK(fs.read_contents(triplet_dir / "include" / "same.h", VCPKG_LINE_INFO) == "same");
+    CHECK(fs.read_contents(triplet_dir / "include" / "changed.h", VCPKG_LINE_INFO) == "new");
+    CHECK(fs.read_contents(triplet_dir / "include" / "added.h", VCPKG_LINE_INFO) == "added");
+    CHECK(fs.read_contents(install_dir.listfile(), VCPKG_LINE_INFO) ==
+          "x86-windows/\nx86-windows/include/\nx86-windows/include/added.h\nx86-windows/include/changed.h\n"
+          "x86-windows/include/same.h\n");
+
+    // what install_package removes afterwards: the replaced files the new package does not have
+    Remove::remove_installed_files(fs,
+                                   installed.root(),
+                                   {"x86-windows/include/removed.h",
+                                    "x86-windows/lib/",
+                                    "x86-windows/lib/old/",
+                                    "x86-windows/lib/old/zlib.lib",
+                                    "x86-windows/share/"});
+    CHECK(!fs.exists(triplet_dir / "include" / "removed.h", IgnoreErrors{}));
+    CHECK(!fs.exists(triplet_dir / "lib", IgnoreErrors{}));
+    CHECK(fs.exists(triplet_dir / "include" / "same.h", IgnoreErrors{}));
+    CHECK(fs.read_contents(triplet_dir / "share" / "other" / "copyright", VCPKG_LINE_INFO) == "other");
+
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("remove the files of an abandoned replaced package", "[install]")
+{
+    auto& fs = get_real_filesystem();
+    const auto temp_dir = base_temporary_directory() / "install-abandoned-replaced";
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+    const InstalledPaths installed(temp_dir / "installed");
+    const auto triplet_dir = installed.root() / "x86-windows";
+    fs.create_directories(triplet_dir / "include", VCPKG_LINE_INFO);
+    fs.create_directories(installed.vcpkg_dir_info(), VCPKG_LINE_INFO);
+    fs.create_directories(installed.vcpkg_dir_updates(), VCPKG_LINE_INFO);
+    fs.write_contents(triplet_dir / "include" / "zlib.h", "zlib", VCPKG_LINE_INFO);
+    fs.write_contents(triplet_dir / "include" / "taken.h", "other", VCPKG_LINE_INFO);
+
+    // another package has installed one of the replaced package's files since it was replaced
+    fs.write_contents(installed.vcpkg_dir_status_file(),
+                      "Package: other\nVersion: 1\nArchitecture: x86-windows\nMulti-Arch: same\n"
+                      "Status: install ok installed\n",
+                      VCPKG_LINE_INFO);
+    write_listfile(fs,
+                   installed.vcpkg_dir_info() / "other_1_x86-windows.list",
+                   {"x86-windows/", "x86-windows/include/", "x86-windows/include/taken.h"});
+    const auto replaced_listfiles_dir = installed.vcpkg_dir_replaced() / "1234";
+    const auto replaced_listfile = replaced_listfiles_dir / "zlib_x86-windows.list";
+    fs.create_directories(replaced_listfiles_dir, VCPKG_LINE_INFO);
+    fs.write_contents(replaced_listfile,
+                      "x86-windows/\nx86-windows/include/\nx86-windows/include/taken.h\nx86-windows/include/zlib.h\n",
+                      VCPKG_LINE_INFO);
+
+    auto status_db = database_load_check(fs, installed);
+    SECTION ("the replacing process is still running")
+    {
+        const auto lock = fs.take_exclusive_file_lock(replaced_listfiles_dir + ".lock", VCPKG_LINE_INFO);
+        Remove::remove_abandoned_replaced_files(fs, installed, status_db);
+        CHECK(fs.exists(replaced_listfile, IgnoreErrors{}));
+        CHECK(fs.exists(triplet_dir / "include" / "zlib.h", IgnoreErrors{}));
+    }
+
+    SECTION ("the replacing process exited")
+    {
+        Remove::remove_abandoned_replaced_files(fs, installed, status_db);
+        CHECK(!fs.exists(replaced_listfiles_dir, IgnoreErrors{}));
+        CHECK(!fs.exists(triplet_dir / "include" / "zlib.h", IgnoreErrors{}));
+        CHECK(fs.read_contents(triplet_dir / "include" / "taken.h", VCPKG_LINE_INFO) == "other");
+    }
+
+    SECTION ("a running process holds one lock for all the packages it replaced")
+    {
+        Path listfiles_dir;
+        {
+            Remove::ReplacedListfiles replaced_listfiles(fs, installed);
+            const auto zlib_listfile = replaced_listfiles.listfile_path(PackageSpec{"zlib", X86_WINDOWS});
+            const auto other_listfile = replaced_listfiles.listfile_path(PackageSpec{"other", X86_WINDOWS});
+            listfiles_dir = zlib_listfile.parent_path();
+            CHECK(other_listfile.parent_path() == listfiles_dir.native());
+            fs.write_contents(zlib_listfile, "x86-windows/include/zlib.h\n", VCPKG_LINE_INFO);
+            Remove::remove_abandoned_replaced_files(fs, installed, status_db);
+            CHECK(fs.exists(zlib_listfile, IgnoreErrors{}));
+            replaced_listfiles.release(PackageSpec{"zlib", X86_WINDOWS});
+            CHECK(!fs.exists(zlib_listfile, IgnoreErrors{}));
+        }
+
+        CHECK(!fs.exists(listfiles_dir, IgnoreErrors{}));
+        CHECK(!fs.exists(listfiles_dir + ".lock", IgnoreErrors{}));
+    }
+
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+}
@@ -0,0 +1,190 @@
+#include <catch2/catch.hpp>
+
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/util.h>
+
+#include <vcpkg/listfile.h>
+
+#include <vcpkg-test/util.h>
+
+using namespace vcpkg;
+using namespace vcpkg::Test;
+
+namespace
+{
+    std::vector<std::string> decoded_paths(const FrontCodedPaths& paths)
+    {
+        std::vector<std::string> result;
+        for (auto&& path : paths)
+        {
+            result.push_back(path.to_string());
+        }
+
+        return result;
+    }
+
+    std::vector<std::string> listed_paths(const Listfile& listfile)
+    {
+        std::vector<std::string> result;
+        listfile.for_each([&](StringView path) { result.push_back(path.to_string()); });
+        return result;
+    }
+}
+
+TEST_CASE ("FrontCodedPaths round trip", "[listfile]")
+{
+    std::vector<std::string> sorted_paths{"x64-linux/"};
+    for (int i = 0; i < 100; ++i)
+    {
+        sorted_paths.push_back(Strings::concat("x64-linux/include/boost/", 1000 + i, ".hpp"));
+    }
+
+    sorted_paths.push_back("x64-linux/share/");
+    sorted_paths.push_back("x64-linux/share/boost/copyright");
+
+    const auto encoded = FrontCodedPaths::encode(sorted_paths);
+    auto maybe_paths = FrontCodedPaths::decode(encoded);
+    REQUIRE(maybe_paths);
+    const auto& paths = *maybe_paths.get();
+    CHECK(paths.size() == sorted_paths.size());
+    CHECK(decoded_paths(paths) == sorted_paths);
+
+    for (auto&& path : sorted_paths)
+    {
+        CHECK(paths.contains(path));
+    }
+
+    CHECK(!paths.contains(""));
+    CHECK(!paths.contains("a"));
+    CHECK(!paths.contains("x64-linux"));
+    CHECK(!paths.contains("x64-linux/include/boost/1000.h"));
+    CHECK(!paths.contains("x64-linux/include/boost/1050.hpp2"));
+    CHECK(!paths.contains("z"));
+
+    // shared prefixes make the encoding smaller than the paths themselves
+    size_t total_size = 0;
+    for (auto&& path : sorted_paths)
+    {
+        total_size += path.size();
+    }
+
+    CHECK(encoded.size() < total_size / 2);
+}
+
+TEST_CASE ("FrontCodedPaths finds UTF-8 paths", "[listfile]")
+{
+    // sorted as std::string sorts them, where UTF-8 lead bytes come after ASCII
+    std::vector<std::string> sorted_paths;
+    for (int i = 0; i < 40; ++i)
+    {
+        sorted_paths.push_back(Strings::concat("x64-linux/share/doc/", i, ".txt"));
+        sorted_paths.push_back(Strings::concat("x64-linux/share/doc/z", i, ".txt"));
+        sorted_paths.push_back(Strings::concat("x64-linux/share/doc/\xc3\xa9t\xc3\xa9", i, ".txt"));
+        sorted_paths.push_back(Strings::concat("x64-linux/share/doc/\xe6\x96\x87", i, ".txt"));
+    }
+
+    Util::sort(sorted_paths);
+    const auto encoded = FrontCodedPaths::encode(sorted_paths);
+    auto maybe_paths = FrontCodedPaths::decode(encoded);
+    REQUIRE(maybe_paths);
+    const auto& paths = *maybe_paths.get();
+    CHECK(decoded_paths(paths) == sorted_paths);
+    for (auto&& path : sorted_paths)
+    {
+        CHECK(paths.contains(path));
+    }
+
+    CHECK(!paths.contains("x64-linux/share/doc/\xc3\xa9t\xc3\xa9.txt"));
+    CHECK(!paths.contains("x64-linux/share/doc/\xff"));
+}
+
+TEST_CASE ("FrontCodedPaths empty and corrupted", "[listfile]")
+{
+    const auto encoded = FrontCodedPaths::encode(std::vector<std::string>{});
+    auto maybe_paths = FrontCodedPaths::decode(encoded);
+    REQUIRE(maybe_paths);
+    CHECK(maybe_paths.get()->size() == 0);
+    CHECK(!maybe_paths.get()->contains(""));
+
+    const std::vector<std::string> sorted_paths{"a/", "a/b", "a/c"};
+    const auto valid = FrontCodedPaths::encode(sorted_paths);
+    CHECK(!FrontCodedPaths::decode(""));
+    CHECK(!FrontCodedPaths::decode(StringView{valid}.substr(0, valid.size() - 1)));
+    CHECK(!FrontCodedPaths::decode(valid + "x"));
+
+    // a shared prefix longer than the previous path
+    auto corrupted = valid;
+    corrupted[corrupted.size() - 3] = '\x09';
+    CHECK(!FrontCodedPaths::decode(corrupted));
+}
+
+TEST_CASE ("Listfile uses the front-coded copy while it is up to date", "[listfile]")
+{
+    auto& fs = get_real_filesystem();
+    const auto temp_dir = base_temporary_directory() / "listfile";
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+    fs.create_directories(temp_dir, VCPKG_LINE_INFO);
+    const auto listfile_path = temp_dir / "zlib_1.2.11_x64-linux.list";
+
+    write_listfile(fs, listfile_path, {"x64-linux/include/zlib.h", "x64-linux/", "x64-linux/include/"});
+    CHECK(fs.read_contents(listfile_path, VCPKG_LINE_INFO) ==
+          "x64-linux/\nx64-linux/include/\nx64-linux/include/zlib.h\n");
+    const std::vector<std::string> expected{"x64-linux/", "x64-linux/include/", "x64-linux/include/zlib.h"};
+    {
+        const auto listfile = Listfile::load(fs, listfile_path, VCPKG_LINE_INFO);
+        REQUIRE(listfile.front_coded_paths());
+        CHECK(listed_paths(listfile) == expected);
+    }
+
+    // an older vcpkg rewrote the listfile, leaving the copy behind
+    fs.write_contents(listfile_path, "x64-linux/\r\n  x64-linux/lib/  \r\n\r\n", VCPKG_LINE_INFO);
+    {
+        const auto listfile = Listfile::load(fs, listfile_path, VCPKG_LINE_INFO);
+        CHECK(!listfile.front_coded_paths());
+        CHECK(listed_paths(listfile) == std::vector<std::string>{"x64-linux/", "x64-linux/lib/"});
+    }
+
+    remove_listfile(fs, listfile_path, VCPKG_LINE_INFO);
+    CHECK(!fs.exists(listfile_path, IgnoreErrors{}));
+    CHECK(!fs.exists(front_coded_listfile_path(listfile_path), IgnoreErrors{}));
+
+    std::error_code ec;
+    Listfile::load(fs, listfile_path, ec);
+    CHECK(ec);
+
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("write_listfile leaves loaded listfiles intact", "[listfile]")
+{
+    auto& fs = get_real_filesystem();
+    const auto temp_dir = base_temporary_directory() / "listfile-rewrite";
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+    fs.create_directories(temp_dir, VCPKG_LINE_INFO);
+    const auto listfile_path = temp_dir / "zlib_1.2.11_x64-linux.list";
+
+    std::vector<std::string> old_paths;
+    for (int i = 0; i < 1000; ++i)
+    {
+        old_paths.push_back(Strings::concat("x64-linux/include/header", i, ".h"));
+    }
+
+    Util::sort(old_paths);
+    write_listfile(fs, listfile_path, old_paths);
+    fs.remove(front_coded_listfile_path(listfile_path), VCPKG_LINE_INFO);
+    const auto text_listfile = Listfile::load(fs, listfile_path, VCPKG_LINE_INFO);
+    REQUIRE(!text_listfile.front_coded_paths());
+    write_listfile(fs, listfile_path, old_paths);
+    const auto front_coded_listfile = Listfile::load(fs, listfile_path, VCPKG_LINE_INFO);
+    REQUIRE(front_coded_listfile.front_coded_paths());
+
+    // another process rewrites the listfile while this one has both files mapped
+    write_listfile(fs, listfile_path, {"x64-linux/"});
+    CHECK(listed_paths(text_listfile) == old_paths);
+    CHECK(listed_paths(front_coded_listfile) == old_paths);
+    CHECK(listed_paths(Listfile::load(fs, listfile_path, VCPKG_LINE_INFO)) == std::vector<std::string>{"x64-linux/"});
+    CHECK(fs.get_files_non_recursive(temp_dir, VCPKG_LINE_INFO).size() == 2);
+
+    fs.remove_all(temp_dir, VCPKG_LINE_INFO);
+}
@@ -1,5 +1,6 @@
 #include <catch2/catch.hpp>
 
+#include <vcpkg/base/files.h>
 #include <vcpkg/base/strings.h>
 
 #include <vcpkg/paragraphs.h>
@@ -551,3 +552,37 @@ TEST_CASE ("BinaryParagraph serialize abi", "[paragraph]")
     REQUIRE(pghs.size() == 1);
     REQUIRE(pghs[0]["Abi"].first == "123abc");
 }
+
+TEST_CASE ("try_load_port_version", "[paragraph]")
+{
+    using namespace vcpkg;
+    auto& fs = get_real_filesystem();
+    const auto ports = Test::base_temporary_directory() / "try-load-port-version";
+    fs.remove_all(ports, VCPKG_LINE_INFO);
+    fs.create_directories(ports / "manifest", VCPKG_LINE_INFO);
+    fs.create_directories(ports / "control", VCPKG_LINE_INFO);
+    fs.create_directories(ports / "broken", VCPKG_LINE_INFO);
+
+    fs.write_contents(ports / "manifest" / "vcpkg.json",
+                      R"({"name": "manifest", "version-semver": "1.2.3", "port-version": 4, "dependencies": ["x"]})",
+                      VCPKG_LINE_INFO);
+    fs.write_contents(ports / "control" / "CONTROL",
+                      "Source: control\nVersion: 2021-01-01\nPort-Version: 2\n\nFeature: f\nDescription: d\n",
+                      VCPKG_LINE_INFO);
+    fs.write_contents(ports / "broken" / "vcpkg.json", R"({"name": "broken"})", VCPKG_LINE_INFO);
+
+    for (auto&& name : {"manifest", "control"})
+    {
+        auto version = Paragraphs::try_load_port_version(fs, ports / name);
+        REQUIRE(version);
+        auto scf = Paragraphs::try_load_port(fs, ports / name);
+        REQUIRE(scf);
+        CHECK(*version.get() == scf.value_or_exit(VCPKG_LINE_INFO)->to_version());
+    }
+
+    CHECK(Paragraphs::try_load_port_version(fs, ports / "manifest") == Version{"1.2.3", 4});
+    CHECK(!Paragraphs::try_load_port_version(fs, ports / "broken"));
+    CHECK(!Paragraphs::try_load_port_version(fs, ports / "missing"));
+
+    fs.remove_all(ports, VCPKG_LINE_INFO);
+}
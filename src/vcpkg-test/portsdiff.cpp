@@ -0,0 +1,80 @@
+#include <catch2/catch.hpp>
+
+#include <vcpkg/commands.portsdiff.h>
+#include <vcpkg/paragraphparser.h>
+
+using namespace vcpkg;
+using namespace vcpkg::Commands::PortsDiff;
+
+namespace
+{
+    // what `git cat-file --batch` prints for an object with `contents`
+    std::string batch_object(StringView contents)
+    {
+        return Strings::concat("0123456789abcdef0123456789abcdef01234567 blob ", contents.size(), '\n', contents, '\n');
+    }
+
+    std::string batch_missing(StringView object) { return Strings::concat(object, " missing\n"); }
+}
+
+TEST_CASE ("portsdiff batch input", "[portsdiff]")
+{
+    const std::vector<std::pair<std::string, std::string>> port_trees{{"a", "1111"}, {"b", "2222"}};
+    CHECK(make_port_files_batch(port_trees) == "1111:vcpkg.json\n1111:CONTROL\n2222:vcpkg.json\n2222:CONTROL\n");
+}
+
+TEST_CASE ("portsdiff reads versions from batch output", "[portsdiff]")
+{
+    const std::vector<std::pair<std::string, std::string>> port_trees{
+        {"manifest", "1111"}, {"control", "2222"}, {"missing", "3333"}, {"broken", "4444"}};
+    const auto output = Strings::concat(batch_object(R"({"name": "manifest", "version": "1.0", "port-version": 2})"),
+                                        batch_missing("1111:CONTROL"),
+                                        batch_missing("2222:vcpkg.json"),
+                                        batch_object("Source: control\nVersion: 3\n"),
+                                        batch_missing("3333:vcpkg.json"),
+                                        batch_missing("3333:CONTROL"),
+                                        batch_object("{\"name\":"),
+                                        batch_missing("4444:CONTROL"));
+
+    std::vector<std::unique_ptr<ParseControlErrorInfo>> errors;
+    const auto versions = parse_port_files_batch(port_trees, output, errors);
+    REQUIRE(versions.size() == 2);
+    CHECK(versions.at("manifest") == Version("1.0", 2));
+    CHECK(versions.at("control") == Version("3", 0));
+    REQUIRE(errors.size() == 2);
+    CHECK(errors[0]->name == "missing");
+    CHECK(errors[1]->name == "broken");
+}
+
+TEST_CASE ("portsdiff finds added, removed and changed ports", "[portsdiff]")
+{
+    const std::vector<std::pair<std::string, std::string>> previous_trees{
+        {"changed", "1111"}, {"removed", "2222"}, {"same-version", "3333"}};
+    const auto previous_output = Strings::concat(batch_object(R"({"name": "changed", "version": "1.0"})"),
+                                                 batch_missing("1111:CONTROL"),
+                                                 batch_missing("2222:vcpkg.json"),
+                                                 batch_object("Source: removed\nVersion: 1\n"),
+                                                 batch_object(R"({"name": "same-version", "version": "5"})"),
+                                                 batch_missing("3333:CONTROL"));
+    const std::vector<std::pair<std::string, std::string>> current_trees{
+        {"added", "5555"}, {"changed", "6666"}, {"same-version", "7777"}};
+    const auto current_output = Strings::concat(batch_missing("5555:vcpkg.json"),
+                                                batch_object("Source: added\nVersion: 2\n"),
+                                                batch_object(R"({"name": "changed", "version": "1.1"})"),
+                                                batch_missing("6666:CONTROL"),
+                                                batch_object(R"({"name": "same-version", "version": "5"})"),
+                                                batch_missing("7777:CONTROL"));
+
+    std::vector<std::unique_ptr<ParseControlErrorInfo>> errors;
+    const auto previous = parse_port_files_batch(previous_trees, previous_output, errors);
+    const auto current = parse_port_files_batch(current_trees, current_output, errors);
+    CHECK(errors.empty());
+
+    const auto changes = find_port_changes(previous, current);
+    CHECK(changes.added_ports == std::vector<std::string>{"added"});
+    CHECK(changes.removed_ports == std::vector<std::string>{"removed"});
+    REQUIRE(changes.updated_ports.size() == 1);
+    CHECK(changes.updated_ports[0].port == "changed");
+    CHECK(changes.updated_ports[0].version_diff.left == Version("1.0", 0));
+    CHECK(changes.updated_ports[0].version_diff.right == Version("1.1", 0));
+}
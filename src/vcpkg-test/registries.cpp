@@ -1,10 +1,15 @@
 #include <catch2/catch.hpp>
 
+#include <vcpkg/base/files.h>
 #include <vcpkg/base/jsonreader.h>
 
 #include <vcpkg/configuration.h>
 #include <vcpkg/registries.h>
 
+#include <vcpkg-test/util.h>
+
+#include <atomic>
+
 using namespace vcpkg;
 
 namespace
@@ -19,7 +24,10 @@ namespace
 
         Optional<Version> get_baseline_version(StringView) const override { return nullopt; }
 
+        void prefetch() const override { ++prefetch_count; }
+
         int number;
+        mutable std::atomic<int> prefetch_count{0};
 
         TestRegistryImplementation(int n) : number(n) { }
     };
@@ -87,6 +95,26 @@ static vcpkg::Optional<Configuration> visit_default_registry(Json::Reader& r, Js
     return r.visit(config, get_configuration_deserializer());
 }
 
+TEST_CASE ("registry_set_prefetches_all_registries", "[registries]")
+{
+    std::vector<Registry> rs;
+    rs.push_back(make_registry(1, {"p1"}));
+    rs.push_back(make_registry(2, {"p2"}));
+    rs.push_back(make_registry(3, {"p3"}));
+    RegistrySet set(std::make_unique<TestRegistryImplementation>(0), std::move(rs));
+
+    set.prefetch();
+
+    auto get_prefetch_count = [](const RegistryImplementation* r) {
+        return dynamic_cast<const TestRegistryImplementation&>(*r).prefetch_count.load();
+    };
+    CHECK(get_prefetch_count(set.default_registry()) == 1);
+    for (auto&& registry : set.registries())
+    {
+        CHECK(get_prefetch_count(&registry.implementation()) == 1);
+    }
+}
+
 TEST_CASE ("registry_parsing", "[registries]")
 {
     {
@@ -428,3 +456,58 @@ TEST_CASE ("filesystem_version_db_parsing", "[registries]")
         CHECK(!r.errors().empty());
     }
 }
+
+TEST_CASE ("packed_versions_db", "[registries]")
+{
+    auto& fs = get_real_filesystem();
+    const auto versions = Test::base_temporary_directory() / "packed-versions-db";
+    fs.remove_all(versions, VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(versions / "baseline.json", R"({"default": {}})", VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(versions / "z-" / "zlib.json",
+                               R"json({"versions": [
+    {"git-tree": "9b07f8a38bbc4d13f8411921e6734753e15f8d50", "version": "1.2.12", "port-version": 2},
+    {"git-tree": "12b84a31469a78dd4b42dcf58a27d4600f6b2d48", "version-date": "2021-01-14"}
+]})json",
+                               VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(versions / "f-" / "fmt.json",
+                               R"json({"versions": [
+    {"git-tree": "bd4565e8ab55bc5e098a1750fa5ff0bc4406ca9b", "version-semver": "8.0.1"}
+]})json",
+                               VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(versions / "f-" / "fltk.json", R"json({"versions": []})json", VCPKG_LINE_INFO);
+
+    const auto db_path = PackedVersionsDb::path_for(versions);
+    fs.remove(db_path, IgnoreErrors{});
+    CHECK(!PackedVersionsDb::open(fs, db_path).has_value());
+    auto db = PackedVersionsDb::load_or_build(fs, versions).value_or_exit(VCPKG_LINE_INFO);
+    CHECK(fs.exists(db_path, IgnoreErrors{}));
+    // the versions tree itself is left as it was
+    CHECK(fs.get_regular_files_recursive(versions, VCPKG_LINE_INFO).size() == 4);
+    CHECK(db.port_names() == std::vector<std::string>{"fltk", "fmt", "zlib"});
+
+    auto zlib = db.find("zlib").value_or_exit(VCPKG_LINE_INFO);
+    REQUIRE(zlib.size() == 2);
+    CHECK(zlib[0].version == Version{"1.2.12", 2});
+    CHECK(zlib[0].scheme == VersionScheme::Relaxed);
+    CHECK(zlib[0].git_tree == "9b07f8a38bbc4d13f8411921e6734753e15f8d50");
+    CHECK(zlib[1].version == Version{"2021-01-14", 0});
+    CHECK(zlib[1].scheme == VersionScheme::Date);
+    auto fmt = db.find("fmt").value_or_exit(VCPKG_LINE_INFO);
+    REQUIRE(fmt.size() == 1);
+    CHECK(fmt[0].scheme == VersionScheme::Semver);
+    CHECK(db.find("fltk").value_or_exit(VCPKG_LINE_INFO).empty());
+    CHECK(!db.find("curl"));
+    CHECK(!db.find("zzz"));
+
+    // a damaged database is rebuilt
+    fs.write_contents(db_path, "vcpkg packed versions database v1\n\xff\xff\xff\xff", VCPKG_LINE_INFO);
+    CHECK(!PackedVersionsDb::open(fs, db_path).has_value());
+    CHECK(PackedVersionsDb::load_or_build(fs, versions).value_or_exit(VCPKG_LINE_INFO).find("zlib"));
+
+    fs.write_contents_and_dirs(
+        versions / "c-" / "curl.json", R"json({"versions": [{"version": "1"}]})json", VCPKG_LINE_INFO);
+    CHECK(!PackedVersionsDb::pack(fs, versions).has_value());
+
+    fs.remove_all(versions, VCPKG_LINE_INFO);
+    fs.remove(db_path, VCPKG_LINE_INFO);
+}
@@ -4,6 +4,8 @@
 #include <vcpkg/base/stringview.h>
 #include <vcpkg/base/zstringview.h>
 
+#include <string>
+
 using namespace vcpkg;
 
 template<std::size_t N>
@@ -22,6 +24,19 @@ TEST_CASE ("string view operator==", "[stringview]")
     REQUIRE(sv("hey") != sv("hex"));
 }
 
+TEST_CASE ("string view operator<", "[stringview]")
+{
+    REQUIRE(sv("hey") < sv("heys"));
+    REQUIRE(!(sv("heys") < sv("hey")));
+    REQUIRE(!(sv("hey") < sv("hey")));
+    REQUIRE(sv("") < sv("a"));
+    REQUIRE(!(sv("") < sv("")));
+    // UTF-8 lead bytes sort after ASCII, as in std::string
+    REQUIRE(sv("z") < sv("\xc3\xa9"));
+    REQUIRE(!(sv("\xc3\xa9") < sv("z")));
+    REQUIRE((StringView{"\xc3\xa9"} < StringView{"z"}) == (std::string{"\xc3\xa9"} < std::string{"z"}));
+}
+
 TEST_CASE ("zstring_view substr", "[stringview]")
 {
     static constexpr StringLiteral example = "text";
@@ -2,6 +2,7 @@
 
 #include <catch2/catch.hpp>
 
+#include <vcpkg/base/jobserver.h>
 #include <vcpkg/base/optional.h>
 #include <vcpkg/base/strings.h>
 #include <vcpkg/base/stringview.h>
@@ -143,3 +144,49 @@ TEST_CASE ("cmdlinebuilder", "[system]")
     REQUIRE(cmd.command_line() == "\"trailing\\\\slash\\\\\" \"inner\\\"quotes\"");
 #endif
 }
+
+TEST_CASE ("parse_jobserver_auth", "[system]")
+{
+    using vcpkg::parse_jobserver_auth;
+
+    CHECK_FALSE(parse_jobserver_auth("").has_value());
+    CHECK_FALSE(parse_jobserver_auth("s -j8").has_value());
+
+    auto pipe_auth = parse_jobserver_auth(" -j8 --jobserver-auth=3,4").value_or_exit(VCPKG_LINE_INFO);
+    CHECK(pipe_auth.read_fd == 3);
+    CHECK(pipe_auth.write_fd == 4);
+    CHECK(pipe_auth.name.empty());
+
+    auto old_auth = parse_jobserver_auth("-j --jobserver-fds=5,6").value_or_exit(VCPKG_LINE_INFO);
+    CHECK(old_auth.read_fd == 5);
+    CHECK(old_auth.write_fd == 6);
+
+    auto fifo_auth = parse_jobserver_auth("-j4 --jobserver-auth=fifo:/tmp/GMfifo1234").value_or_exit(VCPKG_LINE_INFO);
+    CHECK(fifo_auth.name == "/tmp/GMfifo1234");
+    CHECK(fifo_auth.read_fd == -1);
+
+    auto semaphore_auth = parse_jobserver_auth("--jobserver-auth=gmake_semaphore_42").value_or_exit(VCPKG_LINE_INFO);
+    CHECK(semaphore_auth.name == "gmake_semaphore_42");
+
+    // the last option wins, and make marks closed descriptors as negative
+    auto last_auth = parse_jobserver_auth("--jobserver-auth=3,4 --jobserver-auth=7,8").value_or_exit(VCPKG_LINE_INFO);
+    CHECK(last_auth.read_fd == 7);
+    CHECK_FALSE(parse_jobserver_auth("--jobserver-auth=3,4 --jobserver-auth=-2,-2").has_value());
+}
+
+#if !defined(_WIN32)
+TEST_CASE ("add_environment_variable", "[system]")
+{
+    using namespace vcpkg;
+
+    Environment env;
+    add_environment_variable(env, "VCPKG_TEST_FIRST", "one");
+    add_environment_variable(env, "VCPKG_TEST_SECOND", "-j4 --jobserver-auth=3,4");
+    auto result = cmd_execute_and_capture_output(
+        Command("printenv").string_arg("VCPKG_TEST_FIRST").string_arg("VCPKG_TEST_SECOND"),
+        default_working_directory,
+        env);
+    CHECK(result.exit_code == 0);
+    CHECK(result.output == "one\n-j4 --jobserver-auth=3,4\n");
+}
+#endif
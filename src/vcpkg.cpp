@@ -2,6 +2,7 @@
 
 #include <vcpkg/base/chrono.h>
 #include <vcpkg/base/files.h>
+#include <vcpkg/base/jobserver.h>
 #include <vcpkg/base/messages.h>
 #include <vcpkg/base/pragmas.h>
 #include <vcpkg/base/strings.h>
@@ -207,6 +208,7 @@ int main(const int argc, const char* const* const argv)
     set_environment_variable("CLICOLOR", "0");
 
     Checks::register_global_shutdown_handler([]() {
+        wait_for_background_removals();
         const auto elapsed_us_inner = GlobalState::timer.microseconds();
 
         bool debugging = Debug::g_debugging;
@@ -271,6 +273,9 @@ int main(const int argc, const char* const* const argv)
     VcpkgCmdArguments::imbue_or_apply_process_recursion(args);
     args.check_feature_flag_consistency();
 
+    // Share one budget of jobs between vcpkg's own threads and the builds it launches.
+    initialize_jobserver();
+
     bool to_enable_metrics = true;
     auto disable_metrics_tag_file_path = get_exe_path_of_current_process();
     disable_metrics_tag_file_path.replace_filename("vcpkg.disable-metrics");
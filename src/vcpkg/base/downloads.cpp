@@ -298,10 +298,11 @@ namespace vcpkg
             cmd.string_arg(url);
         }
 
-        std::vector<std::string> lines;
+        // the output is only kept for diagnostics, so append it to a single buffer instead of storing each line
+        std::string output;
 
-        auto res = cmd_execute_and_stream_lines(cmd, [out, &lines](StringView line) {
-            lines.push_back(line.to_string());
+        auto res = cmd_execute_and_stream_lines(cmd, [out, &output](StringView line) {
+            Strings::append(output, line, '\n');
             if (Strings::starts_with(line, guid_marker))
             {
                 out->push_back(std::strtol(line.data() + guid_marker.size(), nullptr, 10));
@@ -315,7 +316,7 @@ namespace vcpkg
                                           msg::format(msg::msgErrorMessage)
                                               .append(msg::format(msgCurlReportedUnexpectedResults,
                                                                   msg::command_line = cmd.command_line(),
-                                                                  msg::actual = Strings::join("\n", lines))));
+                                                                  msg::actual = output)));
         }
     }
     std::vector<int> url_heads(View<std::string> urls, View<std::string> headers)
@@ -623,6 +624,13 @@ namespace vcpkg
         return nullopt;
     }
 
+    std::unique_ptr<IExclusiveFileLock> lock_download(Filesystem& fs, const Path& download_path, StringView sha512)
+    {
+        const auto locks_dir = Path(download_path.parent_path()) / ".vcpkg-locks";
+        fs.create_directories(locks_dir, VCPKG_LINE_INFO);
+        return fs.take_exclusive_file_lock(locks_dir / sha512, VCPKG_LINE_INFO);
+    }
+
     View<std::string> azure_blob_headers()
     {
         static std::string s_headers[2] = {"x-ms-version: 2020-04-08", "x-ms-blob-type: BlockBlob"};
@@ -1,6 +1,8 @@
 #include <vcpkg/base/system_headers.h>
 
+#include <vcpkg/base/chrono.h>
 #include <vcpkg/base/files.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.h>
 #include <vcpkg/base/system.print.h>
@@ -15,7 +17,9 @@
 #include <limits.h>
 
 #include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #endif // !_WIN32
 
 #if defined(__linux__)
@@ -25,7 +29,13 @@
 #endif // ^^^ defined(__APPLE__)
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <list>
+#include <map>
+#include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 
@@ -792,122 +802,237 @@ namespace
         ec.assign(errno, std::generic_category());
     }
 
-    void vcpkg_remove_all_directory(const Path& base,
-                                    std::error_code& ec,
-                                    Path& failure_point,
-                                    struct stat& base_lstat);
-
-    void vcpkg_remove_all(const Path& base,
-                          std::error_code& ec,
-                          Path& failure_point,
-                          PosixDType base_dtype = PosixDType::Unknown)
+    // Removes the directory tree at `base` on as many threads as there are job tokens. Workers share a stack of
+    // directories to scan; each directory is read through its own descriptor, its files are unlinked relative to
+    // that descriptor, and its subdirectories are pushed for any worker to take. A directory is removed as soon as
+    // its own scan and those of all its subdirectories are done. Entries which disappear concurrently are ignored.
+    struct ParallelRemoveAll
     {
-        struct stat s;
-        if (base_dtype == PosixDType::Unknown)
+        struct DirNode
         {
-            // We have to check that `base` isn't a symbolic link
-            if (::lstat(base.c_str(), &s) != 0)
+            DirNode(Path&& path, DirNode* parent) : path(std::move(path)), parent(parent) { }
+
+            Path path;
+            DirNode* parent;
+            // this directory's own scan, plus each subdirectory not yet removed
+            std::atomic<size_t> pending{1};
+        };
+
+        explicit ParallelRemoveAll(const Path& base) { m_nodes.emplace_back(Path(base), nullptr); }
+
+        void run(std::error_code& ec, Path& failure_point)
+        {
+            // small trees are removed without starting any threads
+            scan(m_nodes.front());
+            if (!m_stack.empty())
             {
-                if (errno != ENOENT && errno != ENOTDIR)
+                execute_in_parallel(static_cast<size_t>(get_concurrency()), [this]() { work(); });
+            }
+
+            ec = m_ec;
+            failure_point = std::move(m_failure_point);
+        }
+
+    private:
+        void work()
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            for (;;)
+            {
+                m_cv.wait(lock, [this]() { return !m_stack.empty() || m_unscanned == 0; });
+                if (m_stack.empty())
                 {
-                    mark_recursive_error(base, ec, failure_point);
                     return;
                 }
 
-                ec.clear();
-                return;
-            }
+                DirNode* node = m_stack.back();
+                m_stack.pop_back();
+                lock.unlock();
+                if (!m_failed.load(std::memory_order_relaxed))
+                {
+                    scan(*node);
+                }
 
-            if (S_ISDIR(s.st_mode))
-            {
-                vcpkg_remove_all_directory(base, ec, failure_point, s);
-                return;
+                lock.lock();
+                if (--m_unscanned == 0)
+                {
+                    m_cv.notify_all();
+                }
             }
         }
-        else if (base_dtype == PosixDType::Directory)
+
+        void fail(const Path& path, int err)
         {
-            // establish `base` being writable before calling vcpkg_remove_all_directory
-            if (::lstat(base.c_str(), &s) != 0)
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (!m_failed.exchange(true))
             {
-                // no ENOENT check here since we were supposed to be visiting a directory
-                mark_recursive_error(base, ec, failure_point);
-                return;
+                m_ec.assign(err, std::generic_category());
+                m_failure_point = path;
             }
+        }
 
-            if (!S_ISDIR(s.st_mode))
+        // called once per scan and once per removed subdirectory; removes the directory on the last call
+        void finish(DirNode* node)
+        {
+            while (node && node->pending.fetch_sub(1) == 1)
             {
-                // if it isn't still a directory something is racy
-                ec = std::make_error_code(std::errc::device_or_resource_busy);
-                failure_point = base;
-                return;
-            }
+                if (::rmdir(node->path.c_str()) != 0 && errno != ENOENT)
+                {
+                    fail(node->path, errno);
+                    return;
+                }
 
-            vcpkg_remove_all_directory(base, ec, failure_point, s);
-            return;
+                node = node->parent;
+            }
         }
 
-        if (::unlink(base.c_str()) != 0)
+        int open_dir(const Path& path)
         {
-            mark_recursive_error(base, ec, failure_point);
+            constexpr int flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+            int fd = ::open(path.c_str(), flags);
+            if (fd < 0 && errno == EACCES)
+            {
+                // the execute bit on directories is needed to open entries inside them, and write to remove them
+                struct stat s;
+                if (::lstat(path.c_str(), &s) == 0 && S_ISDIR(s.st_mode) &&
+                    ::chmod(path.c_str(), s.st_mode | S_IRUSR | S_IWUSR | S_IXUSR) == 0)
+                {
+                    fd = ::open(path.c_str(), flags);
+                }
+                else
+                {
+                    errno = EACCES;
+                }
+            }
+
+            return fd;
         }
-    }
 
-    void vcpkg_remove_all_directory(const Path& base, std::error_code& ec, Path& failure_point, struct stat& base_lstat)
-    {
-        // ensure that the directory is writable and executable
-        // NOTE: the execute bit on directories is needed to allow opening files inside of that directory
-        if ((base_lstat.st_mode & (S_IWUSR | S_IXUSR)) != (S_IWUSR | S_IXUSR))
+        void scan(DirNode& node)
         {
-            if (::chmod(base.c_str(), base_lstat.st_mode | S_IWUSR | S_IXUSR) != 0)
+            const int fd = open_dir(node.path);
+            if (fd < 0)
             {
-                ec.assign(errno, std::generic_category());
-                mark_recursive_error(base, ec, failure_point);
+                if (errno != ENOENT)
+                {
+                    fail(node.path, errno);
+                }
+
+                finish(&node);
                 return;
             }
-        }
 
-        // delete everything inside
-        ReadDirOp op{base, ec};
-        if (ec)
-        {
-            mark_recursive_error(base, ec, failure_point);
-            return;
-        }
+            struct stat s;
+            if (::fstat(fd, &s) == 0 && (s.st_mode & (S_IWUSR | S_IXUSR)) != (S_IWUSR | S_IXUSR))
+            {
+                ::fchmod(fd, s.st_mode | S_IWUSR | S_IXUSR);
+            }
 
-        for (;;)
-        {
-            errno = 0;
-            const auto entry = op.read();
-            if (!entry)
+            DIR* const dirp = ::fdopendir(fd);
+            if (!dirp)
+            {
+                fail(node.path, errno);
+                ::close(fd);
+                return;
+            }
+
+            std::vector<Path> subdirectories;
+            for (;;)
             {
-                if (errno != 0)
+                errno = 0;
+                const dirent* entry = ::readdir(dirp);
+                if (!entry)
                 {
-                    mark_recursive_error(base, ec, failure_point);
-                    return;
+                    if (errno != 0)
+                    {
+                        fail(node.path, errno);
+                    }
+
+                    break;
                 }
 
-                // no more entries left, fall down to rmdir below
-                break;
+                if (is_dot_or_dot_dot(entry->d_name))
+                {
+                    continue;
+                }
+
+                bool is_directory = get_d_type(entry) == PosixDType::Directory;
+                if (get_d_type(entry) == PosixDType::Unknown)
+                {
+                    struct stat entry_stat;
+                    is_directory = ::fstatat(fd, entry->d_name, &entry_stat, AT_SYMLINK_NOFOLLOW) == 0 &&
+                                   S_ISDIR(entry_stat.st_mode);
+                }
+
+                if (is_directory)
+                {
+                    subdirectories.push_back(node.path / entry->d_name);
+                }
+                else if (::unlinkat(fd, entry->d_name, 0) != 0 && errno != ENOENT)
+                {
+                    fail(node.path / entry->d_name, errno);
+                    break;
+                }
             }
 
-            // delete base / entry.d_name, recursively
-            if (is_dot_or_dot_dot(entry->d_name))
+            ::closedir(dirp);
+            if (!subdirectories.empty() && !m_failed.load(std::memory_order_relaxed))
             {
-                continue;
+                std::lock_guard<std::mutex> lock(m_mtx);
+                node.pending += subdirectories.size();
+                m_unscanned += subdirectories.size();
+                for (auto&& subdirectory : subdirectories)
+                {
+                    m_nodes.emplace_back(std::move(subdirectory), &node);
+                    m_stack.push_back(&m_nodes.back());
+                }
+
+                m_cv.notify_all();
             }
 
-            vcpkg_remove_all(base / entry->d_name, ec, failure_point, get_d_type(entry));
-            if (ec)
+            finish(&node);
+        }
+
+        // std::deque never moves its elements, so nodes can point at their parents
+        std::deque<DirNode> m_nodes;
+        std::mutex m_mtx;
+        std::condition_variable m_cv;
+        std::vector<DirNode*> m_stack;
+        size_t m_unscanned = 0;
+        std::atomic<bool> m_failed{false};
+        std::error_code m_ec;
+        Path m_failure_point;
+    };
+
+    void vcpkg_remove_all(const Path& base, std::error_code& ec, Path& failure_point)
+    {
+        // We have to check that `base` isn't a symbolic link
+        struct stat s;
+        if (::lstat(base.c_str(), &s) != 0)
+        {
+            if (errno != ENOENT && errno != ENOTDIR)
             {
-                // removing a contained entity failed; the recursive call will set failure_point
+                mark_recursive_error(base, ec, failure_point);
                 return;
             }
+
+            ec.clear();
+            return;
         }
 
-        if (::rmdir(base.c_str()) != 0)
+        if (S_ISDIR(s.st_mode))
+        {
+            ParallelRemoveAll(base).run(ec, failure_point);
+            return;
+        }
+
+        if (::unlink(base.c_str()) != 0)
         {
             mark_recursive_error(base, ec, failure_point);
+            return;
         }
+
+        ec.clear();
     }
 #endif // ^^^ !_WIN32
 }
@@ -1336,6 +1461,158 @@ namespace vcpkg
 #endif // ^^^ !_WIN32
     }
 
+    MappedFile::MappedFile(const Path& file_path, std::error_code& ec) noexcept
+    {
+#if defined(_WIN32)
+        FileHandle file{to_stdfs_path(file_path).c_str(),
+                        GENERIC_READ,
+                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                        OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL,
+                        ec};
+        if (ec) return;
+
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(file.h_file, &size))
+        {
+            ec.assign(static_cast<int>(GetLastError()), std::system_category());
+            return;
+        }
+
+        // empty files cannot be mapped
+        if (size.QuadPart == 0) return;
+
+        const auto mapping = ::CreateFileMappingW(file.h_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            ec.assign(static_cast<int>(GetLastError()), std::system_category());
+            return;
+        }
+
+        // the view keeps the mapping alive
+        m_mapping = static_cast<const char*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!m_mapping)
+        {
+            ec.assign(static_cast<int>(GetLastError()), std::system_category());
+        }
+
+        Checks::check_exit(VCPKG_LINE_INFO, ::CloseHandle(mapping));
+        if (m_mapping)
+        {
+            m_mapping_size = static_cast<size_t>(size.QuadPart);
+        }
+#else  // ^^^ _WIN32 / !_WIN32 vvv
+        const int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+        {
+            ec.assign(errno, std::generic_category());
+            return;
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0)
+        {
+            ec.assign(errno, std::generic_category());
+        }
+        else if (!S_ISREG(info.st_mode))
+        {
+            char buffer[1024 * 32];
+            for (;;)
+            {
+                const auto this_read = ::read(fd, buffer, sizeof(buffer));
+                if (this_read > 0)
+                {
+                    m_copy.insert(m_copy.end(), buffer, buffer + this_read);
+                }
+                else if (this_read == 0)
+                {
+                    break;
+                }
+                else if (errno != EINTR)
+                {
+                    ec.assign(errno, std::generic_category());
+                    m_copy.clear();
+                    break;
+                }
+            }
+        }
+        else if (info.st_size != 0) // empty files cannot be mapped
+        {
+            const auto size = static_cast<size_t>(info.st_size);
+            const auto mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED)
+            {
+                ec.assign(errno, std::generic_category());
+            }
+            else
+            {
+                m_mapping = static_cast<const char*>(mapping);
+                m_mapping_size = size;
+            }
+        }
+
+        ::close(fd);
+#endif // ^^^ !_WIN32
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_mapping(std::exchange(other.m_mapping, nullptr))
+        , m_mapping_size(std::exchange(other.m_mapping_size, 0))
+        , m_copy(std::move(other.m_copy))
+    {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            m_mapping = std::exchange(other.m_mapping, nullptr);
+            m_mapping_size = std::exchange(other.m_mapping_size, 0);
+            m_copy = std::move(other.m_copy);
+        }
+
+        return *this;
+    }
+
+    MappedFile::~MappedFile() { unmap(); }
+
+    void MappedFile::unmap() noexcept
+    {
+        if (!m_mapping) return;
+#if defined(_WIN32)
+        Checks::check_exit(VCPKG_LINE_INFO, ::UnmapViewOfFile(m_mapping));
+#else  // ^^^ _WIN32 / !_WIN32 vvv
+        Checks::check_exit(VCPKG_LINE_INFO, ::munmap(const_cast<char*>(m_mapping), m_mapping_size) == 0);
+#endif // ^^^ !_WIN32
+        m_mapping = nullptr;
+        m_mapping_size = 0;
+    }
+
+    StringView MappedFile::contents() const noexcept
+    {
+        auto result = bytes();
+        if (Strings::starts_with(result, "\xEF\xBB\xBF"))
+        {
+            // remove byte-order mark from the beginning of the string
+            result = result.substr(3);
+        }
+
+        return result;
+    }
+
+    MappedFile Filesystem::map_for_read(const Path& file_path, LineInfo li) const
+    {
+        std::error_code ec;
+        auto result = this->map_for_read(file_path, ec);
+        if (ec)
+        {
+            exit_filesystem_call_error(li, ec, __func__, {file_path});
+        }
+
+        return result;
+    }
+
     std::vector<std::string> Filesystem::read_lines(const Path& file_path, LineInfo li) const
     {
         std::error_code ec;
@@ -1688,6 +1965,52 @@ namespace vcpkg
         return result;
     }
 
+    uint64_t Filesystem::file_size(const Path& target, LineInfo li) const
+    {
+        std::error_code ec;
+        auto result = this->file_size(target, ec);
+        if (ec)
+        {
+            exit_filesystem_call_error(li, ec, __func__, {target});
+        }
+
+        return result;
+    }
+
+    int64_t Filesystem::last_write_time(const Path& target, LineInfo li) const
+    {
+        std::error_code ec;
+        auto result = this->last_write_time(target, ec);
+        if (ec)
+        {
+            exit_filesystem_call_error(li, ec, __func__, {target});
+        }
+
+        return result;
+    }
+
+    bool Filesystem::is_executable(const Path& target, LineInfo li) const
+    {
+        std::error_code ec;
+        auto result = this->is_executable(target, ec);
+        if (ec)
+        {
+            exit_filesystem_call_error(li, ec, __func__, {target});
+        }
+
+        return result;
+    }
+
+    void Filesystem::touch_shared(const Path& target, LineInfo li)
+    {
+        std::error_code ec;
+        this->touch_shared(target, ec);
+        if (ec)
+        {
+            exit_filesystem_call_error(li, ec, __func__, {target});
+        }
+    }
+
     void Filesystem::write_lines(const Path& file_path, const std::vector<std::string>& lines, LineInfo li)
     {
         std::error_code ec;
@@ -1718,6 +2041,26 @@ namespace vcpkg
         this->remove_all(base, ec, failure_point);
     }
 
+    void Filesystem::remove_all_in_background(const Path& base, LineInfo li)
+    {
+        std::error_code ec;
+        Path failure_point;
+
+        this->remove_all_in_background(base, ec, failure_point);
+
+        if (ec)
+        {
+            Checks::exit_with_message(
+                li, "Failure to remove_all(\"%s\") due to file \"%s\": %s", base, failure_point, ec.message());
+        }
+    }
+
+    void Filesystem::remove_all_in_background(const Path& base, std::error_code& ec)
+    {
+        Path failure_point;
+        this->remove_all_in_background(base, ec, failure_point);
+    }
+
     void Filesystem::remove_all_inside(const Path& base, std::error_code& ec, Path& failure_point)
     {
         for (auto&& subdir : this->get_directories_non_recursive(base, ec))
@@ -1811,10 +2154,34 @@ namespace vcpkg
         }
     }
 
-    std::unique_ptr<IExclusiveFileLock> Filesystem::take_exclusive_file_lock(const Path& lockfile, LineInfo li)
+    std::unique_ptr<IExclusiveFileLock> Filesystem::take_exclusive_file_lock(const Path& lockfile, LineInfo li)
+    {
+        std::error_code ec;
+        auto sh = this->take_exclusive_file_lock(lockfile, ec);
+        if (ec)
+        {
+            exit_filesystem_call_error(li, ec, __func__, {lockfile});
+        }
+
+        return sh;
+    }
+
+    std::unique_ptr<IExclusiveFileLock> Filesystem::take_shared_file_lock(const Path& lockfile, LineInfo li)
+    {
+        std::error_code ec;
+        auto sh = this->take_shared_file_lock(lockfile, ec);
+        if (ec)
+        {
+            exit_filesystem_call_error(li, ec, __func__, {lockfile});
+        }
+
+        return sh;
+    }
+
+    std::unique_ptr<IExclusiveFileLock> Filesystem::try_take_exclusive_file_lock(const Path& lockfile, LineInfo li)
     {
         std::error_code ec;
-        auto sh = this->take_exclusive_file_lock(lockfile, ec);
+        auto sh = this->try_take_exclusive_file_lock(lockfile, ec);
         if (ec)
         {
             exit_filesystem_call_error(li, ec, __func__, {lockfile});
@@ -1823,10 +2190,10 @@ namespace vcpkg
         return sh;
     }
 
-    std::unique_ptr<IExclusiveFileLock> Filesystem::try_take_exclusive_file_lock(const Path& lockfile, LineInfo li)
+    std::unique_ptr<IExclusiveFileLock> Filesystem::try_take_shared_file_lock(const Path& lockfile, LineInfo li)
     {
         std::error_code ec;
-        auto sh = this->try_take_exclusive_file_lock(lockfile, ec);
+        auto sh = this->try_take_shared_file_lock(lockfile, ec);
         if (ec)
         {
             exit_filesystem_call_error(li, ec, __func__, {lockfile});
@@ -1859,6 +2226,164 @@ namespace vcpkg
         return ret;
     }
 
+    // removes `dir` if it is empty
+    static void remove_empty_directory(const Path& dir)
+    {
+#if defined(_WIN32)
+        std::error_code ignored;
+        stdfs::remove(to_stdfs_path(dir), ignored);
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+        ::rmdir(dir.c_str());
+#endif // ^^^ !_WIN32
+    }
+
+    // Removes trees renamed into ".vcpkg-trash" directories, one at a time, on a single thread; each removal still
+    // uses whatever job tokens are free. The thread exits whenever the queue runs dry.
+    //
+    // Each process renames trees into its own directory in a trash directory, "<pid>-<n>", and holds an exclusive lock
+    // on "<pid>-<n>.lock" next to it until it removes both. A directory whose lock can be taken was abandoned by a
+    // process which exited early, and is removed by the next process to use that trash directory.
+    struct BackgroundRemover
+    {
+        struct Removal
+        {
+            Path tree;
+            // for a process's own directory, or an abandoned one: the lock on it, removed after the tree
+            Path lock_file;
+            std::unique_ptr<IExclusiveFileLock> lock;
+        };
+
+        BackgroundRemover() = default;
+        BackgroundRemover(const BackgroundRemover&) = delete;
+        BackgroundRemover& operator=(const BackgroundRemover&) = delete;
+        ~BackgroundRemover() { wait(); }
+
+        void enqueue(Removal&& removal)
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_queue.push_back(std::move(removal));
+            if (!m_running)
+            {
+                if (m_worker.joinable())
+                {
+                    m_worker.join();
+                }
+
+                m_running = true;
+                m_worker = std::thread([this]() { run(); });
+            }
+        }
+
+        // Sets `owned_dir` to this process's directory in `trash_root`. The first time, `claim` is called to create
+        // and lock it and to collect the directories other processes abandoned there; it runs under the remover's
+        // lock so that concurrent callers share one directory.
+        bool owned_dir(const Path& trash_root,
+                       Path& owned_dir,
+                       const std::function<bool(Removal& owned, std::vector<Removal>& abandoned)>& claim)
+        {
+            std::vector<Removal> abandoned;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                auto it = m_owned.find(trash_root.native());
+                if (it == m_owned.end())
+                {
+                    Removal owned;
+                    if (!claim(owned, abandoned))
+                    {
+                        return false;
+                    }
+
+                    it = m_owned.emplace(trash_root.native(), std::move(owned)).first;
+                }
+
+                owned_dir = it->second.tree;
+            }
+
+            for (auto&& removal : abandoned)
+            {
+                enqueue(std::move(removal));
+            }
+
+            return true;
+        }
+
+        // also removes this process's trash directories, and the trash directories themselves once they are empty
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            m_cv.wait(lock, [this]() { return !m_running; });
+            std::thread worker = std::move(m_worker);
+            std::map<std::string, Removal> owned = std::move(m_owned);
+            m_owned.clear();
+            lock.unlock();
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+
+            for (auto&& entry : owned)
+            {
+                remove(entry.second);
+            }
+        }
+
+    private:
+        static void remove(Removal& removal)
+        {
+            std::error_code ec;
+            Path failure_point;
+            vcpkg_remove_all(removal.tree, ec, failure_point);
+            if (ec)
+            {
+                Debug::print(
+                    "Failed to remove ", removal.tree, " due to file ", failure_point, ": ", ec.message(), '\n');
+                return;
+            }
+
+            if (removal.lock)
+            {
+                // Windows can't delete a file while it is open
+                removal.lock.reset();
+                vcpkg_remove_all(removal.lock_file, ec, failure_point);
+                remove_empty_directory(removal.tree.parent_path());
+            }
+        }
+
+        void run()
+        {
+            for (;;)
+            {
+                Removal removal;
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    if (m_queue.empty())
+                    {
+                        m_running = false;
+                        m_cv.notify_all();
+                        return;
+                    }
+
+                    removal = std::move(m_queue.front());
+                    m_queue.pop_front();
+                }
+
+                remove(removal);
+            }
+        }
+
+        std::mutex m_mtx;
+        std::condition_variable m_cv;
+        std::deque<Removal> m_queue;
+        // keyed by trash directory
+        std::map<std::string, Removal> m_owned;
+        std::thread m_worker;
+        bool m_running = false;
+    };
+
+    static BackgroundRemover g_background_remover;
+
+    void wait_for_background_removals() { g_background_remover.wait(); }
+
     struct RealFilesystem final : Filesystem
     {
         virtual std::string read_contents(const Path& file_path, std::error_code& ec) const override
@@ -1930,6 +2455,18 @@ namespace vcpkg
             return res;
         }
 
+        virtual MappedFile map_for_read(const Path& file_path, std::error_code& ec) const override
+        {
+            StatsTimer t(g_us_filesystem_stats);
+            MappedFile result{file_path, ec};
+            if (ec)
+            {
+                Debug::print("Failed to map: ", file_path, '\n');
+            }
+
+            return result;
+        }
+
         virtual Path find_file_recursively_up(const Path& starting_dir,
                                               const Path& filename,
                                               std::error_code& ec) const override
@@ -2522,6 +3059,105 @@ namespace vcpkg
             vcpkg_remove_all(base, ec, failure_point);
         }
 
+        // creates and locks this process's directory in `trash_root`, and takes the directories whose owners exited
+        bool claim_trash_dir(const Path& trash_root,
+                             BackgroundRemover::Removal& owned,
+                             std::vector<BackgroundRemover::Removal>& abandoned)
+        {
+            std::error_code ec;
+            this->create_directory(trash_root, ec);
+            if (ec)
+            {
+                return false;
+            }
+
+            // a crashed process with the same id may have left its directory behind, which is then reused
+            for (int n = 0; !owned.lock; ++n)
+            {
+                if (n == 100)
+                {
+                    return false;
+                }
+
+                const auto name = Strings::concat(get_process_id(), '-', n);
+                owned.lock_file = trash_root / (name + ".lock");
+                auto lock = std::make_unique<FileLock>(owned.lock_file, false, ec);
+                if (ec)
+                {
+                    return false;
+                }
+
+                if (lock->lock_attempt(ec))
+                {
+                    owned.tree = trash_root / name;
+                    owned.lock = std::move(lock);
+                }
+                else if (ec)
+                {
+                    return false;
+                }
+            }
+
+            this->create_directory(owned.tree, ec);
+            if (ec)
+            {
+                return false;
+            }
+
+            std::error_code ignored;
+            for (auto&& lock_file : this->get_regular_files_non_recursive(trash_root, ignored))
+            {
+                if (lock_file.extension() != ".lock" || lock_file == owned.lock_file)
+                {
+                    continue;
+                }
+
+                // the owner holds the lock for as long as it uses the directory
+                auto lock = std::make_unique<FileLock>(lock_file, false, ec);
+                if (!ec && lock->lock_attempt(ec))
+                {
+                    BackgroundRemover::Removal removal;
+                    removal.tree = trash_root / lock_file.stem();
+                    removal.lock_file = std::move(lock_file);
+                    removal.lock = std::move(lock);
+                    abandoned.push_back(std::move(removal));
+                }
+            }
+
+            return true;
+        }
+
+        virtual void remove_all_in_background(const Path& base, std::error_code& ec, Path& failure_point) override
+        {
+            static std::atomic<unsigned int> counter{0};
+            if (!vcpkg::exists(this->symlink_status(base, ec)))
+            {
+                // nothing to remove, and no reason to leave a trash directory behind
+                return;
+            }
+
+            const auto trash_root = Path(base.parent_path()) / ".vcpkg-trash";
+            Path trash_dir;
+            if (g_background_remover.owned_dir(
+                    trash_root, trash_dir, [&](BackgroundRemover::Removal& owned, auto& abandoned) {
+                        return claim_trash_dir(trash_root, owned, abandoned);
+                    }))
+            {
+                auto trash = trash_dir / Strings::concat(base.filename(), '-', counter++);
+                this->rename(base, trash, ec);
+                if (!ec)
+                {
+                    BackgroundRemover::Removal removal;
+                    removal.tree = std::move(trash);
+                    g_background_remover.enqueue(std::move(removal));
+                    return;
+                }
+            }
+
+            // for example, when `base` is a mount point
+            vcpkg_remove_all(base, ec, failure_point);
+        }
+
         virtual bool is_directory(const Path& target) const override
         {
 #if defined(_WIN32)
@@ -3034,6 +3670,129 @@ namespace vcpkg
 
             ec.assign(errno, std::generic_category());
             return FileType::unknown;
+#endif // ^^^ !_WIN32
+        }
+        virtual uint64_t file_size(const Path& target, std::error_code& ec) const override
+        {
+#if defined(_WIN32)
+            auto result = stdfs::file_size(to_stdfs_path(target), ec);
+            if (ec)
+            {
+                return 0;
+            }
+
+            return static_cast<uint64_t>(result);
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+            struct stat s;
+            if (::stat(target.c_str(), &s) != 0)
+            {
+                ec.assign(errno, std::generic_category());
+                return 0;
+            }
+
+            ec.clear();
+            return static_cast<uint64_t>(s.st_size);
+#endif // ^^^ !_WIN32
+        }
+        virtual int64_t last_write_time(const Path& target, std::error_code& ec) const override
+        {
+#if defined(_WIN32)
+            auto result = stdfs::last_write_time(to_stdfs_path(target), ec);
+            if (ec)
+            {
+                return 0;
+            }
+
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(result.time_since_epoch()).count();
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+            struct stat s;
+            if (::stat(target.c_str(), &s) != 0)
+            {
+                ec.assign(errno, std::generic_category());
+                return 0;
+            }
+
+            ec.clear();
+#if defined(__APPLE__)
+            const auto& mtime = s.st_mtimespec;
+#else  // ^^^ __APPLE__ // !__APPLE__ vvv
+            const auto& mtime = s.st_mtim;
+#endif // ^^^ !__APPLE__
+            return static_cast<int64_t>(mtime.tv_sec) * 1000000000 + static_cast<int64_t>(mtime.tv_nsec);
+#endif // ^^^ !_WIN32
+        }
+        virtual bool is_executable(const Path& target, std::error_code& ec) const override
+        {
+#if defined(_WIN32)
+            (void)target;
+            ec.clear();
+            return false;
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+            struct stat s;
+            if (::stat(target.c_str(), &s) != 0)
+            {
+                ec.assign(errno, std::generic_category());
+                return false;
+            }
+
+            ec.clear();
+            return (s.st_mode & S_IXUSR) != 0;
+#endif // ^^^ !_WIN32
+        }
+        virtual void touch_shared(const Path& target, std::error_code& ec) override
+        {
+#if defined(_WIN32)
+            // permissions are inherited from the directory
+            HANDLE handle = CreateFileW(to_stdfs_path(target).c_str(),
+                                        FILE_WRITE_ATTRIBUTES,
+                                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                        nullptr,
+                                        OPEN_ALWAYS,
+                                        FILE_ATTRIBUTE_NORMAL,
+                                        nullptr);
+            if (handle == INVALID_HANDLE_VALUE)
+            {
+                ec.assign(GetLastError(), std::system_category());
+                return;
+            }
+
+            FILETIME now;
+            GetSystemTimeAsFileTime(&now);
+            if (SetFileTime(handle, nullptr, nullptr, &now))
+            {
+                ec.clear();
+            }
+            else
+            {
+                ec.assign(GetLastError(), std::system_category());
+            }
+
+            CloseHandle(handle);
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+            PosixFd fd(target.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666, ec);
+            if (!ec)
+            {
+                // the umask applies to open but not to fchmod
+                fd.fchmod(0666, ec);
+            }
+            else if (ec == std::errc::file_exists)
+            {
+                fd = PosixFd(target.c_str(), O_WRONLY | O_CLOEXEC, ec);
+            }
+
+            if (ec)
+            {
+                return;
+            }
+
+            if (::futimens(fd.get(), nullptr) == 0)
+            {
+                ec.clear();
+            }
+            else
+            {
+                ec.assign(errno, std::generic_category());
+            }
 #endif // ^^^ !_WIN32
         }
         virtual void write_contents(const Path& file_path, const std::string& data, std::error_code& ec) override
@@ -3144,19 +3903,24 @@ namespace vcpkg
 #endif // ^^^ !_WIN32
         }
 
-        struct ExclusiveFileLock : IExclusiveFileLock
+        // shared locks may be held by any number of holders at once, but exclude any exclusive holder
+        struct FileLock : IExclusiveFileLock
         {
 #if defined(_WIN32)
             HANDLE handle = INVALID_HANDLE_VALUE;
             stdfs::path native;
-            ExclusiveFileLock(const Path& path, std::error_code& ec) : native(to_stdfs_path(path)) { ec.clear(); }
+            bool shared;
+            FileLock(const Path& path, bool shared, std::error_code& ec) : native(to_stdfs_path(path)), shared(shared)
+            {
+                ec.clear();
+            }
 
             bool lock_attempt(std::error_code& ec)
             {
                 Checks::check_exit(VCPKG_LINE_INFO, handle == INVALID_HANDLE_VALUE);
                 handle = CreateFileW(native.c_str(),
                                      GENERIC_READ,
-                                     0 /* no sharing */,
+                                     shared ? FILE_SHARE_READ : 0 /* no sharing */,
                                      nullptr /* no security attributes */,
                                      OPEN_ALWAYS,
                                      FILE_ATTRIBUTE_NORMAL,
@@ -3178,7 +3942,7 @@ namespace vcpkg
                 return false;
             }
 
-            ~ExclusiveFileLock() override
+            ~FileLock() override
             {
                 if (handle != INVALID_HANDLE_VALUE)
                 {
@@ -3188,15 +3952,18 @@ namespace vcpkg
             }
 #else // ^^^ _WIN32 / !_WIN32 vvv
             PosixFd fd;
+            bool shared;
             bool locked = false;
-            ExclusiveFileLock(const Path& path, std::error_code& ec)
-                : fd(path.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH, ec)
+            FileLock(const Path& path, bool shared, std::error_code& ec)
+                // flock doesn't need write access, so other users can lock files they can only read
+                : fd(path.c_str(), O_RDONLY | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH, ec)
+                , shared(shared)
             {
             }
 
             bool lock_attempt(std::error_code& ec)
             {
-                if (fd.flock(LOCK_EX | LOCK_NB) == 0)
+                if (fd.flock((shared ? LOCK_SH : LOCK_EX) | LOCK_NB) == 0)
                 {
                     ec.clear();
                     locked = true;
@@ -3213,7 +3980,7 @@ namespace vcpkg
                 return false;
             };
 
-            ~ExclusiveFileLock() override
+            ~FileLock() override
             {
                 if (locked)
                 {
@@ -3223,26 +3990,47 @@ namespace vcpkg
 #endif
         };
 
-        virtual std::unique_ptr<IExclusiveFileLock> take_exclusive_file_lock(const Path& lockfile,
-                                                                             std::error_code& ec) override
+        static std::unique_ptr<IExclusiveFileLock> take_file_lock(const Path& lockfile,
+                                                                  bool shared,
+                                                                  std::error_code& ec)
         {
-            auto result = std::make_unique<ExclusiveFileLock>(lockfile, ec);
+            auto result = std::make_unique<FileLock>(lockfile, shared, ec);
             if (!ec && !result->lock_attempt(ec) && !ec)
             {
                 vcpkg::printf("Waiting to take filesystem lock on %s...\n", lockfile);
-                do
+                // Most locks guard a single resource and are held briefly, so retry quickly at first. Neither flock()
+                // nor Windows sharing modes queue waiters; capping the backoff keeps a long waiter from losing out to
+                // newcomers which happen to retry sooner.
+                constexpr auto max_wait = std::chrono::milliseconds(500);
+                constexpr auto progress_interval = std::chrono::seconds(30);
+                const auto timer = ElapsedTimer::create_started();
+                auto next_progress = progress_interval;
+                for (auto wait = std::chrono::milliseconds(10);; wait = (std::min)(wait * 2, max_wait))
                 {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-                } while (!result->lock_attempt(ec) && !ec);
+                    std::this_thread::sleep_for(wait);
+                    if (result->lock_attempt(ec) || ec)
+                    {
+                        break;
+                    }
+
+                    const auto elapsed = timer.elapsed();
+                    if (elapsed.as<std::chrono::seconds>() >= next_progress)
+                    {
+                        vcpkg::printf(
+                            "Still waiting to take filesystem lock on %s (%s)...\n", lockfile, elapsed.to_string());
+                        next_progress += progress_interval;
+                    }
+                }
             }
 
             return std::move(result);
         }
 
-        virtual std::unique_ptr<IExclusiveFileLock> try_take_exclusive_file_lock(const Path& lockfile,
-                                                                                 std::error_code& ec) override
+        static std::unique_ptr<IExclusiveFileLock> try_take_file_lock(const Path& lockfile,
+                                                                      bool shared,
+                                                                      std::error_code& ec)
         {
-            auto result = std::make_unique<ExclusiveFileLock>(lockfile, ec);
+            auto result = std::make_unique<FileLock>(lockfile, shared, ec);
             if (!ec && !result->lock_attempt(ec) && !ec)
             {
                 Debug::print("Waiting to take filesystem lock on ", lockfile, "...\n");
@@ -3267,6 +4055,30 @@ namespace vcpkg
             return std::move(result);
         }
 
+        virtual std::unique_ptr<IExclusiveFileLock> take_exclusive_file_lock(const Path& lockfile,
+                                                                             std::error_code& ec) override
+        {
+            return take_file_lock(lockfile, false, ec);
+        }
+
+        virtual std::unique_ptr<IExclusiveFileLock> take_shared_file_lock(const Path& lockfile,
+                                                                          std::error_code& ec) override
+        {
+            return take_file_lock(lockfile, true, ec);
+        }
+
+        virtual std::unique_ptr<IExclusiveFileLock> try_take_exclusive_file_lock(const Path& lockfile,
+                                                                                 std::error_code& ec) override
+        {
+            return try_take_file_lock(lockfile, false, ec);
+        }
+
+        virtual std::unique_ptr<IExclusiveFileLock> try_take_shared_file_lock(const Path& lockfile,
+                                                                              std::error_code& ec) override
+        {
+            return try_take_file_lock(lockfile, true, ec);
+        }
+
         virtual std::vector<Path> find_from_PATH(const std::string& name) const override
         {
 #if defined(_WIN32)
@@ -1,7 +1,122 @@
 #include <vcpkg/base/graphs.h>
 
+#include <algorithm>
+
 namespace vcpkg::Graphs
 {
     REGISTER_MESSAGE(GraphCycleDetected);
     REGISTER_MESSAGE(GraphCycleDetectedElement);
+
+    DenseGraph::DenseGraph(size_t vertex_count, View<std::pair<uint32_t, uint32_t>> edges)
+        : m_edge_starts(vertex_count + 1, 0), m_edges(edges.size())
+    {
+        for (auto&& edge : edges)
+        {
+            Checks::check_exit(VCPKG_LINE_INFO, edge.first < vertex_count && edge.second < vertex_count);
+            ++m_edge_starts[edge.first + 1];
+        }
+
+        for (size_t vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            m_edge_starts[vertex + 1] += m_edge_starts[vertex];
+        }
+
+        std::vector<size_t> next(m_edge_starts.begin(), m_edge_starts.end() - 1);
+        for (auto&& edge : edges)
+        {
+            m_edges[next[edge.first]++] = edge.second;
+        }
+    }
+
+    TopologicalLevels topological_levels(const DenseGraph& graph)
+    {
+        const auto vertex_count = graph.vertex_count();
+        TopologicalLevels result;
+        result.order.reserve(vertex_count);
+        result.level_starts.push_back(0);
+
+        // the reverse edges, laid out the same way as DenseGraph's
+        std::vector<size_t> dependent_starts(vertex_count + 1, 0);
+        std::vector<uint32_t> remaining_dependencies(vertex_count);
+        for (uint32_t vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            const auto dependencies = graph.dependencies(vertex);
+            remaining_dependencies[vertex] = static_cast<uint32_t>(dependencies.size());
+            for (auto dependency : dependencies)
+            {
+                ++dependent_starts[dependency + 1];
+            }
+        }
+
+        for (size_t vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            dependent_starts[vertex + 1] += dependent_starts[vertex];
+        }
+
+        std::vector<uint32_t> dependents(dependent_starts.back());
+        {
+            std::vector<size_t> next(dependent_starts.begin(), dependent_starts.end() - 1);
+            for (uint32_t vertex = 0; vertex < vertex_count; ++vertex)
+            {
+                for (auto dependency : graph.dependencies(vertex))
+                {
+                    dependents[next[dependency]++] = vertex;
+                }
+            }
+        }
+
+        for (uint32_t vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            if (remaining_dependencies[vertex] == 0)
+            {
+                result.order.push_back(vertex);
+            }
+        }
+
+        while (result.order.size() > result.level_starts.back())
+        {
+            const auto level_begin = result.level_starts.back();
+            const auto level_end = result.order.size();
+            result.level_starts.push_back(level_end);
+            for (auto i = level_begin; i < level_end; ++i)
+            {
+                const auto vertex = result.order[i];
+                for (auto j = dependent_starts[vertex]; j < dependent_starts[vertex + 1]; ++j)
+                {
+                    if (--remaining_dependencies[dependents[j]] == 0)
+                    {
+                        result.order.push_back(dependents[j]);
+                    }
+                }
+            }
+
+            std::sort(result.order.begin() + level_end, result.order.end());
+        }
+
+        if (result.order.size() != vertex_count)
+        {
+            // Every vertex left over still has a dependency which is left over, so following those must eventually
+            // revisit a vertex; the walk from its first visit on is a cycle.
+            const auto is_left_over = [&](uint32_t v) { return remaining_dependencies[v] != 0; };
+            auto vertex = uint32_t{0};
+            while (!is_left_over(vertex))
+            {
+                ++vertex;
+            }
+
+            std::vector<size_t> position_on_walk(vertex_count, SIZE_MAX);
+            std::vector<uint32_t> walk;
+            while (position_on_walk[vertex] == SIZE_MAX)
+            {
+                position_on_walk[vertex] = walk.size();
+                walk.push_back(vertex);
+                const auto dependencies = graph.dependencies(vertex);
+                vertex = *std::find_if(dependencies.begin(), dependencies.end(), is_left_over);
+            }
+
+            result.cycle.assign(walk.begin() + position_on_walk[vertex], walk.end());
+        }
+
+        return result;
+    }
 }
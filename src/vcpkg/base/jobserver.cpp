@@ -0,0 +1,389 @@
+#include <vcpkg/base/system_headers.h>
+
+#include <vcpkg/base/jobserver.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/system.debug.h>
+#include <vcpkg/base/system.h>
+#include <vcpkg/base/system.process.h>
+
+#include <algorithm>
+#include <mutex>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <errno.h>
+#endif // ^^^ !_WIN32
+
+namespace
+{
+    using namespace vcpkg;
+
+    struct Jobserver
+    {
+        bool active = false;
+        // what port builds get as MAKEFLAGS
+        std::string makeflags;
+#if defined(_WIN32)
+        HANDLE semaphore = nullptr;
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+        // A non-blocking descriptor that only vcpkg reads tokens from. It must be a separate open file description
+        // from the one children inherit: setting O_NONBLOCK on theirs would break make's blocking reads.
+        int private_read_fd = -1;
+        int write_fd = -1;
+        // the descriptors MAKEFLAGS names, which only port builds inherit; -1 for a FIFO named in MAKEFLAGS
+        int child_read_fd = -1;
+        int child_write_fd = -1;
+        // make expects the same bytes to be written back as were read
+        std::mutex tokens_mtx;
+        std::string tokens;
+#endif // ^^^ !_WIN32
+    };
+
+    Jobserver g_jobserver;
+
+    Optional<int> parse_fd(StringView sv)
+    {
+        auto maybe_fd = Strings::strto<int>(sv);
+        if (auto fd = maybe_fd.get())
+        {
+            if (*fd >= 0)
+            {
+                return *fd;
+            }
+        }
+
+        return nullopt;
+    }
+
+#if defined(_WIN32)
+    bool join_jobserver(const JobserverAuth& auth)
+    {
+        if (auth.name.empty())
+        {
+            return false;
+        }
+
+        g_jobserver.semaphore =
+            OpenSemaphoreW(SEMAPHORE_MODIFY_STATE | SYNCHRONIZE, FALSE, Strings::to_utf16(auth.name).c_str());
+        return g_jobserver.semaphore != nullptr;
+    }
+
+    Optional<std::string> create_jobserver(int tokens)
+    {
+        auto name = Strings::concat("vcpkg_jobserver_", get_process_id());
+        g_jobserver.semaphore = CreateSemaphoreW(nullptr, tokens, tokens, Strings::to_utf16(name).c_str());
+        if (g_jobserver.semaphore == nullptr)
+        {
+            Debug::print("Failed to create the jobserver semaphore: ", GetLastError(), '\n');
+            return nullopt;
+        }
+
+        return name;
+    }
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+    bool join_jobserver(const JobserverAuth& auth)
+    {
+        if (!auth.name.empty())
+        {
+            g_jobserver.private_read_fd = ::open(auth.name.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            if (g_jobserver.private_read_fd < 0)
+            {
+                return false;
+            }
+
+            g_jobserver.write_fd = ::open(auth.name.c_str(), O_WRONLY | O_CLOEXEC);
+            return g_jobserver.write_fd >= 0;
+        }
+
+        // make closes the jobserver descriptors for commands it does not consider recursive makes, after which the
+        // numbers may have been reused for unrelated files
+        struct stat read_stat;
+        if (::fstat(auth.read_fd, &read_stat) != 0 || !S_ISFIFO(read_stat.st_mode) ||
+            ::fcntl(auth.write_fd, F_GETFD) == -1)
+        {
+            return false;
+        }
+
+        // reopening through procfs creates a new open file description, which can be made non-blocking privately
+        const auto proc_path = Strings::concat("/proc/self/fd/", auth.read_fd);
+        g_jobserver.private_read_fd = ::open(proc_path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (g_jobserver.private_read_fd < 0)
+        {
+            return false;
+        }
+
+        // tools vcpkg runs must not hold make's jobserver open, nor take tokens without giving them back
+        ::fcntl(auth.read_fd, F_SETFD, FD_CLOEXEC);
+        ::fcntl(auth.write_fd, F_SETFD, FD_CLOEXEC);
+        g_jobserver.write_fd = auth.write_fd;
+        g_jobserver.child_read_fd = auth.read_fd;
+        g_jobserver.child_write_fd = auth.write_fd;
+        return true;
+    }
+
+    Optional<std::string> create_jobserver(int tokens)
+    {
+        // A FIFO rather than a pipe lets vcpkg open its own non-blocking read descriptor. It is unlinked as soon as
+        // it is open, and children only see the inherited descriptors, like a pipe-based make jobserver.
+        auto tmp = get_environment_variable("TMPDIR").value_or("/tmp");
+        const auto fifo_path = Strings::concat(tmp, "/vcpkg-jobserver-", get_process_id());
+        ::unlink(fifo_path.c_str());
+        if (::mkfifo(fifo_path.c_str(), 0600) != 0)
+        {
+            Debug::print("Failed to create the jobserver FIFO ", fifo_path, ": ", strerror(errno), '\n');
+            return nullopt;
+        }
+
+        // opening the non-blocking reader first keeps the other opens from blocking
+        const int private_read_fd = ::open(fifo_path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        const int child_write_fd = private_read_fd < 0 ? -1 : ::open(fifo_path.c_str(), O_WRONLY | O_CLOEXEC);
+        const int child_read_fd = child_write_fd < 0 ? -1 : ::open(fifo_path.c_str(), O_RDONLY | O_CLOEXEC);
+        ::unlink(fifo_path.c_str());
+        if (child_read_fd < 0)
+        {
+            Debug::print("Failed to open the jobserver FIFO ", fifo_path, ": ", strerror(errno), '\n');
+            if (child_write_fd >= 0) ::close(child_write_fd);
+            if (private_read_fd >= 0) ::close(private_read_fd);
+            return nullopt;
+        }
+
+        const std::string initial_tokens(static_cast<size_t>(tokens), '+');
+        if (::write(child_write_fd, initial_tokens.data(), initial_tokens.size()) !=
+            static_cast<ssize_t>(initial_tokens.size()))
+        {
+            Debug::print("Failed to fill the jobserver FIFO: ", strerror(errno), '\n');
+            ::close(child_read_fd);
+            ::close(child_write_fd);
+            ::close(private_read_fd);
+            return nullopt;
+        }
+
+        g_jobserver.private_read_fd = private_read_fd;
+        g_jobserver.write_fd = child_write_fd;
+        g_jobserver.child_read_fd = child_read_fd;
+        g_jobserver.child_write_fd = child_write_fd;
+        return Strings::concat(child_read_fd, ',', child_write_fd);
+    }
+#endif // ^^^ !_WIN32
+}
+
+namespace vcpkg
+{
+    Optional<JobserverAuth> parse_jobserver_auth(StringView makeflags)
+    {
+        static constexpr StringLiteral auth_option = "--jobserver-auth=";
+        static constexpr StringLiteral fds_option = "--jobserver-fds=";
+
+        const auto is_space = [](char ch) { return ch == ' ' || ch == '\t'; };
+        Optional<JobserverAuth> result;
+        auto first = makeflags.begin();
+        const auto last = makeflags.end();
+        for (;;)
+        {
+            first = std::find_if_not(first, last, is_space);
+            if (first == last)
+            {
+                return result;
+            }
+
+            const auto word_last = std::find_if(first, last, is_space);
+            const StringView word{first, word_last};
+            first = word_last;
+
+            StringView value;
+            if (Strings::starts_with(word, auth_option))
+            {
+                value = word.substr(auth_option.size());
+            }
+            else if (Strings::starts_with(word, fds_option))
+            {
+                value = word.substr(fds_option.size());
+            }
+            else
+            {
+                continue;
+            }
+
+            JobserverAuth auth;
+            if (Strings::starts_with(value, "fifo:"))
+            {
+                auth.name = value.substr(5).to_string();
+                result = std::move(auth);
+                continue;
+            }
+
+            const auto comma = std::find(value.begin(), value.end(), ',');
+            if (comma == value.end())
+            {
+                // on Windows, the name of a semaphore
+                auth.name = value.to_string();
+                result = std::move(auth);
+                continue;
+            }
+
+            auto maybe_read_fd = parse_fd({value.begin(), comma});
+            auto maybe_write_fd = parse_fd({comma + 1, value.end()});
+            auto read_fd = maybe_read_fd.get();
+            auto write_fd = maybe_write_fd.get();
+            if (read_fd && write_fd)
+            {
+                auth.read_fd = *read_fd;
+                auth.write_fd = *write_fd;
+                result = std::move(auth);
+            }
+            else
+            {
+                // make passes negative descriptors to commands it does not consider recursive makes
+                result.clear();
+            }
+        }
+    }
+
+    void initialize_jobserver()
+    {
+        auto maybe_makeflags = get_environment_variable("MAKEFLAGS");
+        if (auto makeflags = maybe_makeflags.get())
+        {
+            auto maybe_auth = parse_jobserver_auth(*makeflags);
+            if (auto auth = maybe_auth.get())
+            {
+                // Only port builds take part in the jobserver (see get_jobserver_makeflags). If it can't be joined,
+                // its descriptors may belong to unrelated files by now, so it must not be passed on at all.
+                set_environment_variable("MAKEFLAGS", nullopt);
+                if (join_jobserver(*auth))
+                {
+                    Debug::print("Joined the jobserver from MAKEFLAGS: ", *makeflags, '\n');
+                    g_jobserver.active = true;
+                    g_jobserver.makeflags = std::move(*makeflags);
+                    return;
+                }
+
+                Debug::print("Failed to join the jobserver from MAKEFLAGS: ", *makeflags, '\n');
+                maybe_makeflags.clear();
+            }
+        }
+
+        const int concurrency = get_concurrency();
+        if (concurrency <= 1)
+        {
+            return;
+        }
+
+        // the calling thread of vcpkg holds the implicit first job, as make's top-level process does
+        auto maybe_auth = create_jobserver(concurrency - 1);
+        if (auto auth = maybe_auth.get())
+        {
+            g_jobserver.active = true;
+            g_jobserver.makeflags = maybe_makeflags.value_or("");
+            Strings::append(g_jobserver.makeflags,
+                            g_jobserver.makeflags.empty() ? "" : " ",
+                            "-j",
+                            concurrency,
+                            " --jobserver-auth=",
+                            *auth);
+            Debug::print("Created a jobserver with ", concurrency, " jobs: MAKEFLAGS=", g_jobserver.makeflags, '\n');
+        }
+    }
+
+    Optional<std::string> get_jobserver_makeflags()
+    {
+        if (!g_jobserver.active)
+        {
+            return nullopt;
+        }
+
+        return g_jobserver.makeflags;
+    }
+
+    void add_jobserver_to_environment(Environment& env)
+    {
+        if (!g_jobserver.active)
+        {
+            return;
+        }
+
+        add_environment_variable(env, "MAKEFLAGS", g_jobserver.makeflags);
+#if !defined(_WIN32)
+        if (g_jobserver.child_read_fd >= 0)
+        {
+            env.m_inherited_fds.push_back(g_jobserver.child_read_fd);
+            env.m_inherited_fds.push_back(g_jobserver.child_write_fd);
+        }
+#endif // ^^^ !_WIN32
+    }
+
+    size_t try_acquire_job_tokens(size_t count)
+    {
+        if (!g_jobserver.active)
+        {
+            return count;
+        }
+
+        size_t acquired = 0;
+#if defined(_WIN32)
+        while (acquired < count && WaitForSingleObject(g_jobserver.semaphore, 0) == WAIT_OBJECT_0)
+        {
+            ++acquired;
+        }
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+        std::string buffer(count, '\0');
+        while (acquired < count)
+        {
+            const auto bytes_read = ::read(g_jobserver.private_read_fd, &buffer[acquired], count - acquired);
+            if (bytes_read > 0)
+            {
+                acquired += static_cast<size_t>(bytes_read);
+            }
+            else if (bytes_read == 0 || errno != EINTR)
+            {
+                break;
+            }
+        }
+
+        if (acquired != 0)
+        {
+            std::lock_guard<std::mutex> lock(g_jobserver.tokens_mtx);
+            g_jobserver.tokens.append(buffer.data(), acquired);
+        }
+#endif // ^^^ !_WIN32
+        return acquired;
+    }
+
+    void release_job_tokens(size_t count)
+    {
+        if (!g_jobserver.active || count == 0)
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        ReleaseSemaphore(g_jobserver.semaphore, static_cast<LONG>(count), nullptr);
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+        std::string buffer;
+        {
+            std::lock_guard<std::mutex> lock(g_jobserver.tokens_mtx);
+            const auto available = std::min(count, g_jobserver.tokens.size());
+            buffer.assign(g_jobserver.tokens.end() - available, g_jobserver.tokens.end());
+            g_jobserver.tokens.resize(g_jobserver.tokens.size() - available);
+        }
+
+        buffer.resize(count, '+');
+        size_t written = 0;
+        while (written < buffer.size())
+        {
+            const auto this_write = ::write(g_jobserver.write_fd, buffer.data() + written, buffer.size() - written);
+            if (this_write > 0)
+            {
+                written += static_cast<size_t>(this_write);
+            }
+            else if (errno != EINTR)
+            {
+                Debug::print("Failed to return jobserver tokens: ", strerror(errno), '\n');
+                break;
+            }
+        }
+#endif // ^^^ !_WIN32
+    }
+}
@@ -563,6 +563,34 @@ namespace vcpkg::Strings
         return result;
     }
 
+    LineIterator& LineIterator::operator++() noexcept
+    {
+        if (!m_has_rest)
+        {
+            m_done = true;
+            m_line = StringView{};
+            return *this;
+        }
+
+        m_done = false;
+        const auto newline = std::find_if(m_rest, m_last, [](char c) { return c == '\n' || c == '\r'; });
+        m_line = StringView{m_rest, newline};
+        if (newline == m_last)
+        {
+            m_has_rest = false;
+        }
+        else
+        {
+            m_rest = newline + 1;
+            if (*newline == '\r' && m_rest != m_last && *m_rest == '\n')
+            {
+                ++m_rest;
+            }
+        }
+
+        return *this;
+    }
+
     struct LinesCollector::CB
     {
         LinesCollector* parent;
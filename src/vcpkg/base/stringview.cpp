@@ -36,7 +36,10 @@ namespace vcpkg
 
     bool operator<(StringView lhs, StringView rhs) noexcept
     {
-        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        // bytes compare as unsigned, as std::string's do, so that sorting strings and searching them with views agree
+        const auto common_size = std::min(lhs.size(), rhs.size());
+        const int cmp = common_size == 0 ? 0 : memcmp(lhs.data(), rhs.data(), common_size);
+        return cmp < 0 || (cmp == 0 && lhs.size() < rhs.size());
     }
 
     bool operator>(StringView lhs, StringView rhs) noexcept { return rhs < lhs; }
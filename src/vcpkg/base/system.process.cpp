@@ -2,6 +2,7 @@
 
 #include <vcpkg/base/checks.h>
 #include <vcpkg/base/chrono.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/strings.h>
 #include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.h>
@@ -18,7 +19,15 @@
 
 #if defined(__FreeBSD__)
 #include <sys/sysctl.h>
+#endif
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
 #include <sys/wait.h>
+
+extern char** environ;
 #endif
 
 #if defined(_WIN32)
@@ -430,6 +439,28 @@ namespace vcpkg
         return clean_env;
     }
 
+    void add_environment_variable(Environment& env, StringView name, StringView value)
+    {
+#if defined(_WIN32)
+        // an empty block means "inherit vcpkg's environment", which can't be extended
+        if (env.m_env_data.empty())
+        {
+            env = get_clean_environment();
+        }
+
+        env.m_env_data.append(Strings::to_utf16(Strings::concat(name, '=', value)));
+        env.m_env_data.push_back(L'\0');
+#else
+        if (!env.m_env_data.empty())
+        {
+            env.m_env_data.push_back(' ');
+        }
+
+        Strings::append(env.m_env_data, name, '=');
+        append_shell_escaped(env.m_env_data, value);
+#endif
+    }
+
     const WorkingDirectory default_working_directory;
     const Environment default_environment;
 
@@ -437,41 +468,11 @@ namespace vcpkg
                                                                            const WorkingDirectory& wd,
                                                                            const Environment& env)
     {
-        if (cmd_lines.size() == 0)
-        {
-            return {};
-        }
-        if (cmd_lines.size() == 1)
-        {
-            return {cmd_execute_and_capture_output(cmd_lines[0], wd, env)};
-        }
         std::vector<ExitCodeAndOutput> res(cmd_lines.size());
-        std::atomic<size_t> work_item{0};
-
-        const auto num_threads =
-            static_cast<size_t>(std::max(1, std::min(get_concurrency(), static_cast<int>(cmd_lines.size()))));
+        parallel_transform(cmd_lines.begin(), cmd_lines.size(), res.begin(), [&wd, &env](const Command& cmd_line) {
+            return cmd_execute_and_capture_output(cmd_line, wd, env);
+        });
 
-        auto work = [&cmd_lines, &res, &work_item, &wd, &env]() {
-            for (size_t item = work_item.fetch_add(1); item < cmd_lines.size(); item = work_item.fetch_add(1))
-            {
-                res[item] = cmd_execute_and_capture_output(cmd_lines[item], wd, env);
-            }
-        };
-
-        std::vector<std::future<void>> workers;
-        for (size_t x = 0; x < num_threads - 1; ++x)
-        {
-            workers.emplace_back(std::async(std::launch::async | std::launch::deferred, work));
-            if (work_item >= cmd_lines.size())
-            {
-                break;
-            }
-        }
-        work();
-        for (auto&& w : workers)
-        {
-            w.get();
-        }
         return res;
     }
 
@@ -595,7 +596,10 @@ namespace vcpkg
         template<class Function>
         int wait_and_stream_output(Function&& f, Encoding encoding)
         {
-            CloseHandle(child_stdin);
+            if (child_stdin)
+            {
+                CloseHandle(child_stdin);
+            }
 
             DWORD bytes_read = 0;
             static constexpr DWORD buffer_size = 1024 * 32;
@@ -630,10 +634,14 @@ namespace vcpkg
         }
     };
 
-    static ExpectedT<ProcessInfoAndPipes, unsigned long> windows_create_process_redirect(StringView cmd_line,
-                                                                                         const WorkingDirectory& wd,
-                                                                                         const Environment& env,
-                                                                                         DWORD dwCreationFlags) noexcept
+    /// <param name="input_file">If non-null, the file the new process reads as its standard input. If null, its
+    /// standard input is an empty pipe.</param>
+    static ExpectedT<ProcessInfoAndPipes, unsigned long> windows_create_process_redirect(
+        StringView cmd_line,
+        const WorkingDirectory& wd,
+        const Environment& env,
+        DWORD dwCreationFlags,
+        const Path* input_file) noexcept
     {
         ProcessInfoAndPipes ret;
 
@@ -652,10 +660,31 @@ namespace vcpkg
         if (!CreatePipe(&ret.child_stdout, &startup_info.hStdOutput, &saAttr, 0)) Checks::exit_fail(VCPKG_LINE_INFO);
         // Ensure the read handle to the pipe for STDOUT is not inherited.
         if (!SetHandleInformation(ret.child_stdout, HANDLE_FLAG_INHERIT, 0)) Checks::exit_fail(VCPKG_LINE_INFO);
-        // Create a pipe for the child process's STDIN.
-        if (!CreatePipe(&startup_info.hStdInput, &ret.child_stdin, &saAttr, 0)) Checks::exit_fail(VCPKG_LINE_INFO);
-        // Ensure the write handle to the pipe for STDIN is not inherited.
-        if (!SetHandleInformation(ret.child_stdin, HANDLE_FLAG_INHERIT, 0)) Checks::exit_fail(VCPKG_LINE_INFO);
+        if (input_file)
+        {
+            startup_info.hStdInput = CreateFileW(Strings::to_utf16(input_file->native()).c_str(),
+                                                 GENERIC_READ,
+                                                 FILE_SHARE_READ,
+                                                 &saAttr,
+                                                 OPEN_EXISTING,
+                                                 FILE_ATTRIBUTE_NORMAL,
+                                                 nullptr);
+            if (startup_info.hStdInput == INVALID_HANDLE_VALUE)
+            {
+                const auto error = GetLastError();
+                CloseHandle(ret.child_stdout);
+                CloseHandle(startup_info.hStdOutput);
+                return error;
+            }
+        }
+        else
+        {
+            // Create a pipe for the child process's STDIN.
+            if (!CreatePipe(&startup_info.hStdInput, &ret.child_stdin, &saAttr, 0)) Checks::exit_fail(VCPKG_LINE_INFO);
+            // Ensure the write handle to the pipe for STDIN is not inherited.
+            if (!SetHandleInformation(ret.child_stdin, HANDLE_FLAG_INHERIT, 0)) Checks::exit_fail(VCPKG_LINE_INFO);
+        }
+
         startup_info.hStdError = startup_info.hStdOutput;
 
         auto maybe_proc_info = windows_create_process(cmd_line, wd, env, dwCreationFlags, startup_info);
@@ -785,6 +814,16 @@ namespace vcpkg
         return exit_code;
     }
 
+    std::string format_resource_usage(const ProcessResourceUsage& usage)
+    {
+        return Strings::format("user %.1f s, system %.1f s, peak RSS %.1f MiB, %llu blocks read, %llu blocks written",
+                               usage.user_cpu_us / 1000000.0,
+                               usage.system_cpu_us / 1000000.0,
+                               usage.peak_rss_bytes / (1024.0 * 1024.0),
+                               static_cast<unsigned long long>(usage.blocks_read),
+                               static_cast<unsigned long long>(usage.blocks_written));
+    }
+
     int cmd_execute_and_stream_lines(const Command& cmd_line,
                                      std::function<void(StringView)> per_line_cb,
                                      const WorkingDirectory& wd,
@@ -800,19 +839,23 @@ namespace vcpkg
         return rc;
     }
 
-    int cmd_execute_and_stream_data(const Command& cmd_line,
-                                    std::function<void(StringView)> data_cb,
-                                    const WorkingDirectory& wd,
-                                    const Environment& env,
-                                    Encoding encoding)
+    // cmd_execute_and_stream_data, with standard input read from `input_file` if it is not null
+    static int cmd_execute_and_stream_data_impl(const Command& cmd_line,
+                                                std::function<void(StringView)> data_cb,
+                                                const WorkingDirectory& wd,
+                                                const Environment& env,
+                                                Encoding encoding,
+                                                Optional<ProcessResourceUsage>* resource_usage,
+                                                const Path* input_file)
     {
         const auto timer = ElapsedTimer::create_started();
 #if defined(_WIN32)
+        (void)resource_usage;
         const auto proc_id = std::to_string(::GetCurrentProcessId());
         using vcpkg::g_ctrl_c_state;
 
         g_ctrl_c_state.transition_to_spawn_process();
-        auto maybe_proc_info = windows_create_process_redirect(cmd_line.command_line(), wd, env, 0);
+        auto maybe_proc_info = windows_create_process_redirect(cmd_line.command_line(), wd, env, 0, input_file);
         auto exit_code = [&]() -> unsigned long {
             if (auto p = maybe_proc_info.get())
                 return p->wait_and_stream_output(data_cb, encoding);
@@ -823,44 +866,136 @@ namespace vcpkg
 #else  // ^^^ _WIN32 // !_WIN32 vvv
         Checks::check_exit(VCPKG_LINE_INFO, encoding == Encoding::Utf8);
         const auto proc_id = std::to_string(::getpid());
-        (void)env;
-        std::string actual_cmd_line;
-        if (wd.working_directory.empty())
+        Command actual_cmd_line_builder;
+        if (!wd.working_directory.empty())
         {
-            actual_cmd_line = Strings::format(R"(%s 2>&1)", cmd_line.command_line());
+            actual_cmd_line_builder.string_arg("cd");
+            actual_cmd_line_builder.string_arg(wd.working_directory);
+            actual_cmd_line_builder.raw_arg("&&");
         }
-        else
+
+        if (!env.m_env_data.empty())
         {
-            actual_cmd_line = Command("cd")
-                                  .string_arg(wd.working_directory)
-                                  .raw_arg("&&")
-                                  .raw_arg(cmd_line.command_line())
-                                  .raw_arg("2>&1")
-                                  .extract();
+            actual_cmd_line_builder.raw_arg(env.m_env_data);
         }
 
-        Debug::print(proc_id, ": popen(", actual_cmd_line, ")\n");
+        std::string actual_cmd_line =
+            std::move(actual_cmd_line_builder.raw_arg(cmd_line.command_line()).raw_arg("2>&1")).extract();
+
+        Debug::print(proc_id, ": posix_spawn(/bin/sh -c ", actual_cmd_line, ")\n");
         // Flush stdout before launching external process
         fflush(stdout);
 
-        const auto pipe = popen(actual_cmd_line.c_str(), "r");
-        if (pipe == nullptr)
+        // This is popen(), except that the child is collected with wait4() so that its resource usage is available.
+        // The pipe must be close-on-exec from the start, or a process which another thread spawns in the meantime
+        // inherits the write end and holds this pipe open until it exits. macOS lacks pipe2, so there a spawn can
+        // still slip between pipe and fcntl.
+        int pipe_fds[2];
+#if defined(__APPLE__)
+        if (::pipe(pipe_fds) != 0)
         {
             return 1;
         }
-        char buf[1024];
-        // Use fgets because fread will block until the entire buffer is filled.
-        while (fgets(buf, 1024, pipe))
+
+        ::fcntl(pipe_fds[0], F_SETFD, FD_CLOEXEC);
+        ::fcntl(pipe_fds[1], F_SETFD, FD_CLOEXEC);
+#else
+        if (::pipe2(pipe_fds, O_CLOEXEC) != 0)
+        {
+            return 1;
+        }
+#endif
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], STDOUT_FILENO);
+        if (input_file)
         {
-            data_cb(StringView{buf, strlen(buf)});
+            posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, input_file->c_str(), O_RDONLY, 0);
         }
 
-        if (!feof(pipe))
+        for (const int fd : env.m_inherited_fds)
         {
+#if defined(__APPLE__)
+            posix_spawn_file_actions_addinherit_np(&actions, fd);
+#else
+            // duplicating a descriptor onto itself clears its close-on-exec flag (POSIX.1-2024; glibc 2.29, musl)
+            posix_spawn_file_actions_adddup2(&actions, fd, fd);
+#endif
+        }
+        char sh[] = "sh";
+        char dash_c[] = "-c";
+        char* const argv[] = {sh, dash_c, &actual_cmd_line[0], nullptr};
+        pid_t pid;
+        const int spawn_error = posix_spawn(&pid, "/bin/sh", &actions, nullptr, argv, environ);
+        posix_spawn_file_actions_destroy(&actions);
+        ::close(pipe_fds[1]);
+        if (spawn_error != 0)
+        {
+            ::close(pipe_fds[0]);
             return 1;
         }
 
-        auto exit_code = pclose(pipe);
+        const auto wait_for_child = [pid](struct rusage& usage) {
+            int status;
+            while (::wait4(pid, &status, 0, &usage) == -1)
+            {
+                if (errno != EINTR)
+                {
+                    return -1;
+                }
+            }
+
+            return status;
+        };
+
+        // Read the pipe directly rather than through stdio: fread would block until the entire buffer is filled,
+        // and fgets would hand out one line per callback. read() returns whatever output is available, so callers
+        // that split lines see many lines per chunk and only copy the line that straddles a chunk boundary.
+        struct rusage usage = {};
+        static constexpr size_t buffer_size = 1024 * 32;
+        char buf[buffer_size];
+        for (;;)
+        {
+            const auto bytes_read = ::read(pipe_fds[0], buf, buffer_size);
+            if (bytes_read > 0)
+            {
+                std::replace(buf, buf + bytes_read, '\0', '?');
+                data_cb(StringView{buf, static_cast<size_t>(bytes_read)});
+            }
+            else if (bytes_read == 0)
+            {
+                break;
+            }
+            else if (errno != EINTR)
+            {
+                ::close(pipe_fds[0]);
+                wait_for_child(usage);
+                return 1;
+            }
+        }
+
+        ::close(pipe_fds[0]);
+        auto exit_code = wait_for_child(usage);
+        if (exit_code == -1)
+        {
+            return 1;
+        }
+
+        if (resource_usage)
+        {
+            ProcessResourceUsage result;
+            result.user_cpu_us = static_cast<uint64_t>(usage.ru_utime.tv_sec) * 1000000 + usage.ru_utime.tv_usec;
+            result.system_cpu_us = static_cast<uint64_t>(usage.ru_stime.tv_sec) * 1000000 + usage.ru_stime.tv_usec;
+#if defined(__APPLE__)
+            result.peak_rss_bytes = static_cast<uint64_t>(usage.ru_maxrss);
+#else
+            result.peak_rss_bytes = static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+            result.blocks_read = static_cast<uint64_t>(usage.ru_inblock);
+            result.blocks_written = static_cast<uint64_t>(usage.ru_oublock);
+            *resource_usage = result;
+        }
+
         if (WIFEXITED(exit_code))
         {
             exit_code = WEXITSTATUS(exit_code);
@@ -887,6 +1022,34 @@ namespace vcpkg
         return exit_code;
     }
 
+    int cmd_execute_and_stream_data(const Command& cmd_line,
+                                    std::function<void(StringView)> data_cb,
+                                    const WorkingDirectory& wd,
+                                    const Environment& env,
+                                    Encoding encoding,
+                                    Optional<ProcessResourceUsage>* resource_usage)
+    {
+        return cmd_execute_and_stream_data_impl(
+            cmd_line, std::move(data_cb), wd, env, encoding, resource_usage, nullptr);
+    }
+
+    ExitCodeAndOutput cmd_execute_and_capture_output_with_input_file(const Command& cmd_line,
+                                                                     const Path& input_file,
+                                                                     const WorkingDirectory& wd,
+                                                                     const Environment& env)
+    {
+        std::string output;
+        auto rc = cmd_execute_and_stream_data_impl(
+            cmd_line,
+            [&](StringView sv) { Strings::append(output, sv); },
+            wd,
+            env,
+            Encoding::Utf8,
+            nullptr,
+            &input_file);
+        return {rc, std::move(output)};
+    }
+
     ExitCodeAndOutput cmd_execute_and_capture_output(const Command& cmd_line,
                                                      const WorkingDirectory& wd,
                                                      const Environment& env,
@@ -177,7 +177,7 @@ namespace
 
     static void clean_prepare_dir(Filesystem& fs, const Path& dir)
     {
-        fs.remove_all(dir, VCPKG_LINE_INFO);
+        fs.remove_all_in_background(dir, VCPKG_LINE_INFO);
         bool created_last = fs.create_directories(dir, VCPKG_LINE_INFO);
         Checks::check_exit(VCPKG_LINE_INFO, created_last, "unable to clear path: %s", dir);
     }
@@ -1460,13 +1460,36 @@ namespace vcpkg
         std::vector<CacheAvailability> results{actions.size()};
         for (size_t idx = 0; idx < results.size(); ++idx)
         {
-            results[idx] = cache_status[idx]->get_available_provider() ? CacheAvailability::available
-                                                                       : CacheAvailability::unavailable;
+            // packages prefetched before the precheck are restored rather than available
+            results[idx] = cache_status[idx]->get_available_provider() || cache_status[idx]->is_restored()
+                               ? CacheAvailability::available
+                               : CacheAvailability::unavailable;
         }
 
         return results;
     }
 
+    bool BinaryCache::is_restored(const Dependencies::InstallPlanAction& action) const
+    {
+        if (const auto abi = action.package_abi().get())
+        {
+            const auto it = m_status.find(*abi);
+            return it != m_status.end() && it->second.is_restored();
+        }
+
+        return false;
+    }
+
+    void BinaryCache::refresh_status(const Dependencies::InstallPlanAction& action)
+    {
+        if (const auto abi = action.package_abi().get())
+        {
+            // try_restore only asks providers which a prefetch has not ruled out, so a fresh status must be prefetched
+            m_status.erase(*abi);
+            prefetch({&action, 1});
+        }
+    }
+
     bool CacheStatus::should_attempt_precheck(const IBinaryProvider* sender) const noexcept
     {
         switch (m_status)
@@ -2,10 +2,13 @@
 #include <vcpkg/base/checks.h>
 #include <vcpkg/base/chrono.h>
 #include <vcpkg/base/hash.h>
+#include <vcpkg/base/jobserver.h>
+#include <vcpkg/base/json.h>
 #include <vcpkg/base/messages.h>
 #include <vcpkg/base/optional.h>
 #include <vcpkg/base/stringliteral.h>
 #include <vcpkg/base/system.debug.h>
+#include <vcpkg/base/system.h>
 #include <vcpkg/base/system.print.h>
 #include <vcpkg/base/system.process.h>
 #include <vcpkg/base/system.proxy.h>
@@ -14,6 +17,7 @@
 #include <vcpkg/binarycaching.h>
 #include <vcpkg/build.h>
 #include <vcpkg/buildenvironment.h>
+#include <vcpkg/buildhistory.h>
 #include <vcpkg/cmakevars.h>
 #include <vcpkg/commands.h>
 #include <vcpkg/commands.version.h>
@@ -32,6 +36,10 @@
 #include <vcpkg/vcpkglib.h>
 #include <vcpkg/vcpkgpaths.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 using namespace vcpkg;
 using vcpkg::Build::BuildResult;
 using vcpkg::PortFileProvider::PathsPortFileProvider;
@@ -200,7 +208,11 @@ namespace vcpkg::Build
         action->build_options.clean_packages = CleanPackages::NO;
 
         const auto build_timer = ElapsedTimer::create_started();
-        const auto result = Build::build_package(args, paths, *action, binary_cache, build_logs_recorder, status_db);
+        const auto result = [&] {
+            const auto package_lock = paths.lock_package_dir(spec);
+            const auto build_dir_lock = paths.lock_build_dir(spec.name());
+            return Build::build_package(args, paths, *action, binary_cache, build_logs_recorder, status_db);
+        }();
         print2("Elapsed time for package ", spec, ": ", build_timer, '\n');
 
         if (result.code == BuildResult::CASCADED_DUE_TO_MISSING_DEPENDENCIES)
@@ -552,7 +564,10 @@ namespace vcpkg::Build
     const Environment& EnvCache::get_action_env(const VcpkgPaths&, const AbiInfo&) { return get_clean_environment(); }
 #endif
 
-    static CompilerInfo load_compiler_info(const VcpkgPaths& paths, const AbiInfo& abi_info);
+    static CompilerInfo load_compiler_info_cached(const VcpkgPaths& paths,
+                                                  const AbiInfo& abi_info,
+                                                  StringView triplet_hash,
+                                                  StringView toolchain_hash);
 
     static const std::string& get_toolchain_cache(Cache<Path, std::string>& cache,
                                                   const Path& tcfile,
@@ -589,7 +604,7 @@ namespace vcpkg::Build
         return triplet_entry.compiler_info.get_lazy(toolchain_hash, [&]() -> CompilerInfo {
             if (m_compiler_tracking)
             {
-                return load_compiler_info(paths, abi_info);
+                return load_compiler_info_cached(paths, abi_info, triplet_entry.hash, toolchain_hash);
             }
             else
             {
@@ -685,6 +700,7 @@ namespace vcpkg::Build
     static void get_generic_cmake_build_args(const VcpkgPaths& paths,
                                              Triplet triplet,
                                              const Toolset& toolset,
+                                             int concurrency,
                                              std::vector<CMakeVariable>& out_vars)
     {
         Util::Vectors::append(&out_vars,
@@ -694,9 +710,14 @@ namespace vcpkg::Build
                                   {"TARGET_TRIPLET", triplet.canonical_name()},
                                   {"TARGET_TRIPLET_FILE", paths.get_triplet_file_path(triplet)},
                                   {"VCPKG_BASE_VERSION", VCPKG_BASE_VERSION_AS_STRING},
-                                  {"VCPKG_CONCURRENCY", std::to_string(get_concurrency())},
+                                  {"VCPKG_CONCURRENCY", std::to_string(concurrency)},
                                   {"VCPKG_PLATFORM_TOOLSET", toolset.version.c_str()},
                               });
+        if (get_jobserver_makeflags().has_value())
+        {
+            // MAKEFLAGS already carries the job limit; an explicit -j would make make leave the jobserver
+            out_vars.push_back({"VCPKG_JOBSERVER", "1"});
+        }
         if (!get_environment_variable("VCPKG_FORCE_SYSTEM_BINARIES").has_value())
         {
             const Path& git_exe_path = paths.get_tool_exe(Tools::GIT);
@@ -704,11 +725,17 @@ namespace vcpkg::Build
         }
     }
 
-    static CompilerInfo load_compiler_info(const VcpkgPaths& paths, const AbiInfo& abi_info)
+    // `resolved_compilers` receives the CMAKE_C_COMPILER and CMAKE_CXX_COMPILER the toolchain chose, when the
+    // detection scripts report them
+    static CompilerInfo load_compiler_info(const VcpkgPaths& paths,
+                                           const AbiInfo& abi_info,
+                                           std::vector<std::string>& resolved_compilers)
     {
         auto triplet = abi_info.pre_build_info->triplet;
         print2("Detecting compiler hash for triplet ", triplet, "...\n");
         auto buildpath = paths.buildtrees() / "detect_compiler";
+        // also guards packages/detect_compiler_<triplet>
+        const auto build_dir_lock = paths.lock_build_dir("detect_compiler");
 
         std::vector<CMakeVariable> cmake_args{
             {"CURRENT_PORT_DIR", paths.scripts / "detect_compiler"},
@@ -717,7 +744,8 @@ namespace vcpkg::Build
             // The detect_compiler "port" doesn't depend on the host triplet, so always natively compile
             {"_HOST_TRIPLET", triplet.canonical_name()},
         };
-        get_generic_cmake_build_args(paths, triplet, abi_info.toolset.value_or_exit(VCPKG_LINE_INFO), cmake_args);
+        get_generic_cmake_build_args(
+            paths, triplet, abi_info.toolset.value_or_exit(VCPKG_LINE_INFO), get_concurrency(), cmake_args);
 
         auto command = vcpkg::make_cmake_cmd(paths, paths.ports_cmake, std::move(cmake_args));
 
@@ -755,6 +783,14 @@ namespace vcpkg::Build
                     {
                         compiler_info.id = s.substr(s_id_marker.size()).to_string();
                     }
+                    for (StringLiteral path_marker : {StringLiteral{"#COMPILER_C_PATH#"},
+                                                      StringLiteral{"#COMPILER_CXX_PATH#"}})
+                    {
+                        if (Strings::starts_with(s, path_marker) && s.size() > path_marker.size())
+                        {
+                            resolved_compilers.push_back(s.substr(path_marker.size()).to_string());
+                        }
+                    }
                     Debug::print(s, '\n');
                     const auto old_buf_size = buf.size();
                     Strings::append(buf, s, '\n');
@@ -786,6 +822,321 @@ namespace vcpkg::Build
         return compiler_info;
     }
 
+    static constexpr StringLiteral COMPILER_INFO_CACHE_FILENAME = "compiler-info-cache.json";
+    static constexpr int COMPILER_INFO_CACHE_VERSION = 2;
+    static constexpr size_t COMPILER_INFO_CACHE_MAX_ENTRIES = 64;
+
+    void append_file_identity(std::string& key_material, const Filesystem& fs, const Path& file)
+    {
+        std::error_code ec;
+        const auto size = fs.file_size(file, ec);
+        const auto mtime = ec ? 0 : fs.last_write_time(file, ec);
+        if (ec)
+        {
+            Strings::append(key_material, file, " missing\n");
+        }
+        else
+        {
+            Strings::append(key_material, file, ' ', size, ' ', mtime, '\n');
+        }
+    }
+
+    void append_build_environment_identity(std::string& key_material, View<std::string> extra_env_vars)
+    {
+        static constexpr StringLiteral tracked_env_vars[] = {
+            "PATH",
+            "CC",
+            "CXX",
+            "CFLAGS",
+            "CXXFLAGS",
+            "CPPFLAGS",
+            "LDFLAGS",
+            "INCLUDE",
+            "LIB",
+            "LIBPATH",
+            "SDKROOT",
+            "DEVELOPER_DIR",
+            "VCPKG_KEEP_ENV_VARS",
+        };
+
+        std::vector<std::string> env_vars(std::begin(tracked_env_vars), std::end(tracked_env_vars));
+        env_vars.insert(env_vars.end(), extra_env_vars.begin(), extra_env_vars.end());
+        for (auto&& env_var : env_vars)
+        {
+            Strings::append(key_material, "env ", env_var, '=', get_environment_variable(env_var).value_or(""), '\n');
+        }
+    }
+
+    // The key covers everything that can change the output of scripts/detect_compiler without
+    // changing the triplet or toolchain file: the detection scripts themselves and the environment
+    // the build runs in. The compilers the toolchain resolved are checked separately when an entry is used.
+    static std::string get_compiler_info_cache_key(const VcpkgPaths& paths,
+                                                   const AbiInfo& abi_info,
+                                                   StringView triplet_hash,
+                                                   StringView toolchain_hash)
+    {
+        const auto& fs = paths.get_filesystem();
+        const auto& pre_build_info = *abi_info.pre_build_info;
+        std::string key_material;
+        Strings::append(key_material, "vcpkg ", VCPKG_BASE_VERSION_AS_STRING, '-', VCPKG_VERSION_AS_STRING, '\n');
+        Strings::append(key_material, "triplet ", pre_build_info.triplet, ' ', triplet_hash, '\n');
+        Strings::append(key_material, "toolchain ", toolchain_hash, '\n');
+        Strings::append(key_material, "ports.cmake ", paths.get_ports_cmake_hash(), '\n');
+        for (auto&& script : fs.get_regular_files_non_recursive(paths.scripts / "detect_compiler", IgnoreErrors{}))
+        {
+            append_file_identity(key_material, fs, script);
+        }
+
+        if (auto toolset = abi_info.toolset.get())
+        {
+            Strings::append(key_material, "toolset ", toolset->vcvarsall, ' ', toolset->full_version, '\n');
+        }
+
+#if defined(_WIN32)
+        Strings::append(key_material, "env ", Strings::to_utf8(paths.get_action_env(abi_info).m_env_data), '\n');
+#endif // ^^^ _WIN32
+
+        append_build_environment_identity(key_material, pre_build_info.passthrough_env_vars);
+        return Hash::get_string_hash(key_material, Hash::Algorithm::Sha256);
+    }
+
+    static Json::Object load_compiler_info_cache(const Filesystem& fs, const Path& cache_file)
+    {
+        std::error_code ec;
+        auto contents = fs.read_contents(cache_file, ec);
+        if (ec)
+        {
+            return {};
+        }
+
+        auto maybe_json = Json::parse(contents, cache_file);
+        if (auto json = maybe_json.get())
+        {
+            if (json->first.is_object())
+            {
+                const auto& obj = json->first.object();
+                auto version = obj.get("version");
+                auto entries = obj.get("entries");
+                if (version && version->is_integer() && version->integer() == COMPILER_INFO_CACHE_VERSION &&
+                    entries && entries->is_object())
+                {
+                    return entries->object();
+                }
+            }
+        }
+
+        Debug::print("Ignoring malformed compiler info cache ", cache_file, '\n');
+        return {};
+    }
+
+    // an entry is only valid while the compilers the toolchain resolved when it was detected are unchanged
+    static bool cached_compilers_unchanged(const Filesystem& fs, const Json::Value* compilers)
+    {
+        if (!compilers || !compilers->is_array() || compilers->array().size() == 0)
+        {
+            return false;
+        }
+
+        for (auto&& compiler : compilers->array())
+        {
+            if (!compiler.is_object())
+            {
+                return false;
+            }
+
+            const auto& obj = compiler.object();
+            auto path = obj.get("path");
+            auto size = obj.get("size");
+            auto mtime = obj.get("mtime");
+            if (!path || !path->is_string() || !size || !size->is_integer() || !mtime || !mtime->is_integer())
+            {
+                return false;
+            }
+
+            std::error_code ec;
+            const Path compiler_path = path->string().to_string();
+            const auto actual_size = fs.file_size(compiler_path, ec);
+            if (ec || actual_size != static_cast<uint64_t>(size->integer()))
+            {
+                return false;
+            }
+
+            const auto actual_mtime = fs.last_write_time(compiler_path, ec);
+            if (ec || actual_mtime != mtime->integer())
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static Optional<CompilerInfo> find_cached_compiler_info(const Filesystem& fs,
+                                                            const Json::Object& entries,
+                                                            StringView key)
+    {
+        auto entry = entries.get(key);
+        if (!entry || !entry->is_object())
+        {
+            return nullopt;
+        }
+
+        const auto& obj = entry->object();
+        auto id = obj.get("id");
+        auto version = obj.get("version");
+        auto hash = obj.get("hash");
+        if (!id || !id->is_string() || !version || !version->is_string() || !hash || !hash->is_string() ||
+            hash->string().empty() || !cached_compilers_unchanged(fs, obj.get("compilers")))
+        {
+            return nullopt;
+        }
+
+        CompilerInfo result{id->string().to_string(), version->string().to_string(), hash->string().to_string(), {}};
+        for (auto&& compiler : obj.get("compilers")->array())
+        {
+            result.paths.push_back(compiler.object().get("path")->string().to_string());
+        }
+
+        return result;
+    }
+
+    static void store_compiler_info_cache(Filesystem& fs,
+                                          const Path& cache_file,
+                                          Json::Object&& entries,
+                                          const std::string& key,
+                                          const CompilerInfo& compiler_info,
+                                          View<std::string> resolved_compilers)
+    {
+        if (resolved_compilers.size() == 0)
+        {
+            Debug::print("Not caching compiler information: the detection scripts did not report compiler paths\n");
+            return;
+        }
+
+        Json::Array compilers;
+        for (auto&& compiler : resolved_compilers)
+        {
+            std::error_code ec;
+            const Path compiler_path = compiler;
+            const auto size = fs.file_size(compiler_path, ec);
+            const auto mtime = ec ? 0 : fs.last_write_time(compiler_path, ec);
+            if (ec)
+            {
+                Debug::print("Not caching compiler information: ", compiler_path, ": ", ec.message(), '\n');
+                return;
+            }
+
+            auto& obj = compilers.push_back(Json::Object{});
+            obj.insert("path", Json::Value::string(compiler));
+            obj.insert("size", Json::Value::integer(static_cast<int64_t>(size)));
+            obj.insert("mtime", Json::Value::integer(mtime));
+        }
+
+        // entries are kept in insertion order, so the front of the object holds the least recently detected ones
+        entries.remove(key);
+        while (entries.size() >= COMPILER_INFO_CACHE_MAX_ENTRIES)
+        {
+            const auto oldest_key = (*entries.begin()).first.to_string();
+            entries.remove(oldest_key);
+        }
+
+        Json::Object entry;
+        entry.insert("id", Json::Value::string(compiler_info.id));
+        entry.insert("version", Json::Value::string(compiler_info.version));
+        entry.insert("hash", Json::Value::string(compiler_info.hash));
+        entry.insert("compilers", std::move(compilers));
+        entries.insert(key, std::move(entry));
+
+        Json::Object root;
+        root.insert("version", Json::Value::integer(COMPILER_INFO_CACHE_VERSION));
+        root.insert("entries", std::move(entries));
+
+        // the cache is an optimization only; failing to update it must not fail the build
+        std::error_code ec;
+        auto temp_file = cache_file + Strings::concat(".", get_process_id(), ".tmp");
+        fs.write_contents(temp_file, Json::stringify(root, {}), ec);
+        if (!ec)
+        {
+            fs.rename(temp_file, cache_file, ec);
+        }
+
+        if (ec)
+        {
+            Debug::print("Failed to update compiler info cache ", cache_file, ": ", ec.message(), '\n');
+            fs.remove(temp_file, IgnoreErrors{});
+        }
+    }
+
+    static CompilerInfo load_compiler_info_cached(const VcpkgPaths& paths,
+                                                  const AbiInfo& abi_info,
+                                                  StringView triplet_hash,
+                                                  StringView toolchain_hash)
+    {
+        auto& fs = paths.get_filesystem();
+        const auto cache_file = paths.buildtrees() / "detect_compiler" / COMPILER_INFO_CACHE_FILENAME;
+        const auto key = get_compiler_info_cache_key(paths, abi_info, triplet_hash, toolchain_hash);
+        auto entries = load_compiler_info_cache(fs, cache_file);
+        auto maybe_cached = find_cached_compiler_info(fs, entries, key);
+        if (auto cached = maybe_cached.get())
+        {
+            Debug::print("Using cached compiler hash for triplet ",
+                         abi_info.pre_build_info->triplet,
+                         ": ",
+                         cached->hash,
+                         '\n');
+            return std::move(*cached);
+        }
+
+        std::vector<std::string> resolved_compilers;
+        auto compiler_info = load_compiler_info(paths, abi_info, resolved_compilers);
+        store_compiler_info_cache(fs, cache_file, std::move(entries), key, compiler_info, resolved_compilers);
+        compiler_info.paths = std::move(resolved_compilers);
+        return compiler_info;
+    }
+
+    // The number of jobs the build of `spec` may run. With a memory budget, a port whose last build's largest process
+    // used more than the budget divided by the usual number of jobs runs fewer, assuming each job uses as much.
+    static int get_build_concurrency(const VcpkgCmdArguments& args, const VcpkgPaths& paths, const PackageSpec& spec)
+    {
+        const int concurrency = get_concurrency();
+        const auto budget_mib = args.build_memory_budget_mib.get();
+        if (!budget_mib)
+        {
+            return concurrency;
+        }
+
+        const auto history = BuildHistory::load(paths.get_filesystem(), paths.installed());
+        const auto entry = history.get(spec).get();
+        if (!entry || entry->peak_rss_bytes == 0)
+        {
+            return concurrency;
+        }
+
+        const uint64_t budget_bytes = *budget_mib * 1024 * 1024;
+        if (entry->peak_rss_bytes > budget_bytes)
+        {
+            vcpkg::printf(Color::warning,
+                          "-- The last build of %s used %llu MiB in a single process, more than the memory budget of "
+                          "%llu MiB. Building it with one job.\n",
+                          spec.to_string(),
+                          static_cast<unsigned long long>(entry->peak_rss_bytes / (1024 * 1024)),
+                          static_cast<unsigned long long>(*budget_mib));
+            return 1;
+        }
+
+        const auto jobs = budget_bytes / entry->peak_rss_bytes;
+        if (jobs >= static_cast<uint64_t>(concurrency))
+        {
+            return concurrency;
+        }
+
+        vcpkg::printf("-- Building %s with %d jobs to stay within the memory budget of %llu MiB\n",
+                      spec.to_string(),
+                      static_cast<int>(jobs),
+                      static_cast<unsigned long long>(*budget_mib));
+        return static_cast<int>(jobs);
+    }
+
     static std::vector<CMakeVariable> get_cmake_build_args(const VcpkgCmdArguments& args,
                                                            const VcpkgPaths& paths,
                                                            const Dependencies::InstallPlanAction& action)
@@ -831,6 +1182,7 @@ namespace vcpkg::Build
             paths,
             action.spec.triplet(),
             action.abi_info.value_or_exit(VCPKG_LINE_INFO).toolset.value_or_exit(VCPKG_LINE_INFO),
+            get_build_concurrency(args, paths, action.spec),
             variables);
 
         if (Util::Enum::to_bool(action.build_options.only_downloads))
@@ -927,9 +1279,186 @@ namespace vcpkg::Build
         }
     }
 
+    namespace
+    {
+        // Carries a port build's output to its log file and the console. The log is written by a background thread so
+        // a slow disk does not stall the build, and in BuildOutput::TAIL mode the console only receives status lines
+        // while the end of the log is kept for reporting a failure.
+        struct BuildLogPipeline
+        {
+            BuildLogPipeline(Filesystem& fs, const Path& log_path, BuildOutput mode)
+                : m_log_path(log_path), m_mode(mode)
+            {
+                // the writer thread owns the file, which is closed when it exits
+                m_writer = std::thread([this, log_file = fs.open_for_write(log_path, VCPKG_LINE_INFO)]() {
+                    write_loop(log_file);
+                });
+            }
+
+            BuildLogPipeline(const BuildLogPipeline&) = delete;
+            BuildLogPipeline& operator=(const BuildLogPipeline&) = delete;
+
+            ~BuildLogPipeline()
+            {
+                if (m_writer.joinable())
+                {
+                    stop_writer();
+                }
+            }
+
+            void on_data(StringView sv)
+            {
+                if (m_mode == BuildOutput::FULL)
+                {
+                    print2(sv);
+                }
+                else
+                {
+                    m_lines.on_data(sv, [this](StringView line) { on_line(line); });
+                }
+
+                std::unique_lock<std::mutex> lock(m_mtx);
+                // bound the memory held for a disk that cannot keep up
+                m_cv.wait(lock, [this]() { return m_pending.size() < max_pending_bytes || m_write_failed; });
+                if (m_write_failed)
+                {
+                    // reported by finish()
+                    return;
+                }
+
+                const bool was_empty = m_pending.empty();
+                Strings::append(m_pending, sv);
+                if (was_empty)
+                {
+                    m_cv.notify_all();
+                }
+            }
+
+            // flushes the log and closes it
+            void finish()
+            {
+                if (m_mode == BuildOutput::TAIL)
+                {
+                    m_lines.on_end([this](StringView line) {
+                        if (!line.empty()) on_line(line);
+                    });
+                }
+
+                stop_writer();
+                Checks::check_exit(VCPKG_LINE_INFO, !m_write_failed, "Error occurred while writing '%s'", m_log_path);
+            }
+
+            void print_tail(const PackageSpec& spec) const
+            {
+                if (m_mode == BuildOutput::TAIL)
+                {
+                    print2(Color::error, "-- Last lines of the build log for ", spec, " (", m_log_path, "):\n");
+                    // once the ring is full, m_tail_next is its oldest line
+                    for (size_t i = 0; i < m_tail.size(); ++i)
+                    {
+                        print2("    ", m_tail[(m_tail_next + i) % m_tail.size()], '\n');
+                    }
+                }
+            }
+
+        private:
+            static constexpr size_t max_pending_bytes = 16 * 1024 * 1024;
+            static constexpr size_t max_tail_lines = 100;
+
+            void on_line(StringView line)
+            {
+                if (Strings::starts_with(line, "-- ") || Strings::starts_with(line, "CMake Error") ||
+                    Strings::starts_with(line, "CMake Warning"))
+                {
+                    print2(line, '\n');
+                }
+
+                if (m_tail.size() == max_tail_lines)
+                {
+                    // reuse the oldest line's buffer
+                    m_tail[m_tail_next].assign(line.begin(), line.end());
+                    m_tail_next = (m_tail_next + 1) % max_tail_lines;
+                }
+                else
+                {
+                    m_tail.emplace_back(line.begin(), line.end());
+                }
+            }
+
+            void write_loop(const WriteFilePointer& log_file)
+            {
+                std::string writing;
+                std::unique_lock<std::mutex> lock(m_mtx);
+                for (;;)
+                {
+                    m_cv.wait(lock, [this]() { return !m_pending.empty() || m_stopping; });
+                    if (m_pending.empty())
+                    {
+                        return;
+                    }
+
+                    writing.swap(m_pending);
+                    m_cv.notify_all();
+                    lock.unlock();
+                    const bool write_ok = log_file.write(writing.data(), 1, writing.size()) == writing.size();
+                    writing.clear();
+                    lock.lock();
+                    if (!write_ok)
+                    {
+                        m_write_failed = true;
+                        m_pending.clear();
+                        m_cv.notify_all();
+                        return;
+                    }
+                }
+            }
+
+            void stop_writer()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    m_stopping = true;
+                }
+
+                m_cv.notify_all();
+                m_writer.join();
+            }
+
+            Path m_log_path;
+            BuildOutput m_mode;
+            Strings::LinesStream m_lines;
+            std::vector<std::string> m_tail;
+            size_t m_tail_next = 0;
+
+            std::mutex m_mtx;
+            std::condition_variable m_cv;
+            std::string m_pending;
+            bool m_stopping = false;
+            bool m_write_failed = false;
+            std::thread m_writer;
+        };
+    }
+
+    static void write_resource_usage(Filesystem& fs, const Path& path, const ProcessResourceUsage& usage)
+    {
+        Json::Object obj;
+        obj.insert("user-cpu-us", Json::Value::integer(static_cast<int64_t>(usage.user_cpu_us)));
+        obj.insert("system-cpu-us", Json::Value::integer(static_cast<int64_t>(usage.system_cpu_us)));
+        obj.insert("peak-rss-bytes", Json::Value::integer(static_cast<int64_t>(usage.peak_rss_bytes)));
+        obj.insert("blocks-read", Json::Value::integer(static_cast<int64_t>(usage.blocks_read)));
+        obj.insert("blocks-written", Json::Value::integer(static_cast<int64_t>(usage.blocks_written)));
+        std::error_code ec;
+        fs.write_contents(path, Json::stringify(obj, {}), ec);
+        if (ec)
+        {
+            Debug::print("Failed to write ", path, ": ", ec.message(), '\n');
+        }
+    }
+
     static ExtendedBuildResult do_build_package(const VcpkgCmdArguments& args,
                                                 const VcpkgPaths& paths,
-                                                const Dependencies::InstallPlanAction& action)
+                                                const Dependencies::InstallPlanAction& action,
+                                                Optional<ProcessResourceUsage>& resource_usage)
     {
         const auto& pre_build_info = action.pre_build_info(VCPKG_LINE_INFO);
 
@@ -960,7 +1489,8 @@ namespace vcpkg::Build
 
         auto command = vcpkg::make_cmake_cmd(paths, paths.ports_cmake, get_cmake_build_args(args, paths, action));
 
-        const auto& env = paths.get_action_env(action.abi_info.value_or_exit(VCPKG_LINE_INFO));
+        auto env = paths.get_action_env(action.abi_info.value_or_exit(VCPKG_LINE_INFO));
+        add_jobserver_to_environment(env);
 
         auto buildpath = paths.buildtrees() / action.spec.name();
         if (!fs.exists(buildpath, IgnoreErrors{}))
@@ -971,21 +1501,25 @@ namespace vcpkg::Build
                 VCPKG_LINE_INFO, !err.value(), "Failed to create directory '%s', code: %d", buildpath, err.value());
         }
         auto stdoutlog = buildpath / ("stdout-" + action.spec.triplet().canonical_name() + ".log");
-        int return_code;
+        BuildLogPipeline log_pipeline(fs, stdoutlog, action.build_options.build_output);
+        const int return_code = cmd_execute_and_stream_data(
+            command,
+            [&](StringView sv) { log_pipeline.on_data(sv); },
+            default_working_directory,
+            env,
+            Encoding::Utf8,
+            &resource_usage);
+        log_pipeline.finish();
+        if (auto usage = resource_usage.get())
         {
-            auto out_file = fs.open_for_write(stdoutlog, VCPKG_LINE_INFO);
-            return_code = cmd_execute_and_stream_data(
-                command,
-                [&](StringView sv) {
-                    print2(sv);
-                    Checks::check_exit(VCPKG_LINE_INFO,
-                                       out_file.write(sv.data(), 1, sv.size()) == sv.size(),
-                                       "Error occurred while writing '%s'",
-                                       stdoutlog);
-                },
-                default_working_directory,
-                env);
-        } // close out_file
+            write_resource_usage(
+                fs, buildpath / ("resource-usage-" + action.spec.triplet().canonical_name() + ".json"), *usage);
+        }
+
+        if (return_code != 0 && action.build_options.only_downloads == Build::OnlyDownloads::NO)
+        {
+            log_pipeline.print_tail(action.spec);
+        }
 
         // With the exception of empty packages, builds in "Download Mode" always result in failure.
         if (action.build_options.only_downloads == Build::OnlyDownloads::YES)
@@ -1048,6 +1582,16 @@ namespace vcpkg::Build
         }
 
         write_binary_control_file(paths, *bcf);
+
+        BuildHistory::Entry history_entry;
+        history_entry.build_time_us = static_cast<uint64_t>(buildtimeus);
+        if (auto usage = resource_usage.get())
+        {
+            history_entry.peak_rss_bytes = usage->peak_rss_bytes;
+        }
+
+        history_entry.package_size = get_package_size(fs, paths.package_dir(action.spec));
+        record_build(fs, paths.installed(), action.spec, history_entry);
         return {BuildResult::SUCCEEDED, std::move(bcf)};
     }
 
@@ -1055,7 +1599,9 @@ namespace vcpkg::Build
                                                                      const VcpkgPaths& paths,
                                                                      const Dependencies::InstallPlanAction& action)
     {
-        auto result = do_build_package(args, paths, action);
+        Optional<ProcessResourceUsage> resource_usage;
+        auto result = do_build_package(args, paths, action, resource_usage);
+        result.resource_usage = std::move(resource_usage);
 
         if (action.build_options.clean_buildtrees == CleanBuildtrees::YES)
         {
@@ -1064,7 +1610,11 @@ namespace vcpkg::Build
             auto buildtree_dirs = fs.get_directories_non_recursive(paths.build_dir(action.spec), IgnoreErrors{});
             for (auto&& dir : buildtree_dirs)
             {
-                fs.remove_all(dir, IgnoreErrors{});
+                // trees removed by earlier builds may still be in the trash
+                if (dir.filename() != ".vcpkg-trash")
+                {
+                    fs.remove_all_in_background(dir, IgnoreErrors{});
+                }
             }
         }
 
@@ -1223,7 +1773,11 @@ namespace vcpkg::Build
             auto current_build_tree = paths.build_dir(action.spec);
             fs.create_directory(current_build_tree, VCPKG_LINE_INFO);
             const auto abi_file_path = current_build_tree / (triplet.canonical_name() + ".vcpkg_abi_info.txt");
-            fs.write_contents(abi_file_path, full_abi_info, VCPKG_LINE_INFO);
+            // another process computing the same ABI may be writing this file too
+            fs.write_rename_contents(abi_file_path,
+                                     Strings::concat(abi_file_path.filename(), '.', get_process_id(), ".tmp"),
+                                     full_abi_info,
+                                     VCPKG_LINE_INFO);
 
             return AbiTagAndFile{&triplet_abi,
                                  Hash::get_file_hash(VCPKG_LINE_INFO, fs, abi_file_path, Hash::Algorithm::Sha256),
@@ -1241,12 +1795,19 @@ namespace vcpkg::Build
     void compute_all_abis(const VcpkgPaths& paths,
                           Dependencies::ActionPlan& action_plan,
                           const CMakeVars::CMakeVarProvider& var_provider,
-                          const StatusParagraphs& status_db)
+                          const StatusParagraphs& status_db,
+                          const std::function<void(size_t)>& on_computed)
     {
         using Dependencies::InstallPlanAction;
         for (auto it = action_plan.install_actions.begin(); it != action_plan.install_actions.end(); ++it)
         {
             auto& action = *it;
+            if (on_computed)
+            {
+                // the actions before this one are done
+                on_computed(static_cast<size_t>(it - action_plan.install_actions.begin()));
+            }
+
             if (action.abi_info.has_value()) continue;
 
             std::vector<AbiEntry> dependency_abis;
@@ -1293,6 +1854,43 @@ namespace vcpkg::Build
                 abi_info.abi_tag_file = std::move(p->tag_file);
             }
         }
+
+        if (on_computed)
+        {
+            on_computed(action_plan.install_actions.size());
+        }
+    }
+
+    void IBuildExecutor::prebuild(const VcpkgPaths&,
+                                  View<Dependencies::InstallPlanAction>,
+                                  BinaryCache&,
+                                  const StatusParagraphs&)
+    {
+    }
+
+    ExtendedBuildResult LocalBuildExecutor::build(const VcpkgCmdArguments& args,
+                                                  const VcpkgPaths& paths,
+                                                  const Dependencies::InstallPlanAction& action,
+                                                  BinaryCache& binary_cache,
+                                                  const IBuildLogsRecorder& build_logs_recorder,
+                                                  const StatusParagraphs& status_db)
+    {
+        return build_package(args, paths, action, binary_cache, build_logs_recorder, status_db);
+    }
+
+    std::unique_ptr<IBuildExecutor> make_build_executor(const VcpkgCmdArguments& args)
+    {
+        if (args.build_workers.empty())
+        {
+            return std::make_unique<LocalBuildExecutor>();
+        }
+
+        Checks::check_exit(VCPKG_LINE_INFO,
+                           args.binary_caching_enabled(),
+                           "Error: --%s requires binary caching, since workers return packages through the binary "
+                           "cache",
+                           VcpkgCmdArguments::BUILD_WORKER_ARG);
+        return make_remote_build_executor(args);
     }
 
     ExtendedBuildResult build_package(const VcpkgCmdArguments& args,
@@ -0,0 +1,419 @@
+#include <vcpkg/base/chrono.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/graphs.h>
+#include <vcpkg/base/json.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/system.h>
+#include <vcpkg/base/system.print.h>
+#include <vcpkg/base/system.process.h>
+#include <vcpkg/base/util.h>
+
+#include <vcpkg/binarycaching.h>
+#include <vcpkg/build.h>
+#include <vcpkg/buildhistory.h>
+#include <vcpkg/dependencies.h>
+#include <vcpkg/paragraphs.h>
+#include <vcpkg/statusparagraphs.h>
+#include <vcpkg/tools.h>
+#include <vcpkg/vcpkgcmdarguments.h>
+#include <vcpkg/vcpkgpaths.h>
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <unordered_set>
+
+// Remote builds send each package to a worker as a job bundle: a tar.gz holding job.json, the port directories of
+// the package and of its dependencies in the same plan, and the triplet files they use. job.json lists the package
+// and all of its dependencies with the features and ABIs this machine resolved for them, so that the worker plans
+// the same slice rather than re-resolving default features. The bundle is piped to `<worker command>
+// x-build-worker`, which installs that slice into a scratch tree on the worker, failing before any build if it
+// computes a different ABI, pushes the package to the binary cache, and prints the build's output, which becomes
+// the log kept here. The package then comes back through the binary cache, so workers and this machine must share
+// one, and workers must compute the same ABIs: the same vcpkg, compilers, and scripts. The binary sources reach the
+// worker command as VCPKG_BINARY_SOURCES, never in the bundle or on a command line, since they may hold secrets; a
+// worker command which crosses machines must forward that variable (e.g. with ssh's SendEnv).
+
+namespace
+{
+    using namespace vcpkg;
+    using namespace vcpkg::Build;
+    using Dependencies::InstallPlanAction;
+
+    // the recursion data a vcpkg process hands to its children must not reach workers, which are separate
+    // top-level invocations
+    constexpr StringLiteral UNSET_RECURSIVE_DATA = "env -u X_VCPKG_RECURSIVE_DATA";
+
+    bool can_build_remotely(const InstallPlanAction& action)
+    {
+        const auto& options = action.build_options;
+        return action.plan_type == Dependencies::InstallPlanType::BUILD_AND_INSTALL && action.has_package_abi() &&
+               options.build_missing == BuildMissing::YES && options.only_downloads == OnlyDownloads::NO &&
+               options.editable == Editable::NO && options.use_head_version == UseHeadVersion::NO;
+    }
+
+    std::string make_job_spec(const PackageSpec& spec, View<std::string> features)
+    {
+        auto result = spec.name();
+        if (features.size() != 0)
+        {
+            Strings::append(result, '[', Strings::join(",", features), ']');
+        }
+
+        return Strings::concat(result, ':', spec.triplet());
+    }
+
+    // Lays out the job bundle for `action` in the empty directory `job_dir`.
+    void stage_job_bundle(const VcpkgPaths& paths,
+                          const InstallPlanAction& action,
+                          const std::unordered_map<PackageSpec, const InstallPlanAction*>& plan,
+                          const StatusParagraphs& status_db,
+                          const Path& job_dir)
+    {
+        auto& fs = paths.get_filesystem();
+        fs.create_directories(job_dir / "ports", VCPKG_LINE_INFO);
+        fs.create_directories(job_dir / "triplets", VCPKG_LINE_INFO);
+        std::set<std::string> shipped_ports;
+        std::set<std::string> shipped_triplets;
+        const auto ship_triplet = [&](Triplet triplet) {
+            if (shipped_triplets.insert(triplet.to_string()).second)
+            {
+                fs.copy_file(paths.get_triplet_file_path(triplet),
+                             job_dir / "triplets" / Strings::concat(triplet, ".cmake"),
+                             CopyOptions::none,
+                             VCPKG_LINE_INFO);
+            }
+        };
+
+        ship_triplet(action.host_triplet);
+        // the feature-resolved slice of the plan this package needs, as {spec with features, ABI}
+        std::vector<std::pair<std::string, std::string>> packages;
+        std::unordered_set<PackageSpec> visited;
+        std::vector<PackageSpec> pending_installed;
+        std::vector<const InstallPlanAction*> pending{&action};
+        while (!pending.empty())
+        {
+            const auto current = pending.back();
+            pending.pop_back();
+            if (!visited.insert(current->spec).second) continue;
+
+            packages.emplace_back(make_job_spec(current->spec, current->feature_list),
+                                  current->package_abi().value_or_exit(VCPKG_LINE_INFO));
+            const auto& port_name = current->spec.name();
+            if (shipped_ports.insert(port_name).second)
+            {
+                const auto& scfl = current->source_control_file_and_location.value_or_exit(VCPKG_LINE_INFO);
+                fs.copy_regular_recursive(scfl.source_location, job_dir / "ports" / port_name, VCPKG_LINE_INFO);
+            }
+
+            ship_triplet(current->spec.triplet());
+            for (auto&& dependency : current->package_dependencies)
+            {
+                const auto it = plan.find(dependency);
+                if (it != plan.end() && it->second->source_control_file_and_location)
+                {
+                    pending.push_back(it->second);
+                }
+                else
+                {
+                    pending_installed.push_back(dependency);
+                }
+            }
+        }
+
+        // dependencies which are already installed are not in the plan; the worker finds those ports itself, and
+        // must install them with the features installed here
+        while (!pending_installed.empty())
+        {
+            const auto spec = std::move(pending_installed.back());
+            pending_installed.pop_back();
+            if (!visited.insert(spec).second) continue;
+
+            const auto maybe_ipv = status_db.get_installed_package_view(spec);
+            const auto ipv = maybe_ipv.get();
+            Checks::check_exit(VCPKG_LINE_INFO, ipv, "Error: %s is neither in the plan nor installed", spec);
+            std::vector<std::string> features{"core"};
+            for (auto&& feature : ipv->features)
+            {
+                features.push_back(feature->package.feature);
+            }
+
+            Util::sort_unique_erase(features);
+            packages.emplace_back(make_job_spec(spec, features), ipv->core->package.abi);
+            ship_triplet(spec.triplet());
+            Util::Vectors::append(&pending_installed, ipv->dependencies());
+        }
+
+        Json::Object job;
+        job.insert("spec", Json::Value::string(packages.front().first));
+        job.insert("host-triplet", Json::Value::string(action.host_triplet.to_string()));
+        job.insert("abi", Json::Value::string(packages.front().second));
+        auto& job_packages = job.insert("packages", Json::Array());
+        for (auto&& package : packages)
+        {
+            auto& object = job_packages.push_back(Json::Object());
+            object.insert("spec", Json::Value::string(package.first));
+            object.insert("abi", Json::Value::string(package.second));
+        }
+
+        fs.write_contents(job_dir / "job.json", Json::stringify(job, {}), VCPKG_LINE_INFO);
+    }
+
+    struct RemoteBuildExecutor final : IBuildExecutor
+    {
+        explicit RemoteBuildExecutor(std::vector<std::string> workers) : m_workers(std::move(workers)) { }
+
+        void prebuild(const VcpkgPaths& paths,
+                      View<InstallPlanAction> actions,
+                      BinaryCache& binary_cache,
+                      const StatusParagraphs& status_db) override
+        {
+            for (auto&& action : actions)
+            {
+                m_plan.emplace(action.spec, &action);
+            }
+
+            // packages without an ABI cannot come back through the binary cache, and precheck needs every ABI
+            if (actions.size() == 0 || Util::any_of(actions, [](const InstallPlanAction& action) {
+                    return !action.has_package_abi();
+                }))
+            {
+                return;
+            }
+
+            std::unordered_map<PackageSpec, uint32_t> indices;
+            for (uint32_t i = 0; i < actions.size(); ++i)
+            {
+                indices.emplace(actions[i].spec, i);
+            }
+
+            std::vector<std::pair<uint32_t, uint32_t>> edges;
+            for (uint32_t i = 0; i < actions.size(); ++i)
+            {
+                for (auto&& dependency : actions[i].package_dependencies)
+                {
+                    const auto it = indices.find(dependency);
+                    if (it != indices.end())
+                    {
+                        edges.emplace_back(i, it->second);
+                    }
+                }
+            }
+
+            const auto levels = Graphs::topological_levels(Graphs::DenseGraph(actions.size(), edges));
+            const auto remaining_critical_path =
+                remaining_critical_paths(actions, BuildHistory::load(paths.get_filesystem(), paths.installed()));
+            const auto availability = binary_cache.precheck(actions);
+            // whether the package is in the binary cache, so that packages depending on it can be built remotely
+            std::vector<bool> cached(actions.size());
+            for (size_t i = 0; i < actions.size(); ++i)
+            {
+                cached[i] = availability[i] == CacheAvailability::available;
+            }
+
+            for (size_t level = 0; level < levels.level_count(); ++level)
+            {
+                std::vector<uint32_t> to_build;
+                for (auto i : levels.level(level))
+                {
+                    if (cached[i] || !can_build_remotely(actions[i])) continue;
+                    if (!Util::any_of(actions[i].package_dependencies, [&](const PackageSpec& dependency) {
+                            const auto it = indices.find(dependency);
+                            return it != indices.end() && !cached[it->second];
+                        }))
+                    {
+                        to_build.push_back(i);
+                    }
+                }
+
+                if (to_build.empty()) continue;
+                // workers take jobs in order, so the slowest chains start first
+                std::stable_sort(to_build.begin(), to_build.end(), [&](uint32_t lhs, uint32_t rhs) {
+                    return remaining_critical_path[lhs] > remaining_critical_path[rhs];
+                });
+                vcpkg::printf("Building %zd package(s) on %zd worker(s)...\n", to_build.size(), m_workers.size());
+                std::vector<Optional<uint64_t>> build_times_us(to_build.size());
+                std::atomic<size_t> next{0};
+                std::vector<std::thread> threads;
+                for (size_t worker = 0; worker < m_workers.size() && worker < to_build.size(); ++worker)
+                {
+                    threads.emplace_back([&, worker] {
+                        for (size_t job = next++; job < to_build.size(); job = next++)
+                        {
+                            const auto& action = actions[to_build[job]];
+                            const auto build_dir_lock = paths.lock_build_dir(action.spec.name());
+                            build_times_us[job] = run_on_worker(paths, m_workers[worker], action, status_db);
+                        }
+                    });
+                }
+
+                for (auto&& thread : threads)
+                {
+                    thread.join();
+                }
+
+                for (size_t job = 0; job < to_build.size(); ++job)
+                {
+                    const auto& action = actions[to_build[job]];
+                    if (auto build_time_us = build_times_us[job].get())
+                    {
+                        cached[to_build[job]] = true;
+                        // refreshing restores the package; install holds this lock when it calls build()
+                        const auto package_lock = paths.lock_package_dir(action.spec);
+                        binary_cache.refresh_status(action);
+                        if (binary_cache.is_restored(action))
+                        {
+                            record_remote_build(paths, action, *build_time_us);
+                        }
+                    }
+                    else
+                    {
+                        m_failed.insert(action.spec);
+                    }
+                }
+            }
+        }
+
+        ExtendedBuildResult build(const VcpkgCmdArguments& args,
+                                  const VcpkgPaths& paths,
+                                  const InstallPlanAction& action,
+                                  BinaryCache& binary_cache,
+                                  const IBuildLogsRecorder& build_logs_recorder,
+                                  const StatusParagraphs& status_db) override
+        {
+            if (!can_build_remotely(action))
+            {
+                return build_package(args, paths, action, binary_cache, build_logs_recorder, status_db);
+            }
+
+            // the failure was reported when it happened
+            if (m_failed.count(action.spec)) return BuildResult::BUILD_FAILED;
+
+            const auto& worker = m_workers[m_next_worker++ % m_workers.size()];
+            const auto build_time_us = run_on_worker(paths, worker, action, status_db);
+            if (!build_time_us) return BuildResult::BUILD_FAILED;
+
+            binary_cache.refresh_status(action);
+            if (binary_cache.try_restore(action) != RestoreResult::restored)
+            {
+                vcpkg::printf(Color::error,
+                              "Error: %s was built on %s, but no package with ABI %s could be restored from the binary "
+                              "cache. The worker must push to a binary cache this machine reads, and must compute the "
+                              "same ABI.\n",
+                              action.spec,
+                              worker,
+                              action.package_abi().value_or_exit(VCPKG_LINE_INFO));
+                return BuildResult::BUILD_FAILED;
+            }
+
+            record_remote_build(paths, action, *build_time_us.get());
+            auto maybe_bcf = Paragraphs::try_load_cached_package(
+                paths.get_filesystem(), paths.package_dir(action.spec), action.spec);
+            return {BuildResult::SUCCEEDED,
+                    std::make_unique<BinaryControlFile>(std::move(maybe_bcf).value_or_exit(VCPKG_LINE_INFO))};
+        }
+
+        bool builds_concurrently() const override { return true; }
+
+    private:
+        // Records the build of `action`, restored into its package directory, in this machine's build history. The
+        // time includes sending the job and installing its dependencies on the worker; memory use is unknown.
+        static void record_remote_build(const VcpkgPaths& paths,
+                                        const InstallPlanAction& action,
+                                        uint64_t build_time_us)
+        {
+            auto& fs = paths.get_filesystem();
+            BuildHistory::Entry entry;
+            entry.build_time_us = build_time_us;
+            entry.package_size = get_package_size(fs, paths.package_dir(action.spec));
+            record_build(fs, paths.installed(), action.spec, entry);
+        }
+
+        // Builds `action` on `worker`, keeping the worker's output as the log, and returns how long that took in
+        // microseconds if it succeeded. The caller holds the lock on the build directory of `action`, which this
+        // writes the job bundle and the log to. May be called from several threads.
+        Optional<uint64_t> run_on_worker(const VcpkgPaths& paths,
+                                         const std::string& worker,
+                                         const InstallPlanAction& action,
+                                         const StatusParagraphs& status_db) const
+        {
+            auto& fs = paths.get_filesystem();
+            const auto build_dir = paths.build_dir(action.spec);
+            fs.create_directories(build_dir, VCPKG_LINE_INFO);
+            const auto triplet = action.spec.triplet().to_string();
+            const auto bundle_path = build_dir / Strings::concat("remote-", triplet, ".tar.gz");
+            const auto log_path = build_dir / Strings::concat("remote-", triplet, ".log");
+            const auto job_dir = build_dir / Strings::concat("remote-", triplet);
+            fs.remove_all(job_dir, VCPKG_LINE_INFO);
+            stage_job_bundle(paths, action, m_plan, status_db, job_dir);
+            vcpkg::Command tar{paths.get_tool_exe(Tools::CMAKE)};
+            tar.string_arg("-E").string_arg("tar").string_arg("czf").string_arg(bundle_path).string_arg("--");
+            tar.string_arg("job.json").string_arg("ports").string_arg("triplets");
+            const auto tar_exit_code = cmd_execute_clean(tar, WorkingDirectory{job_dir});
+            fs.remove_all(job_dir, VCPKG_LINE_INFO);
+            Checks::check_exit(
+                VCPKG_LINE_INFO, tar_exit_code == 0, "Error: could not create the job bundle %s", bundle_path);
+
+            vcpkg::printf("Sending %s to %s...\n", action.displayname(), worker);
+            vcpkg::Command command;
+            command.raw_arg(UNSET_RECURSIVE_DATA).raw_arg(worker).string_arg("x-build-worker");
+            command.raw_arg("<").string_arg(bundle_path);
+            const auto timer = ElapsedTimer::create_started();
+            const auto result = cmd_execute_and_capture_output(command);
+            const auto build_time_us = timer.us_64();
+            fs.write_contents(log_path, result.output, VCPKG_LINE_INFO);
+            fs.remove(bundle_path, IgnoreErrors{});
+            if (result.exit_code != 0)
+            {
+                vcpkg::printf(Color::error,
+                              "Error: building %s on %s failed with exit code %d. See the log at %s\n",
+                              action.spec,
+                              worker,
+                              result.exit_code,
+                              log_path);
+                return nullopt;
+            }
+
+            return build_time_us;
+        }
+
+        std::vector<std::string> m_workers;
+        std::unordered_map<PackageSpec, const InstallPlanAction*> m_plan;
+        std::unordered_set<PackageSpec> m_failed;
+        size_t m_next_worker = 0;
+    };
+}
+
+namespace vcpkg::Build
+{
+    std::unique_ptr<IBuildExecutor> make_remote_build_executor(const VcpkgCmdArguments& args)
+    {
+#if defined(_WIN32)
+        Checks::exit_with_message(VCPKG_LINE_INFO,
+                                  "Error: --%s is only supported on non-Windows hosts",
+                                  VcpkgCmdArguments::BUILD_WORKER_ARG);
+#else
+        // workers see the sources this machine uses, so that they push where this machine restores from; sources
+        // apply in order, so those from the command line follow those from the environment, as they do here. The
+        // binary cache has already read the environment, and workers inherit it.
+        if (!args.binary_sources.empty())
+        {
+            std::vector<std::string> binary_sources;
+            const auto maybe_env_sources = get_environment_variable("VCPKG_BINARY_SOURCES");
+            if (auto env_sources = maybe_env_sources.get())
+            {
+                if (!env_sources->empty())
+                {
+                    binary_sources.push_back(*env_sources);
+                }
+            }
+
+            Util::Vectors::append(&binary_sources, args.binary_sources);
+            set_environment_variable("VCPKG_BINARY_SOURCES", Strings::join(";", binary_sources));
+        }
+
+        return std::make_unique<RemoteBuildExecutor>(args.build_workers);
+#endif
+    }
+}
@@ -0,0 +1,316 @@
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/json.h>
+#include <vcpkg/base/system.debug.h>
+#include <vcpkg/base/system.h>
+#include <vcpkg/base/util.h>
+
+#include <vcpkg/buildhistory.h>
+#include <vcpkg/dependencies.h>
+#include <vcpkg/installedpaths.h>
+
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+    using namespace vcpkg;
+
+    constexpr int BUILD_HISTORY_VERSION = 1;
+    constexpr StringLiteral BUILD_TIME_US = "build-time-us";
+    constexpr StringLiteral PACKAGE_SIZE = "package-size";
+    constexpr StringLiteral PEAK_RSS_BYTES = "peak-rss-bytes";
+
+    Optional<uint64_t> get_size(const Json::Object& obj, StringLiteral key)
+    {
+        auto value = obj.get(key);
+        if (value && value->is_integer() && value->integer() >= 0)
+        {
+            return static_cast<uint64_t>(value->integer());
+        }
+
+        return nullopt;
+    }
+}
+
+namespace vcpkg
+{
+    BuildHistory BuildHistory::load(const Filesystem& fs, const InstalledPaths& installed)
+    {
+        BuildHistory history;
+        const auto path = installed.build_history_path();
+        std::error_code ec;
+        auto contents = fs.read_contents(path, ec);
+        if (ec)
+        {
+            return history;
+        }
+
+        auto maybe_json = Json::parse(contents, path);
+        auto json = maybe_json.get();
+        if (!json || !json->first.is_object())
+        {
+            Debug::print("Ignoring malformed build history ", path, '\n');
+            return history;
+        }
+
+        const auto& obj = json->first.object();
+        auto version = obj.get("version");
+        auto ports = obj.get("ports");
+        if (!version || !version->is_integer() || version->integer() != BUILD_HISTORY_VERSION || !ports ||
+            !ports->is_object())
+        {
+            Debug::print("Ignoring build history ", path, " of an unknown version\n");
+            return history;
+        }
+
+        for (auto&& port : ports->object())
+        {
+            if (!port.second.is_object()) continue;
+            auto build_time_us = get_size(port.second.object(), BUILD_TIME_US);
+            auto package_size = get_size(port.second.object(), PACKAGE_SIZE);
+            if (build_time_us && package_size)
+            {
+                // histories written before memory use was recorded lack it
+                history.m_entries[port.first.to_string()] =
+                    Entry{*build_time_us.get(),
+                          *package_size.get(),
+                          get_size(port.second.object(), PEAK_RSS_BYTES).value_or(0)};
+                history.m_total_build_time_us += *build_time_us.get();
+            }
+        }
+
+        return history;
+    }
+
+    Optional<const BuildHistory::Entry&> BuildHistory::get(const PackageSpec& spec) const
+    {
+        const auto it = m_entries.find(spec.to_string());
+        if (it == m_entries.end())
+        {
+            return nullopt;
+        }
+
+        return it->second;
+    }
+
+    void BuildHistory::set(const PackageSpec& spec, const Entry& entry)
+    {
+        auto& existing = m_entries[spec.to_string()];
+        m_total_build_time_us -= existing.build_time_us;
+        existing = entry;
+        m_total_build_time_us += entry.build_time_us;
+    }
+
+    uint64_t BuildHistory::estimated_build_time_us(const PackageSpec& spec) const
+    {
+        if (auto entry = get(spec).get())
+        {
+            return entry->build_time_us;
+        }
+
+        if (m_entries.empty())
+        {
+            return 1;
+        }
+
+        return std::max<uint64_t>(1, m_total_build_time_us / m_entries.size());
+    }
+
+    void BuildHistory::save(Filesystem& fs, const InstalledPaths& installed) const
+    {
+        Json::Object ports;
+        for (auto&& entry : m_entries)
+        {
+            Json::Object port;
+            port.insert(BUILD_TIME_US.to_string(),
+                        Json::Value::integer(static_cast<int64_t>(entry.second.build_time_us)));
+            port.insert(PACKAGE_SIZE.to_string(),
+                        Json::Value::integer(static_cast<int64_t>(entry.second.package_size)));
+            if (entry.second.peak_rss_bytes != 0)
+            {
+                port.insert(PEAK_RSS_BYTES.to_string(),
+                            Json::Value::integer(static_cast<int64_t>(entry.second.peak_rss_bytes)));
+            }
+            ports.insert(entry.first, std::move(port));
+        }
+
+        Json::Object root;
+        root.insert("version", Json::Value::integer(BUILD_HISTORY_VERSION));
+        root.insert("ports", std::move(ports));
+
+        const auto path = installed.build_history_path();
+        const auto temp_path = path + Strings::concat(".", get_process_id(), ".tmp");
+        std::error_code ec;
+        fs.create_directories(installed.vcpkg_dir(), ec);
+        if (!ec)
+        {
+            fs.write_contents(temp_path, Json::stringify(root, {}), ec);
+        }
+
+        if (!ec)
+        {
+            fs.rename(temp_path, path, ec);
+        }
+
+        if (ec)
+        {
+            Debug::print("Failed to update build history ", path, ": ", ec.message(), '\n');
+            fs.remove(temp_path, IgnoreErrors{});
+        }
+    }
+
+    void record_build(Filesystem& fs,
+                      const InstalledPaths& installed,
+                      const PackageSpec& spec,
+                      const BuildHistory::Entry& entry)
+    {
+        std::error_code ec;
+        fs.create_directories(installed.vcpkg_dir(), ec);
+        // the history is reloaded and saved under the lock, so that records other processes make are not lost
+        std::unique_ptr<IExclusiveFileLock> lock;
+        if (!ec)
+        {
+            lock = fs.take_exclusive_file_lock(installed.build_history_lock(), ec);
+        }
+
+        if (!lock)
+        {
+            Debug::print("Failed to lock build history ", installed.build_history_lock(), ": ", ec.message(), '\n');
+            return;
+        }
+
+        auto history = BuildHistory::load(fs, installed);
+        auto merged = entry;
+        if (merged.peak_rss_bytes == 0)
+        {
+            if (auto previous = history.get(spec).get())
+            {
+                merged.peak_rss_bytes = previous->peak_rss_bytes;
+            }
+        }
+
+        history.set(spec, merged);
+        history.save(fs, installed);
+    }
+
+    uint64_t get_package_size(const Filesystem& fs, const Path& package_dir)
+    {
+        uint64_t package_size = 0;
+        for (auto&& file : fs.get_regular_files_recursive(package_dir, IgnoreErrors{}))
+        {
+            std::error_code ec;
+            const auto size = fs.file_size(file, ec);
+            if (!ec) package_size += size;
+        }
+
+        return package_size;
+    }
+
+    // the actions in `actions` depending on each action, by index
+    static std::vector<std::vector<size_t>> get_dependents(View<Dependencies::InstallPlanAction> actions)
+    {
+        std::unordered_map<PackageSpec, size_t> indices;
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            indices.emplace(actions[i].spec, i);
+        }
+
+        std::vector<std::vector<size_t>> dependents(actions.size());
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            for (auto&& dependency : actions[i].package_dependencies)
+            {
+                const auto it = indices.find(dependency);
+                if (it != indices.end() && it->second != i)
+                {
+                    dependents[it->second].push_back(i);
+                }
+            }
+        }
+
+        for (auto&& d : dependents)
+        {
+            Util::sort_unique_erase(d);
+        }
+
+        return dependents;
+    }
+
+    static std::vector<uint64_t> compute_remaining_critical_paths(View<Dependencies::InstallPlanAction> actions,
+                                                                  const std::vector<std::vector<size_t>>& dependents,
+                                                                  const BuildHistory& history)
+    {
+        // dependents come after their dependencies, so theirs are known by the time they are needed
+        std::vector<uint64_t> remaining(actions.size());
+        for (size_t i = actions.size(); i-- != 0;)
+        {
+            uint64_t slowest_dependent = 0;
+            for (auto dependent : dependents[i])
+            {
+                slowest_dependent = std::max(slowest_dependent, remaining[dependent]);
+            }
+
+            const auto& action = actions[i];
+            const uint64_t own = action.plan_type == Dependencies::InstallPlanType::BUILD_AND_INSTALL
+                                     ? history.estimated_build_time_us(action.spec)
+                                     : 0;
+            remaining[i] = own + slowest_dependent;
+        }
+
+        return remaining;
+    }
+
+    std::vector<uint64_t> remaining_critical_paths(View<Dependencies::InstallPlanAction> actions,
+                                                   const BuildHistory& history)
+    {
+        return compute_remaining_critical_paths(actions, get_dependents(actions), history);
+    }
+
+    void order_by_critical_path(std::vector<Dependencies::InstallPlanAction>& actions, const BuildHistory& history)
+    {
+        const auto dependents = get_dependents(actions);
+        const auto remaining = compute_remaining_critical_paths(actions, dependents, history);
+        std::vector<size_t> unmet_dependencies(actions.size());
+        for (auto&& d : dependents)
+        {
+            for (auto dependent : d)
+            {
+                ++unmet_dependencies[dependent];
+            }
+        }
+
+        // ties keep the plan's order
+        const auto runs_later = [&](size_t lhs, size_t rhs) {
+            return remaining[lhs] != remaining[rhs] ? remaining[lhs] < remaining[rhs] : lhs > rhs;
+        };
+
+        std::priority_queue<size_t, std::vector<size_t>, decltype(runs_later)> ready(runs_later);
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            if (unmet_dependencies[i] == 0)
+            {
+                ready.push(i);
+            }
+        }
+
+        std::vector<Dependencies::InstallPlanAction> ordered;
+        ordered.reserve(actions.size());
+        while (!ready.empty())
+        {
+            const auto next = ready.top();
+            ready.pop();
+            ordered.push_back(std::move(actions[next]));
+            for (auto dependent : dependents[next])
+            {
+                if (--unmet_dependencies[dependent] == 0)
+                {
+                    ready.push(dependent);
+                }
+            }
+        }
+
+        Checks::check_exit(VCPKG_LINE_INFO, ordered.size() == actions.size());
+        actions = std::move(ordered);
+    }
+}
@@ -1,6 +1,7 @@
 #include <vcpkg/base/hash.h>
 #include <vcpkg/base/optional.h>
 #include <vcpkg/base/span.h>
+#include <vcpkg/base/system.h>
 #include <vcpkg/base/system.print.h>
 #include <vcpkg/base/system.process.h>
 #include <vcpkg/base/util.h>
@@ -195,7 +196,9 @@ endfunction()
                             "\")\n");
         }
 
-        auto tags_path = paths.buildtrees() / Strings::concat(tag_extract_id++, ".vcpkg_tags.cmake");
+        // numbered per process, since other processes may share the buildtrees
+        auto tags_path =
+            paths.buildtrees() / Strings::concat(get_process_id(), '-', tag_extract_id++, ".vcpkg_tags.cmake");
         fs.write_contents_and_dirs(tags_path, extraction_file, VCPKG_LINE_INFO);
         return tags_path;
     }
@@ -243,7 +246,8 @@ endfunction()
                 extraction_file, "vcpkg_get_dep_info(", spec.name(), " ", emitted_triplets[spec.triplet()], ")\n");
         }
 
-        auto dep_info_path = paths.buildtrees() / Strings::concat(dep_info_id++, ".vcpkg_dep_info.cmake");
+        auto dep_info_path =
+            paths.buildtrees() / Strings::concat(get_process_id(), '-', dep_info_id++, ".vcpkg_dep_info.cmake");
         fs.write_contents_and_dirs(dep_info_path, extraction_file, VCPKG_LINE_INFO);
         return dep_info_path;
     }
@@ -258,54 +262,101 @@ endfunction()
 
         const auto cmd_launch_cmake = vcpkg::make_cmake_cmd(paths, script_path, {});
 
-        std::vector<std::string> lines;
-        auto const exit_code = cmd_execute_and_stream_lines(
-            cmd_launch_cmake,
-            [&](StringView sv) { lines.emplace_back(sv.begin(), sv.end()); },
-            default_working_directory);
-
-        Checks::check_exit(VCPKG_LINE_INFO, exit_code == 0, exit_code == 0 ? "" : Strings::join("\n", lines));
-
-        const auto end = lines.cend();
-
-        auto port_start = std::find(lines.cbegin(), end, PORT_START_GUID);
-        auto port_end = std::find(port_start, end, PORT_END_GUID);
-        Checks::check_exit(VCPKG_LINE_INFO,
-                           port_start != end && port_end != end,
-                           "Failed to parse CMake console output to locate port start/end markers");
-
-        for (auto var_itr = vars.begin(); port_start != end && var_itr != vars.end(); ++var_itr)
+        // The output is parsed as it streams in: lines between a block's start and end markers are variables for
+        // the current port, and every port start marker moves on to the next entry of vars. The raw output is only
+        // kept for reporting failures.
+        enum class ParseState
         {
-            auto block_start = std::find(port_start, port_end, BLOCK_START_GUID);
-            Checks::check_exit(VCPKG_LINE_INFO,
-                               block_start != port_end,
-                               "Failed to parse CMake console output to locate block start marker");
-            auto block_end = std::find(++block_start, port_end, BLOCK_END_GUID);
+            OutsidePort,
+            InPort,
+            InBlock,
+        };
 
-            while (block_start != port_end)
-            {
-                while (block_start != block_end)
+        auto state = ParseState::OutsidePort;
+        size_t port_count = 0;
+        bool saw_port_end = false;
+        bool port_has_block = false;
+        bool missing_block = false;
+        std::string output;
+        std::string malformed_line;
+        auto const exit_code = cmd_execute_and_stream_lines(
+            cmd_launch_cmake,
+            [&](StringView line) {
+                Strings::append(output, line, '\n');
+                if (!malformed_line.empty())
                 {
-                    const std::string& line = *block_start;
-
-                    std::vector<std::string> s = Strings::split(line, '=');
-                    Checks::check_exit(VCPKG_LINE_INFO,
-                                       s.size() == 1 || s.size() == 2,
-                                       "Expected format is [VARIABLE_NAME=VARIABLE_VALUE], but was [%s]",
-                                       line);
-
-                    var_itr->emplace_back(std::move(s[0]), s.size() == 1 ? "" : std::move(s[1]));
-
-                    ++block_start;
+                    return;
                 }
 
-                block_start = std::find(block_end, port_end, BLOCK_START_GUID);
-                block_end = std::find(block_start, port_end, BLOCK_END_GUID);
-            }
+                switch (state)
+                {
+                    case ParseState::OutsidePort:
+                        if (line == PORT_START_GUID)
+                        {
+                            state = ParseState::InPort;
+                            port_has_block = false;
+                            ++port_count;
+                        }
+                        break;
+                    case ParseState::InPort:
+                        if (line == BLOCK_START_GUID)
+                        {
+                            state = ParseState::InBlock;
+                            port_has_block = true;
+                        }
+                        else if (line == PORT_END_GUID)
+                        {
+                            state = ParseState::OutsidePort;
+                            missing_block |= port_count <= vars.size() && !port_has_block;
+                            saw_port_end = true;
+                        }
+                        break;
+                    case ParseState::InBlock:
+                        if (line == BLOCK_END_GUID)
+                        {
+                            state = ParseState::InPort;
+                        }
+                        else if (line == PORT_END_GUID)
+                        {
+                            state = ParseState::OutsidePort;
+                            saw_port_end = true;
+                        }
+                        else if (port_count <= vars.size())
+                        {
+                            // Expected format is [VARIABLE_NAME=VARIABLE_VALUE]; runs of '=' count as one separator
+                            // and leading or trailing '=' are ignored, as with Strings::split
+                            const auto is_eq = [](char ch) { return ch == '='; };
+                            const auto is_not_eq = [](char ch) { return ch != '='; };
+                            const auto name_first = std::find_if(line.begin(), line.end(), is_not_eq);
+                            const auto name_last = std::find_if(name_first, line.end(), is_eq);
+                            const auto value_first = std::find_if(name_last, line.end(), is_not_eq);
+                            const auto value_last = std::find_if(value_first, line.end(), is_eq);
+                            if (name_first == line.end() ||
+                                std::find_if(value_last, line.end(), is_not_eq) != line.end())
+                            {
+                                malformed_line = line.to_string();
+                                return;
+                            }
+
+                            vars[port_count - 1].emplace_back(std::string(name_first, name_last),
+                                                              std::string(value_first, value_last));
+                        }
+                        break;
+                    default: Checks::unreachable(VCPKG_LINE_INFO);
+                }
+            },
+            default_working_directory);
 
-            port_start = std::find(port_end, end, PORT_START_GUID);
-            port_end = std::find(port_start, end, PORT_END_GUID);
-        }
+        Checks::check_exit(VCPKG_LINE_INFO, exit_code == 0, exit_code == 0 ? "" : output);
+        Checks::check_exit(VCPKG_LINE_INFO,
+                           malformed_line.empty(),
+                           "Expected format is [VARIABLE_NAME=VARIABLE_VALUE], but was [%s]",
+                           malformed_line);
+        Checks::check_exit(VCPKG_LINE_INFO,
+                           port_count != 0 && saw_port_end,
+                           "Failed to parse CMake console output to locate port start/end markers");
+        Checks::check_exit(
+            VCPKG_LINE_INFO, !missing_block, "Failed to parse CMake console output to locate block start marker");
     }
 
     void TripletCMakeVarProvider::load_generic_triplet_vars(Triplet triplet) const
@@ -0,0 +1,157 @@
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/json.h>
+#include <vcpkg/base/system.h>
+#include <vcpkg/base/system.print.h>
+#include <vcpkg/base/system.process.h>
+
+#include <vcpkg/archives.h>
+#include <vcpkg/commands.build-worker.h>
+#include <vcpkg/help.h>
+#include <vcpkg/vcpkgcmdarguments.h>
+#include <vcpkg/vcpkgpaths.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace vcpkg::Commands::BuildWorker
+{
+    const CommandStructure COMMAND_STRUCTURE = {
+        Strings::format("Builds the job bundle read from stdin, as sent by `install --%s`, and pushes the package to "
+                        "the binary cache.\n%s",
+                        VcpkgCmdArguments::BUILD_WORKER_ARG,
+                        create_example_string("x-build-worker < job.tar.gz")),
+        0,
+        0,
+        {},
+        nullptr,
+    };
+
+    static std::string read_stdin()
+    {
+#if defined(_WIN32)
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        std::string contents;
+        char buffer[65536];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), stdin)) != 0)
+        {
+            contents.append(buffer, read);
+        }
+
+        Checks::check_exit(VCPKG_LINE_INFO, !ferror(stdin), "Error: failed to read the job bundle from stdin");
+        return contents;
+    }
+
+    static std::string get_job_string(const Json::Object& job, StringView field)
+    {
+        const auto value = job.get(field);
+        Checks::check_exit(VCPKG_LINE_INFO,
+                           value && value->is_string(),
+                           "Error: the job bundle's job.json has no string field \"%s\"",
+                           field);
+        return value->string().to_string();
+    }
+
+    void perform_and_exit(const VcpkgCmdArguments& args, const VcpkgPaths& paths)
+    {
+        (void)args.parse_arguments(COMMAND_STRUCTURE);
+
+        auto& fs = paths.get_filesystem();
+        const auto job_root = paths.buildtrees() / "x-build-worker" / std::to_string(get_process_id());
+        const auto job_dir = job_root / "job";
+        fs.remove_all(job_root, VCPKG_LINE_INFO);
+        fs.create_directories(job_root, VCPKG_LINE_INFO);
+        fs.write_contents(job_root / "job.tar.gz", read_stdin(), VCPKG_LINE_INFO);
+        extract_archive(paths, job_root / "job.tar.gz", job_dir);
+
+        const auto job_value = Json::parse_file(VCPKG_LINE_INFO, fs, job_dir / "job.json").first;
+        Checks::check_exit(
+            VCPKG_LINE_INFO, job_value.is_object(), "Error: the job bundle's job.json must contain an object");
+        const auto& job = job_value.object();
+        const auto spec = get_job_string(job, "spec");
+        const auto packages = job.get("packages");
+        Checks::check_exit(VCPKG_LINE_INFO,
+                           packages && packages->is_array(),
+                           "Error: the job bundle's job.json has no array field \"packages\"");
+
+        // The package is installed into a scratch tree so that nothing installed on this machine affects the build.
+        // Its dependencies are restored from the binary cache, where the requester has already put them. Every
+        // package is named with the features the requester resolved, and the install stops before building anything
+        // if an ABI differs from the requester's, since the requester could not restore the result.
+        Command install{get_exe_path_of_current_process()};
+        install.string_arg("install");
+        for (auto&& package : packages->array())
+        {
+            Checks::check_exit(VCPKG_LINE_INFO,
+                               package.is_object(),
+                               "Error: the job bundle's job.json \"packages\" must contain objects");
+            const auto package_spec = get_job_string(package.object(), "spec");
+            // "name[features]:triplet" is expected as "name:triplet"
+            auto abi_spec = package_spec;
+            const auto features_begin = abi_spec.find('[');
+            if (features_begin != std::string::npos)
+            {
+                abi_spec.erase(features_begin, abi_spec.find(']') + 1 - features_begin);
+            }
+
+            install.string_arg(package_spec)
+                .string_arg(
+                    Strings::concat("--x-expect-abi=", abi_spec, '=', get_job_string(package.object(), "abi")));
+        }
+
+        install.string_arg(Strings::concat("--", VcpkgCmdArguments::VCPKG_ROOT_DIR_ARG, '=', paths.root))
+            .string_arg(Strings::concat("--", VcpkgCmdArguments::INSTALL_ROOT_DIR_ARG, '=', job_root / "installed"))
+            .string_arg(Strings::concat("--", VcpkgCmdArguments::PACKAGES_ROOT_DIR_ARG, '=', job_root / "packages"))
+            .string_arg(
+                Strings::concat("--", VcpkgCmdArguments::BUILDTREES_ROOT_DIR_ARG, '=', job_root / "buildtrees"))
+            .string_arg(Strings::concat("--", VcpkgCmdArguments::OVERLAY_PORTS_ARG, '=', job_dir / "ports"))
+            .string_arg(Strings::concat("--", VcpkgCmdArguments::OVERLAY_TRIPLETS_ARG, '=', job_dir / "triplets"))
+            .string_arg(Strings::concat(
+                "--", VcpkgCmdArguments::HOST_TRIPLET_ARG, '=', get_job_string(job, "host-triplet")));
+        // this worker's own overlays provide the dependencies the requester had already installed; the install runs
+        // from the job directory, so they must be absolute
+        for (auto&& overlay_ports : args.overlay_ports)
+        {
+            install.string_arg(Strings::concat(
+                "--", VcpkgCmdArguments::OVERLAY_PORTS_ARG, '=', paths.original_cwd / overlay_ports));
+        }
+
+        for (auto&& overlay_triplets : args.overlay_triplets)
+        {
+            install.string_arg(Strings::concat(
+                "--", VcpkgCmdArguments::OVERLAY_TRIPLETS_ARG, '=', paths.original_cwd / overlay_triplets));
+        }
+
+        // the requester's binary sources arrive in VCPKG_BINARY_SOURCES, which the install inherits
+        vcpkg::printf("Building %s with ABI %s\n", spec, get_job_string(job, "abi"));
+        // the install is a top-level invocation, which hands its own recursion data to the processes it starts
+        set_environment_variable(VcpkgCmdArguments::RECURSIVE_DATA_ENV, nullopt);
+        // run from the job directory so that no manifest is found
+        const int exit_code = cmd_execute(install, WorkingDirectory{job_dir});
+        if (exit_code != 0)
+        {
+            // the requester only sees this output, so include the build's logs
+            std::error_code ec;
+            for (auto&& log : fs.get_regular_files_recursive(job_root / "buildtrees", ec))
+            {
+                if (log.extension() != ".log") continue;
+                vcpkg::printf("\n-- %s:\n", log);
+                vcpkg::print2(fs.read_contents(log, ec));
+            }
+        }
+
+        fs.remove_all(job_root, IgnoreErrors{});
+        Checks::exit_with_code(VCPKG_LINE_INFO, exit_code == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    void BuildWorkerCommand::perform_and_exit(const VcpkgCmdArguments& args, const VcpkgPaths& paths) const
+    {
+        BuildWorker::perform_and_exit(args, paths);
+    }
+}
@@ -6,6 +6,7 @@
 #include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.h>
 #include <vcpkg/base/system.print.h>
+#include <vcpkg/base/system.process.h>
 #include <vcpkg/base/util.h>
 
 #include <vcpkg/binarycaching.h>
@@ -21,6 +22,7 @@
 #include <vcpkg/paragraphs.h>
 #include <vcpkg/platform-expression.h>
 #include <vcpkg/portfileprovider.h>
+#include <vcpkg/tools.h>
 #include <vcpkg/vcpkgcmdarguments.h>
 #include <vcpkg/vcpkglib.h>
 #include <vcpkg/vcpkgpaths.h>
@@ -32,6 +34,34 @@ namespace
     using namespace vcpkg::Build;
 
     const Path readme_dot_log = "readme.log";
+    const Path logs_dot_tar_dot_zst = "logs.tar.zst";
+
+    // At most the last 100 lines of the log at `path`, read from no more than its last 64 KiB.
+    std::string read_log_tail(const Filesystem& fs, const Path& path)
+    {
+        constexpr uint64_t max_tail_bytes = 64 * 1024;
+        constexpr size_t max_tail_lines = 100;
+        const auto size = fs.file_size(path, VCPKG_LINE_INFO);
+        const auto tail_bytes = std::min(size, max_tail_bytes);
+        auto file = fs.open_for_read(path, VCPKG_LINE_INFO);
+        file.seek(size - tail_bytes, SEEK_SET);
+        std::string tail(static_cast<size_t>(tail_bytes), '\0');
+        tail.resize(file.read(&tail[0], 1, tail.size()));
+        // the first line is partial unless the whole log was read
+        size_t begin = tail.size() == size ? 0 : tail.find('\n') + 1;
+        size_t lines = 0;
+        for (size_t i = tail.size(); i > begin; --i)
+        {
+            if (tail[i - 1] == '\n' && i != tail.size() && ++lines == max_tail_lines)
+            {
+                begin = i;
+                break;
+            }
+        }
+
+        tail.erase(0, begin);
+        return tail;
+    }
 
     struct CiBuildLogsRecorder final : IBuildLogsRecorder
     {
@@ -63,10 +93,30 @@ namespace
             }
             else
             {
+                // the full logs are compressed, since large ports produce hundreds of MB of them; the end of each
+                // log, where the failure usually is, stays readable next to the archive
+                vcpkg::Command tar{paths.get_tool_exe(Tools::CMAKE)};
+                tar.string_arg("-E").string_arg("tar").string_arg("cf").string_arg(target_path / logs_dot_tar_dot_zst);
+                tar.string_arg("--zstd").string_arg("--");
+                for (const Path& p : children)
+                {
+                    tar.string_arg(p.filename());
+                }
+
+                const bool compressed = cmd_execute_clean(tar, WorkingDirectory{source_path}) == 0;
                 for (const Path& p : children)
                 {
-                    filesystem.copy_file(
-                        p, target_path / p.filename(), CopyOptions::overwrite_existing, VCPKG_LINE_INFO);
+                    if (compressed)
+                    {
+                        filesystem.write_contents(target_path / Strings::concat(p.stem(), ".tail.log"),
+                                                  read_log_tail(filesystem, p),
+                                                  VCPKG_LINE_INFO);
+                    }
+                    else
+                    {
+                        filesystem.copy_file(
+                            p, target_path / p.filename(), CopyOptions::overwrite_existing, VCPKG_LINE_INFO);
+                    }
                 }
             }
         }
@@ -94,6 +144,7 @@ namespace vcpkg::Commands::CI
     static constexpr StringLiteral OPTION_FAILURE_LOGS = "failure-logs";
     static constexpr StringLiteral OPTION_XUNIT = "x-xunit";
     static constexpr StringLiteral OPTION_RANDOMIZE = "x-randomize";
+    static constexpr StringLiteral OPTION_QUIET_BUILD = "x-quiet-build";
     static constexpr StringLiteral OPTION_OUTPUT_HASHES = "output-hashes";
     static constexpr StringLiteral OPTION_PARENT_HASHES = "parent-hashes";
     static constexpr StringLiteral OPTION_SKIPPED_CASCADE_COUNT = "x-skipped-cascade-count";
@@ -109,9 +160,10 @@ namespace vcpkg::Commands::CI
          {OPTION_SKIPPED_CASCADE_COUNT,
           "Asserts that the number of --exclude and supports skips exactly equal this number"}}};
 
-    static constexpr std::array<CommandSwitch, 2> CI_SWITCHES = {{
+    static constexpr std::array<CommandSwitch, 3> CI_SWITCHES = {{
         {OPTION_DRY_RUN, "Print out plan without execution"},
         {OPTION_RANDOMIZE, "Randomize the install order"},
+        {OPTION_QUIET_BUILD, "Only print status lines while building, and the end of the log if a build fails"},
     }};
 
     const CommandStructure COMMAND_STRUCTURE = {
@@ -612,6 +664,13 @@ namespace vcpkg::Commands::CI
         }
 
         reduce_action_plan(action_plan, split_specs->known, parent_hashes);
+        if (Util::Sets::contains(options.switches, OPTION_QUIET_BUILD))
+        {
+            for (auto&& action : action_plan.install_actions)
+            {
+                action.build_options.build_output = Build::BuildOutput::TAIL;
+            }
+        }
 
         vcpkg::printf("Time to determine pass/fail: %s\n", timer.elapsed());
 
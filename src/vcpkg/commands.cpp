@@ -5,6 +5,7 @@
 #include <vcpkg/commands.add-version.h>
 #include <vcpkg/commands.add.h>
 #include <vcpkg/commands.autocomplete.h>
+#include <vcpkg/commands.build-worker.h>
 #include <vcpkg/commands.buildexternal.h>
 #include <vcpkg/commands.cache.h>
 #include <vcpkg/commands.check-support.h>
@@ -84,6 +85,7 @@ namespace vcpkg::Commands
         static const AddCommand add{};
         static const AddVersion::AddVersionCommand add_version{};
         static const Autocomplete::AutocompleteCommand autocomplete{};
+        static const BuildWorker::BuildWorkerCommand build_worker{};
         static const Cache::CacheCommand cache{};
         static const CIClean::CICleanCommand ciclean{};
         static const CIVerifyVersions::CIVerifyVersionsCommand ci_verify_versions{};
@@ -128,6 +130,7 @@ namespace vcpkg::Commands
             {"update", &update},
             {"use", &use},
             {"x-add-version", &add_version},
+            {"x-build-worker", &build_worker},
             {"x-ci-clean", &ciclean},
             {"x-ci-verify-versions", &ci_verify_versions},
             {"x-history", &porthistory},
@@ -13,18 +13,15 @@ namespace vcpkg::Commands::Owns
                             const std::string& file_substr,
                             const StatusParagraphs& status_db)
     {
-        const auto installed_files = get_installed_files(fs, installed, status_db);
-        for (auto&& pgh_and_file : installed_files)
+        for (auto&& pgh_and_listfile : get_installed_listfiles(fs, installed, status_db))
         {
-            const StatusParagraph& pgh = pgh_and_file.pgh;
-
-            for (const std::string& file : pgh_and_file.files)
-            {
-                if (file.find(file_substr) != std::string::npos)
+            const StatusParagraph& pgh = *pgh_and_listfile.pgh;
+            pgh_and_listfile.listfile.for_each([&](StringView file) {
+                if (file.back() != '/' && Strings::contains(file, file_substr))
                 {
                     print2(pgh.package.displayname(), ": ", file, '\n');
                 }
-            }
+            });
         }
     }
     const CommandStructure COMMAND_STRUCTURE = {
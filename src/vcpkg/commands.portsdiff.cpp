@@ -1,11 +1,14 @@
 #include <vcpkg/base/sortedvector.h>
+#include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.print.h>
 #include <vcpkg/base/system.process.h>
 #include <vcpkg/base/util.h>
 
 #include <vcpkg/commands.portsdiff.h>
+#include <vcpkg/paragraphparser.h>
 #include <vcpkg/help.h>
 #include <vcpkg/paragraphs.h>
+#include <vcpkg/sourceparagraph.h>
 #include <vcpkg/tools.h>
 #include <vcpkg/vcpkgcmdarguments.h>
 #include <vcpkg/vcpkgpaths.h>
@@ -13,17 +16,6 @@
 
 namespace vcpkg::Commands::PortsDiff
 {
-    struct UpdatedPort
-    {
-        static bool compare_by_name(const UpdatedPort& left, const UpdatedPort& right)
-        {
-            return left.port < right.port;
-        }
-
-        std::string port;
-        VersionDiff version_diff;
-    };
-
     template<class T>
     struct SetElementPresence
     {
@@ -67,6 +59,21 @@ namespace vcpkg::Commands::PortsDiff
         return output;
     }
 
+    PortChanges find_port_changes(const std::map<std::string, Version>& previous_names_and_versions,
+                                  const std::map<std::string, Version>& current_names_and_versions)
+    {
+        // Already sorted, so set_difference can work on std::vector too
+        const std::vector<std::string> current_ports = Util::extract_keys(current_names_and_versions);
+        const std::vector<std::string> previous_ports = Util::extract_keys(previous_names_and_versions);
+
+        SetElementPresence<std::string> setp = SetElementPresence<std::string>::create(current_ports, previous_ports);
+        PortChanges changes;
+        changes.added_ports = std::move(setp.only_left);
+        changes.removed_ports = std::move(setp.only_right);
+        changes.updated_ports = find_updated_ports(setp.both, previous_names_and_versions, current_names_and_versions);
+        return changes;
+    }
+
     static void do_print_name_and_version(const std::vector<std::string>& ports_to_print,
                                           const std::map<std::string, Version>& names_and_versions)
     {
@@ -77,38 +84,157 @@ namespace vcpkg::Commands::PortsDiff
         }
     }
 
-    static std::map<std::string, Version> read_ports_from_commit(const VcpkgPaths& paths,
-                                                                 const std::string& git_commit_id)
+    // the tree object of each port directory at `git_commit_id`, by directory name
+    static std::map<std::string, std::string> read_port_trees_from_commit(const VcpkgPaths& paths,
+                                                                           const std::string& git_commit_id)
     {
-        std::error_code ec;
-        auto& fs = paths.get_filesystem();
         const auto dot_git_dir = paths.root / ".git";
         const auto ports_dir_name = paths.builtin_ports_directory().filename();
-        const auto temp_checkout_path = paths.root / Strings::format("%s-%s", ports_dir_name, git_commit_id);
-        fs.create_directory(temp_checkout_path, ec);
-        const auto checkout_this_dir =
-            Strings::format(R"(.\%s)", ports_dir_name); // Must be relative to the root of the repository
-
-        auto cmd = paths.git_cmd_builder(dot_git_dir, temp_checkout_path)
-                       .string_arg("checkout")
-                       .string_arg(git_commit_id)
-                       .string_arg("-f")
-                       .string_arg("-q")
-                       .string_arg("--")
-                       .string_arg(checkout_this_dir)
-                       .string_arg(".vcpkg-root");
-        cmd_execute_and_capture_output(cmd, default_working_directory, get_clean_environment());
-        cmd_execute_and_capture_output(paths.git_cmd_builder(dot_git_dir, temp_checkout_path).string_arg("reset"),
-                                       default_working_directory,
-                                       get_clean_environment());
-        const auto ports_at_commit = Paragraphs::load_overlay_ports(fs, temp_checkout_path / ports_dir_name);
+        auto cmd = paths.git_cmd_builder(dot_git_dir, dot_git_dir)
+                       .string_arg("ls-tree")
+                       .string_arg("-d")
+                       .string_arg(Strings::concat(git_commit_id, ':', ports_dir_name));
+        const auto output = cmd_execute_and_capture_output(cmd, default_working_directory, get_clean_environment());
+        Checks::check_exit(VCPKG_LINE_INFO,
+                           output.exit_code == 0,
+                           "Error: failed to list the ports at commit %s:\n%s",
+                           git_commit_id,
+                           output.output);
+
+        std::map<std::string, std::string> trees;
+        for (auto&& line : Strings::split(output.output, '\n'))
+        {
+            // <mode> SP <type> SP <object> TAB <file>
+            const auto tab = line.find('\t');
+            const auto object = line.rfind(' ', tab);
+            Checks::check_exit(VCPKG_LINE_INFO,
+                               tab != std::string::npos && object != std::string::npos,
+                               "Error: unexpected output from `%s`:\n%s",
+                               cmd.command_line(),
+                               line);
+            trees.emplace(line.substr(tab + 1), line.substr(object + 1, tab - object - 1));
+        }
+
+        return trees;
+    }
+
+    std::string make_port_files_batch(View<std::pair<std::string, std::string>> port_trees)
+    {
+        std::string batch;
+        for (auto&& port : port_trees)
+        {
+            Strings::append(batch, port.second, ":vcpkg.json\n", port.second, ":CONTROL\n");
+        }
+
+        return batch;
+    }
+
+    std::map<std::string, Version> parse_port_files_batch(View<std::pair<std::string, std::string>> port_trees,
+                                                          StringView batch_output,
+                                                          std::vector<std::unique_ptr<ParseControlErrorInfo>>& errors)
+    {
+        auto position = batch_output.begin();
+        // each object is "<object> missing" or "<object> <type> <size>", a line with its contents, and a line break
+        const auto next_object = [&]() -> Optional<std::string> {
+            const auto header_end = std::find(position, batch_output.end(), '\n');
+            Checks::check_exit(VCPKG_LINE_INFO,
+                               header_end != batch_output.end(),
+                               "Error: `git cat-file --batch` stopped early:\n%s",
+                               batch_output);
+            const StringView header{position, header_end};
+            position = header_end + 1;
+            if (Strings::ends_with(header, " missing"))
+            {
+                return nullopt;
+            }
+
+            const auto size_begin = std::find(header.rbegin(), header.rend(), ' ').base();
+            const auto maybe_size = Strings::strto<long long>(StringView{size_begin, header.end()});
+            const auto size = maybe_size.get();
+            Checks::check_exit(VCPKG_LINE_INFO,
+                               size && *size >= 0 && *size < batch_output.end() - position,
+                               "Error: unexpected output from `git cat-file --batch`:\n%s",
+                               header);
+            std::string contents(position, position + *size);
+            position += *size + 1;
+            return contents;
+        };
+
         std::map<std::string, Version> names_and_versions;
-        for (auto&& port : ports_at_commit)
+        for (auto&& port : port_trees)
         {
-            const auto& core_pgh = *port.source_control_file->core_paragraph;
-            names_and_versions.emplace(core_pgh.name, Version(core_pgh.raw_version, core_pgh.port_version));
+            // ports without a manifest have a CONTROL file
+            const auto maybe_manifest = next_object();
+            const auto maybe_control = next_object();
+            const bool is_manifest = maybe_manifest.has_value();
+            const auto text = is_manifest ? maybe_manifest.get() : maybe_control.get();
+            if (!text)
+            {
+                auto error_info = std::make_unique<ParseControlErrorInfo>();
+                error_info->name = port.first;
+                error_info->error = "Failed to find either a CONTROL file or vcpkg.json file.";
+                errors.push_back(std::move(error_info));
+                continue;
+            }
+
+            auto maybe_scf = Paragraphs::try_load_port_text(*text, port.first, is_manifest);
+            if (auto scf = maybe_scf.get())
+            {
+                const auto& core_pgh = *(*scf)->core_paragraph;
+                names_and_versions.emplace(core_pgh.name, Version(core_pgh.raw_version, core_pgh.port_version));
+            }
+            else
+            {
+                errors.push_back(std::move(maybe_scf).error());
+            }
         }
-        fs.remove_all(temp_checkout_path, VCPKG_LINE_INFO);
+
+        return names_and_versions;
+    }
+
+    // Reads the versions of the ports in `port_trees`, a port name and its tree object each, straight from the git
+    // object store with a single `git cat-file --batch`: only their vcpkg.json or CONTROL files are read, and
+    // nothing is checked out.
+    static std::map<std::string, Version> read_versions_from_trees(
+        const VcpkgPaths& paths, const std::vector<std::pair<std::string, std::string>>& port_trees)
+    {
+        if (port_trees.empty())
+        {
+            return {};
+        }
+
+        auto& fs = paths.get_filesystem();
+        const auto dot_git_dir = paths.root / ".git";
+        const auto batch_path = paths.buildtrees() / Strings::concat("portsdiff-", get_process_id(), ".txt");
+        fs.create_directories(paths.buildtrees(), VCPKG_LINE_INFO);
+        fs.write_contents(batch_path, make_port_files_batch(port_trees), VCPKG_LINE_INFO);
+        const auto output = cmd_execute_and_capture_output_with_input_file(
+            paths.git_cmd_builder(dot_git_dir, dot_git_dir).string_arg("cat-file").string_arg("--batch"),
+            batch_path,
+            default_working_directory,
+            get_clean_environment());
+        fs.remove(batch_path, IgnoreErrors{});
+        Checks::check_exit(
+            VCPKG_LINE_INFO, output.exit_code == 0, "Error: failed to read the ports' files:\n%s", output.output);
+
+        std::vector<std::unique_ptr<ParseControlErrorInfo>> errors;
+        auto names_and_versions = parse_port_files_batch(port_trees, output.output, errors);
+        if (!errors.empty())
+        {
+            if (Debug::g_debugging)
+            {
+                print_error_message(errors);
+            }
+            else
+            {
+                for (auto&& error : errors)
+                {
+                    print2(Color::warning, "Warning: an error occurred while parsing '", error->name, "'\n");
+                }
+                print2(Color::warning, "Use '--debug' to get more information about the parse failures.\n\n");
+            }
+        }
+
         return names_and_versions;
     }
 
@@ -145,35 +271,45 @@ namespace vcpkg::Commands::PortsDiff
         check_commit_exists(paths, git_commit_id_for_current_snapshot);
         check_commit_exists(paths, git_commit_id_for_previous_snapshot);
 
-        const std::map<std::string, Version> current_names_and_versions =
-            read_ports_from_commit(paths, git_commit_id_for_current_snapshot);
-        const std::map<std::string, Version> previous_names_and_versions =
-            read_ports_from_commit(paths, git_commit_id_for_previous_snapshot);
+        // ports whose trees are the same in both commits are unchanged, so only the others need to be read
+        const auto current_trees = read_port_trees_from_commit(paths, git_commit_id_for_current_snapshot);
+        const auto previous_trees = read_port_trees_from_commit(paths, git_commit_id_for_previous_snapshot);
+        const auto changed_trees = [](const std::map<std::string, std::string>& trees,
+                                      const std::map<std::string, std::string>& other_trees) {
+            std::vector<std::pair<std::string, std::string>> changed;
+            for (auto&& port : trees)
+            {
+                const auto other = other_trees.find(port.first);
+                if (other == other_trees.end() || other->second != port.second)
+                {
+                    changed.push_back(port);
+                }
+            }
 
-        // Already sorted, so set_difference can work on std::vector too
-        const std::vector<std::string> current_ports = Util::extract_keys(current_names_and_versions);
-        const std::vector<std::string> previous_ports = Util::extract_keys(previous_names_and_versions);
+            return changed;
+        };
 
-        const SetElementPresence<std::string> setp =
-            SetElementPresence<std::string>::create(current_ports, previous_ports);
+        const std::map<std::string, Version> current_names_and_versions =
+            read_versions_from_trees(paths, changed_trees(current_trees, previous_trees));
+        const std::map<std::string, Version> previous_names_and_versions =
+            read_versions_from_trees(paths, changed_trees(previous_trees, current_trees));
 
-        const std::vector<std::string>& added_ports = setp.only_left;
+        const PortChanges changes = find_port_changes(previous_names_and_versions, current_names_and_versions);
+        const std::vector<std::string>& added_ports = changes.added_ports;
         if (!added_ports.empty())
         {
             vcpkg::printf("\nThe following %zd ports were added:\n", added_ports.size());
             do_print_name_and_version(added_ports, current_names_and_versions);
         }
 
-        const std::vector<std::string>& removed_ports = setp.only_right;
+        const std::vector<std::string>& removed_ports = changes.removed_ports;
         if (!removed_ports.empty())
         {
             vcpkg::printf("\nThe following %zd ports were removed:\n", removed_ports.size());
             do_print_name_and_version(removed_ports, previous_names_and_versions);
         }
 
-        const std::vector<std::string>& common_ports = setp.both;
-        const std::vector<UpdatedPort> updated_ports =
-            find_updated_ports(common_ports, previous_names_and_versions, current_names_and_versions);
+        const std::vector<UpdatedPort>& updated_ports = changes.updated_ports;
 
         if (!updated_ports.empty())
         {
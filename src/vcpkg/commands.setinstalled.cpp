@@ -43,7 +43,8 @@ namespace vcpkg::Commands::SetInstalled
                              Dependencies::ActionPlan action_plan,
                              DryRun dry_run,
                              const Optional<Path>& maybe_pkgsconfig,
-                             Triplet host_triplet)
+                             Triplet host_triplet,
+                             const Optional<std::string>& manifest_inputs_fingerprint)
     {
         auto& fs = paths.get_filesystem();
 
@@ -51,6 +52,7 @@ namespace vcpkg::Commands::SetInstalled
         Build::compute_all_abis(paths, action_plan, cmake_vars, {});
 
         std::set<std::string> all_abis;
+        const auto build_inputs = Install::collect_manifest_build_inputs(paths, action_plan.install_actions);
 
         std::vector<PackageSpec> user_requested_specs;
         for (const auto& action : action_plan.install_actions)
@@ -125,6 +127,11 @@ namespace vcpkg::Commands::SetInstalled
                                               Build::null_build_logs_recorder(),
                                               cmake_vars);
 
+        if (auto fingerprint = manifest_inputs_fingerprint.get())
+        {
+            Install::write_manifest_install_fingerprint(paths, *fingerprint, build_inputs);
+        }
+
         print2("\nTotal elapsed time: ", GlobalState::timer.to_string(), "\n\n");
 
         std::set<std::string> printed_usages;
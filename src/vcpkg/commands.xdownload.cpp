@@ -134,6 +134,18 @@ namespace vcpkg::Commands::X_Download
                 urls = it_urls->second;
             }
 
+            std::unique_ptr<IExclusiveFileLock> download_lock;
+            if (auto hash = sha.get())
+            {
+                download_lock = lock_download(fs, file, *hash);
+                // another process may have downloaded the file while we waited
+                if (fs.exists(file, IgnoreErrors{}) &&
+                    Hash::get_file_hash(VCPKG_LINE_INFO, fs, file, Hash::Algorithm::Sha512) == *hash)
+                {
+                    Checks::exit_success(VCPKG_LINE_INFO);
+                }
+            }
+
             download_manager.download_file(fs, urls, headers, file, sha);
             Checks::exit_success(VCPKG_LINE_INFO);
         }
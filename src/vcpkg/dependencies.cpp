@@ -1235,7 +1235,7 @@ namespace vcpkg::Dependencies
                 // mapping from feature name -> dependencies of this feature
                 std::map<std::string, std::vector<FeatureSpec>> deps;
 
-                bool is_less_than(const Version& new_ver) const;
+                bool is_less_than(const Version& new_ver, const VersionKeyCache& keys) const;
             };
 
             struct PackageNode
@@ -1301,6 +1301,8 @@ namespace vcpkg::Dependencies
             std::map<std::string, Version> m_overrides;
             // mapping from { package specifier -> node containing resolution information for that package }
             std::map<PackageSpec, PackageNode> m_graph;
+            // parsed versions, so that each version text is parsed only once no matter how often it is compared
+            VersionKeyCache m_version_keys;
 
             std::pair<const PackageSpec, PackageNode>& emplace_package(const PackageSpec& spec);
 
@@ -1323,6 +1325,11 @@ namespace vcpkg::Dependencies
 
             Optional<Version> dep_to_version(const std::string& name, const DependencyConstraint& dc);
 
+            // Walks the graph reachable from deps breadth first, loading each level's control files in parallel and
+            // its dependency information variables in a single batch. This only fills the providers' caches; the
+            // depth first walk afterwards still decides the resolved versions.
+            void prefetch_dependencies(View<const Dependency*> deps, const PackageSpec& toplevel);
+
             static std::string format_incomparable_versions_message(const PackageSpec& on,
                                                                     StringView from,
                                                                     const VersionSchemeInfo& current,
@@ -1382,32 +1389,10 @@ namespace vcpkg::Dependencies
             return it == vermap.end() ? nullptr : it->second;
         }
 
-        static VerComp compare_version_texts(VersionScheme sa, const Version& a, VersionScheme sb, const Version& b)
+        static VerComp compare_versions(
+            const VersionKeyCache& keys, VersionScheme sa, const Version& a, VersionScheme sb, const Version& b)
         {
-            if (sa == VersionScheme::String && sb == VersionScheme::String)
-            {
-                return int_to_vercomp(a.text().compare(b.text()));
-            }
-
-            if (sa == VersionScheme::Date && sb == VersionScheme::Date)
-            {
-                return compare(DateVersion::try_parse(a.text()).value_or_exit(VCPKG_LINE_INFO),
-                               DateVersion::try_parse(b.text()).value_or_exit(VCPKG_LINE_INFO));
-            }
-
-            if ((sa == VersionScheme::Semver || sa == VersionScheme::Relaxed) &&
-                (sb == VersionScheme::Semver || sb == VersionScheme::Relaxed))
-            {
-                return compare(DotVersion::try_parse(a.text(), sa).value_or_exit(VCPKG_LINE_INFO),
-                               DotVersion::try_parse(b.text(), sb).value_or_exit(VCPKG_LINE_INFO));
-            }
-
-            return VerComp::unk;
-        }
-
-        static VerComp compare_versions(VersionScheme sa, const Version& a, VersionScheme sb, const Version& b)
-        {
-            const auto inner_compare = compare_version_texts(sa, a, sb, b);
+            const auto inner_compare = compare(keys.get(sa, a.text()), keys.get(sb, b.text()));
             if (inner_compare == VerComp::eq)
             {
                 if (a.port_version() < b.port_version()) return VerComp::lt;
@@ -1417,12 +1402,13 @@ namespace vcpkg::Dependencies
             return inner_compare;
         }
 
-        bool VersionedPackageGraph::VersionSchemeInfo::is_less_than(const Version& new_ver) const
+        bool VersionedPackageGraph::VersionSchemeInfo::is_less_than(const Version& new_ver,
+                                                                    const VersionKeyCache& keys) const
         {
             Checks::check_exit(VCPKG_LINE_INFO, scfl);
             ASSUME(scfl != nullptr);
             auto s = scfl->source_control_file->core_paragraph->version_scheme;
-            auto r = compare_versions(s, version, s, new_ver);
+            auto r = compare_versions(keys, s, version, s, new_ver);
             Checks::check_exit(VCPKG_LINE_INFO, r != VerComp::unk);
             return r == VerComp::lt;
         }
@@ -1573,7 +1559,7 @@ namespace vcpkg::Dependencies
                 }
                 else
                 {
-                    replace = versioned_graph_entry.is_less_than(version);
+                    replace = versioned_graph_entry.is_less_than(version, m_version_keys);
                 }
 
                 if (replace)
@@ -1669,6 +1655,146 @@ namespace vcpkg::Dependencies
             return m_base_provider.get_baseline_version(name);
         }
 
+        void VersionedPackageGraph::prefetch_dependencies(View<const Dependency*> deps, const PackageSpec& toplevel)
+        {
+            struct FrontierEntry
+            {
+                PackageSpec spec;
+                Version version;
+                std::vector<std::string> features;
+            };
+
+            std::set<std::pair<PackageSpec, std::string>> seen;
+            std::vector<FrontierEntry> frontier;
+            auto enqueue = [&](const PackageSpec& spec, const Version& version, const Dependency& dep) {
+                if (seen.emplace(spec, version.to_string()).second)
+                {
+                    frontier.push_back(FrontierEntry{spec, version, dep.features});
+                }
+            };
+
+            auto enqueue_dependency = [&](const PackageSpec& spec, const Dependency& dep) {
+                if (auto p_overlay = m_o_provider.get_control_file(dep.name).get())
+                {
+                    enqueue(spec, p_overlay->source_control_file->to_version(), dep);
+                    return;
+                }
+
+                const auto over_it = m_overrides.find(dep.name);
+                if (over_it != m_overrides.end())
+                {
+                    enqueue(spec, over_it->second, dep);
+                    return;
+                }
+
+                const auto dep_ver = dep.constraint.try_get_minimum_version();
+                if (auto dv = dep_ver.get())
+                {
+                    enqueue(spec, *dv, dep);
+                }
+
+                const auto base_ver = m_base_provider.get_baseline_version(dep.name);
+                if (auto bv = base_ver.get())
+                {
+                    enqueue(spec, *bv, dep);
+                }
+            };
+
+            for (auto pdep : deps)
+            {
+                enqueue_dependency(PackageSpec{pdep->name, pdep->host ? m_host_triplet : toplevel.triplet()}, *pdep);
+            }
+
+            while (!frontier.empty())
+            {
+                const auto level = std::move(frontier);
+                frontier.clear();
+
+                std::vector<const SourceControlFileAndLocation*> scfls(level.size());
+                std::vector<VersionSpec> version_specs;
+                std::vector<size_t> version_spec_idxs;
+                for (size_t idx = 0; idx < level.size(); ++idx)
+                {
+                    if (auto p_overlay = m_o_provider.get_control_file(level[idx].spec.name()).get())
+                    {
+                        scfls[idx] = p_overlay;
+                    }
+                    else
+                    {
+                        version_specs.emplace_back(level[idx].spec.name(), level[idx].version);
+                        version_spec_idxs.push_back(idx);
+                    }
+                }
+
+                const auto fetched = m_ver_provider.prefetch_control_files(version_specs);
+                for (size_t idx = 0; idx < fetched.size(); ++idx)
+                {
+                    scfls[version_spec_idxs[idx]] = fetched[idx];
+                }
+
+                // the dependencies of each entry that will be walked: core, default features, and requested features
+                std::vector<std::vector<const Dependency*>> level_deps(level.size());
+                std::vector<PackageSpec> var_specs;
+                for (size_t idx = 0; idx < level.size(); ++idx)
+                {
+                    const auto scfl = scfls[idx];
+                    if (!scfl) continue;
+
+                    const auto& scf = *scfl->source_control_file;
+                    auto add_feature_deps = [&](const std::string& feature) {
+                        if (auto feature_deps = scf.find_dependencies_for_feature(feature).get())
+                        {
+                            for (auto&& dep : *feature_deps)
+                            {
+                                level_deps[idx].push_back(&dep);
+                            }
+                        }
+                    };
+
+                    add_feature_deps("core");
+                    for (auto&& feature : scf.core_paragraph->default_features)
+                    {
+                        add_feature_deps(feature);
+                    }
+
+                    for (auto&& feature : level[idx].features)
+                    {
+                        if (feature != "core" && feature != "default") add_feature_deps(feature);
+                    }
+
+                    const bool has_platform_deps = Util::any_of(
+                        level_deps[idx], [](const Dependency* dep) { return !dep->platform.is_empty(); });
+                    if (has_platform_deps && !m_var_provider.get_dep_info_vars(level[idx].spec).has_value())
+                    {
+                        var_specs.push_back(level[idx].spec);
+                    }
+                }
+
+                Util::sort_unique_erase(var_specs);
+                if (!var_specs.empty())
+                {
+                    m_var_provider.load_dep_info_vars(var_specs, m_host_triplet);
+                }
+
+                for (size_t idx = 0; idx < level.size(); ++idx)
+                {
+                    const auto& spec = level[idx].spec;
+                    for (auto pdep : level_deps[idx])
+                    {
+                        if (!pdep->platform.is_empty())
+                        {
+                            auto maybe_vars = m_var_provider.get_dep_info_vars(spec);
+                            auto vars = maybe_vars.get();
+                            if (!vars || !pdep->platform.evaluate(*vars)) continue;
+                        }
+
+                        enqueue_dependency(PackageSpec{pdep->name, pdep->host ? m_host_triplet : spec.triplet()},
+                                           *pdep);
+                    }
+                }
+            }
+        }
+
         void VersionedPackageGraph::add_override(const std::string& name, const Version& v)
         {
             m_overrides.emplace(name, v);
@@ -1720,6 +1846,8 @@ namespace vcpkg::Dependencies
                 }
             }
 
+            prefetch_dependencies(active_deps, toplevel);
+
             for (auto pdep : active_deps)
             {
                 const auto& dep = *pdep;
@@ -1756,6 +1884,7 @@ namespace vcpkg::Dependencies
                             if (dep_scfl && base_scfl)
                             {
                                 auto r = compare_versions(
+                                    m_version_keys,
                                     dep_scfl.get()->source_control_file->core_paragraph->version_scheme,
                                     *p_dep_ver,
                                     base_scfl.get()->source_control_file->core_paragraph->version_scheme,
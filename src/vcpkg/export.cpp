@@ -1,3 +1,4 @@
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/stringliteral.h>
 #include <vcpkg/base/system.print.h>
 #include <vcpkg/base/system.process.h>
@@ -14,6 +15,7 @@
 #include <vcpkg/input.h>
 #include <vcpkg/install.h>
 #include <vcpkg/installedpaths.h>
+#include <vcpkg/listfile.h>
 #include <vcpkg/paragraphs.h>
 #include <vcpkg/portfileprovider.h>
 #include <vcpkg/tools.h>
@@ -197,6 +199,7 @@ namespace vcpkg::Export
         {
             ZIP = 1,
             SEVEN_ZIP,
+            TAR_ZST,
         };
 
         constexpr ArchiveFormat() = delete;
@@ -220,6 +223,7 @@ namespace vcpkg::Export
     {
         constexpr const ArchiveFormat ZIP(ArchiveFormat::BackingEnum::ZIP, "zip", "zip");
         constexpr const ArchiveFormat SEVEN_ZIP(ArchiveFormat::BackingEnum::SEVEN_ZIP, "7z", "7zip");
+        constexpr const ArchiveFormat TAR_ZST(ArchiveFormat::BackingEnum::TAR_ZST, "tar.zst", "gnutar");
     }
 
     static Path do_archive_export(const VcpkgPaths& paths,
@@ -239,9 +243,13 @@ namespace vcpkg::Export
             .string_arg("tar")
             .string_arg("cf")
             .string_arg(exported_archive_path)
-            .string_arg(Strings::concat("--format=", format.cmake_option()))
-            .string_arg("--")
-            .string_arg(raw_exported_dir);
+            .string_arg(Strings::concat("--format=", format.cmake_option()));
+        if (format == ArchiveFormat::BackingEnum::TAR_ZST)
+        {
+            cmd.string_arg("--zstd");
+        }
+
+        cmd.string_arg("--").string_arg(raw_exported_dir);
 
         const int exit_code = cmd_execute_clean(cmd, WorkingDirectory{raw_exported_dir.parent_path()});
         Checks::check_exit(VCPKG_LINE_INFO, exit_code == 0, "Error: %s creation failed", exported_archive_path);
@@ -286,6 +294,7 @@ namespace vcpkg::Export
         bool ifw = false;
         bool zip = false;
         bool seven_zip = false;
+        bool tar_zst = false;
         bool chocolatey = false;
         bool prefab = false;
         bool all_installed = false;
@@ -311,6 +320,7 @@ namespace vcpkg::Export
     static constexpr StringLiteral OPTION_IFW = "ifw";
     static constexpr StringLiteral OPTION_ZIP = "zip";
     static constexpr StringLiteral OPTION_SEVEN_ZIP = "7zip";
+    static constexpr StringLiteral OPTION_TAR_ZST = "x-tar-zst";
     static constexpr StringLiteral OPTION_NUGET_ID = "nuget-id";
     static constexpr StringLiteral OPTION_NUGET_DESCRIPTION = "nuget-description";
     static constexpr StringLiteral OPTION_NUGET_VERSION = "nuget-version";
@@ -333,13 +343,14 @@ namespace vcpkg::Export
     static constexpr StringLiteral OPTION_PREFAB_ENABLE_MAVEN = "prefab-maven";
     static constexpr StringLiteral OPTION_PREFAB_ENABLE_DEBUG = "prefab-debug";
 
-    static constexpr std::array<CommandSwitch, 11> EXPORT_SWITCHES = {{
+    static constexpr std::array<CommandSwitch, 12> EXPORT_SWITCHES = {{
         {OPTION_DRY_RUN, "Do not actually export"},
         {OPTION_RAW, "Export to an uncompressed directory"},
         {OPTION_NUGET, "Export a NuGet package"},
         {OPTION_IFW, "Export to an IFW-based installer"},
         {OPTION_ZIP, "Export to a zip file"},
         {OPTION_SEVEN_ZIP, "Export to a 7zip (.7z) file"},
+        {OPTION_TAR_ZST, "Export to a zstd-compressed tarball (.tar.zst) (experimental feature)"},
         {OPTION_CHOCOLATEY, "Export a Chocolatey package (experimental feature)"},
         {OPTION_PREFAB, "Export to Prefab format"},
         {OPTION_PREFAB_ENABLE_MAVEN, "Enable maven"},
@@ -392,6 +403,7 @@ namespace vcpkg::Export
         ret.ifw = options.switches.find(OPTION_IFW) != options.switches.cend();
         ret.zip = options.switches.find(OPTION_ZIP) != options.switches.cend();
         ret.seven_zip = options.switches.find(OPTION_SEVEN_ZIP) != options.switches.cend();
+        ret.tar_zst = options.switches.find(OPTION_TAR_ZST) != options.switches.cend();
         ret.chocolatey = options.switches.find(OPTION_CHOCOLATEY) != options.switches.cend();
         ret.prefab = options.switches.find(OPTION_PREFAB) != options.switches.cend();
         ret.prefab_options.enable_maven = options.switches.find(OPTION_PREFAB_ENABLE_MAVEN) != options.switches.cend();
@@ -425,11 +437,12 @@ namespace vcpkg::Export
             });
         }
 
-        if (!ret.raw && !ret.nuget && !ret.ifw && !ret.zip && !ret.seven_zip && !ret.dry_run && !ret.chocolatey &&
-            !ret.prefab)
+        if (!ret.raw && !ret.nuget && !ret.ifw && !ret.zip && !ret.seven_zip && !ret.tar_zst && !ret.dry_run &&
+            !ret.chocolatey && !ret.prefab)
         {
             print2(Color::error,
-                   "Must provide at least one export type: --raw --nuget --ifw --zip --7zip --chocolatey --prefab\n");
+                   "Must provide at least one export type: --raw --nuget --ifw --zip --7zip --x-tar-zst --chocolatey "
+                   "--prefab\n");
             print2(COMMAND_STRUCTURE.example_text);
             Checks::exit_fail(VCPKG_LINE_INFO);
         }
@@ -508,11 +521,35 @@ namespace vcpkg::Export
                "\n\n");
     }
 
+    static std::vector<Path> get_exported_files(const VcpkgPaths& paths,
+                                                const ExportPlanAction& action,
+                                                const BinaryParagraph& binary_paragraph)
+    {
+        const auto listfile =
+            Listfile::load(paths.get_filesystem(), paths.installed().listfile_path(binary_paragraph), VCPKG_LINE_INFO);
+        std::vector<Path> files;
+        listfile.for_each([&](StringView suffix) {
+            if (suffix.back() == '/') suffix = suffix.substr(0, suffix.size() - 1);
+            if (Strings::equals(suffix, action.spec.triplet().canonical_name())) return;
+            files.push_back(paths.installed().root() / suffix);
+        });
+
+        return files;
+    }
+
     static void handle_raw_based_export(Span<const ExportPlanAction> export_plan,
                                         const ExportArguments& opts,
                                         const std::string& export_id,
                                         const VcpkgPaths& paths)
     {
+        for (const ExportPlanAction& action : export_plan)
+        {
+            if (action.plan_type != ExportPlanType::ALREADY_BUILT)
+            {
+                Checks::unreachable(VCPKG_LINE_INFO);
+            }
+        }
+
         Filesystem& fs = paths.get_filesystem();
         const auto raw_exported_dir_path = opts.output_dir / export_id;
         fs.remove_all(raw_exported_dir_path, VCPKG_LINE_INFO);
@@ -521,37 +558,23 @@ namespace vcpkg::Export
         std::error_code ec;
         fs.create_directory(raw_exported_dir_path, ec);
 
-        // execute the plan
+        // execute the plan; packages own disjoint files, so they are copied in parallel
         {
             const InstalledPaths export_paths(raw_exported_dir_path / "installed");
             for (const ExportPlanAction& action : export_plan)
             {
-                if (action.plan_type != ExportPlanType::ALREADY_BUILT)
-                {
-                    Checks::unreachable(VCPKG_LINE_INFO);
-                }
-
-                const std::string display_name = action.spec.to_string();
-                print2("Exporting package ", display_name, "...\n");
+                print2("Exporting package ", action.spec.to_string(), "...\n");
+            }
 
+            parallel_for_each_n(export_plan.begin(), export_plan.size(), [&](const ExportPlanAction& action) {
                 const BinaryParagraph& binary_paragraph = action.core_paragraph().value_or_exit(VCPKG_LINE_INFO);
-
                 const InstallDir dirs =
                     InstallDir::from_destination_root(export_paths, action.spec.triplet(), binary_paragraph);
-
-                auto lines = fs.read_lines(paths.installed().listfile_path(binary_paragraph), VCPKG_LINE_INFO);
-                std::vector<Path> files;
-                for (auto&& suffix : lines)
-                {
-                    if (suffix.empty()) continue;
-                    if (suffix.back() == '/') suffix.pop_back();
-                    if (suffix == action.spec.triplet().to_string()) continue;
-                    files.push_back(paths.installed().root() / suffix);
-                }
-
-                Install::install_files_and_write_listfile(
-                    fs, paths.installed().triplet_dir(action.spec.triplet()), files, dirs);
-            }
+                Install::install_files_and_write_listfile(fs,
+                                                          paths.installed().triplet_dir(action.spec.triplet()),
+                                                          get_exported_files(paths, action, binary_paragraph),
+                                                          dirs);
+            });
         }
 
         // Copy files needed for integration
@@ -604,6 +627,15 @@ With a project open, go to Tools->NuGet Package Manager->Package Manager Console
             print_next_step_info("[...]");
         }
 
+        if (opts.tar_zst)
+        {
+            print2("Creating tar.zst archive...\n");
+            const auto output_path =
+                do_archive_export(paths, raw_exported_dir_path, opts.output_dir, ArchiveFormatC::TAR_ZST);
+            print2(Color::success, "tar.zst archive exported at: ", output_path, "\n");
+            print_next_step_info("[...]");
+        }
+
         if (!opts.raw)
         {
             fs.remove_all(raw_exported_dir_path, VCPKG_LINE_INFO);
@@ -668,7 +700,7 @@ With a project open, go to Tools->NuGet Package Manager->Package Manager Console
 
         std::string export_id = opts.maybe_output.value_or(create_export_id());
 
-        if (opts.raw || opts.nuget || opts.zip || opts.seven_zip)
+        if (opts.raw || opts.nuget || opts.zip || opts.seven_zip || opts.tar_zst)
         {
             handle_raw_based_export(export_plan, opts, export_id, paths);
         }
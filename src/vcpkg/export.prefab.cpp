@@ -637,7 +637,7 @@ namespace vcpkg::Export::Prefab
             }
 
             Checks::check_exit(VCPKG_LINE_INFO,
-                               compress_directory_to_zip(paths, package_directory, exported_archive_path) != 0,
+                               compress_directory_to_zip(paths, package_directory, exported_archive_path) == 0,
                                Strings::concat("Failed to compress folder ", package_directory));
 
             std::string POM = R"(<?xml version="1.0" encoding="UTF-8"?>
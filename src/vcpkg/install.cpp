@@ -1,5 +1,6 @@
 #include <vcpkg/base/files.h>
 #include <vcpkg/base/hash.h>
+#include <vcpkg/base/json.h>
 #include <vcpkg/base/messages.h>
 #include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.print.h>
@@ -7,8 +8,10 @@
 
 #include <vcpkg/binarycaching.h>
 #include <vcpkg/build.h>
+#include <vcpkg/buildhistory.h>
 #include <vcpkg/cmakevars.h>
 #include <vcpkg/commands.setinstalled.h>
+#include <vcpkg/commands.version.h>
 #include <vcpkg/configuration.h>
 #include <vcpkg/dependencies.h>
 #include <vcpkg/documentation.h>
@@ -17,6 +20,7 @@
 #include <vcpkg/input.h>
 #include <vcpkg/install.h>
 #include <vcpkg/installedpaths.h>
+#include <vcpkg/listfile.h>
 #include <vcpkg/metrics.h>
 #include <vcpkg/paragraphs.h>
 #include <vcpkg/remove.h>
@@ -24,7 +28,10 @@
 #include <vcpkg/vcpkglib.h>
 #include <vcpkg/vcpkgpaths.h>
 
+#include <condition_variable>
 #include <iterator>
+#include <mutex>
+#include <thread>
 
 namespace
 {
@@ -34,6 +41,11 @@ namespace
                                  (msg::spec, msg::build_result, msg::elapsed),
                                  "{Locked}",
                                  "    {spec}: {build_result}: {elapsed}");
+    DECLARE_AND_REGISTER_MESSAGE(
+        ResultsResourceUsage,
+        (msg::value),
+        "Example of {value} is 'user 12.5 s, system 1.3 s, peak RSS 120.0 MiB, 0 blocks read, 2048 blocks written'",
+        "        resource usage: {value}");
 
     DECLARE_AND_REGISTER_MESSAGE(CmakeTargetsExcluded,
                                  (msg::count),
@@ -64,20 +76,62 @@ namespace vcpkg::Install
 
     const Path& InstallDir::listfile() const { return this->m_listfile; }
 
-    void install_package_and_write_listfile(Filesystem& fs, const Path& source_dir, const InstallDir& destination_dir)
+    void install_package_and_write_listfile(Filesystem& fs,
+                                            const Path& source_dir,
+                                            const InstallDir& destination_dir,
+                                            View<std::string> replaced_files)
     {
         Checks::check_exit(VCPKG_LINE_INFO,
                            fs.exists(source_dir, IgnoreErrors{}),
                            Strings::concat("Source directory ", source_dir, "does not exist"));
         auto files = fs.get_files_recursive(source_dir, VCPKG_LINE_INFO);
         Util::erase_remove_if(files, [](Path& path) { return path.filename() == ".DS_Store"; });
-        install_files_and_write_listfile(fs, source_dir, files, destination_dir);
+        install_files_and_write_listfile(fs, source_dir, files, destination_dir, replaced_files);
+    }
+
+    // whether the installed file `target` is a regular file with the contents of `source`
+    static bool has_same_contents(const Filesystem& fs, const Path& source, const Path& target)
+    {
+        std::error_code ec;
+        if (!vcpkg::is_regular_file(fs.symlink_status(target, ec)) || ec) return false;
+        const auto target_size = fs.file_size(target, ec);
+        if (ec) return false;
+        const auto source_size = fs.file_size(source, ec);
+        if (ec || source_size != target_size) return false;
+
+        // the files are read rather than mapped: another process may truncate an installed file, which would fault a
+        // mapping of it
+        const auto source_file = fs.open_for_read(source, ec);
+        if (ec) return false;
+        const auto target_file = fs.open_for_read(target, ec);
+        if (ec) return false;
+        constexpr size_t buffer_size = 65536;
+        const auto source_buffer = std::make_unique<char[]>(buffer_size);
+        const auto target_buffer = std::make_unique<char[]>(buffer_size);
+        for (;;)
+        {
+            const auto source_read = source_file.read(source_buffer.get(), 1, buffer_size);
+            const auto target_read = target_file.read(target_buffer.get(), 1, buffer_size);
+            if (source_read != target_read ||
+                !std::equal(source_buffer.get(), source_buffer.get() + source_read, target_buffer.get()))
+            {
+                return false;
+            }
+
+            if (source_read < buffer_size) return !source_file.error() && !target_file.error();
+        }
     }
+
     void install_files_and_write_listfile(Filesystem& fs,
                                           const Path& source_dir,
                                           const std::vector<Path>& files,
-                                          const InstallDir& destination_dir)
+                                          const InstallDir& destination_dir,
+                                          View<std::string> replaced_files)
     {
+        const auto is_replaced = [&](const std::string& path) {
+            return std::binary_search(replaced_files.begin(), replaced_files.end(), path);
+        };
+
         std::vector<std::string> output;
         std::error_code ec;
 
@@ -131,7 +185,15 @@ namespace vcpkg::Install
                 }
                 case FileType::regular:
                 {
-                    if (fs.exists(target, IgnoreErrors{}))
+                    if (is_replaced(this_output))
+                    {
+                        if (has_same_contents(fs, file, target))
+                        {
+                            output.push_back(std::move(this_output));
+                            break;
+                        }
+                    }
+                    else if (fs.exists(target, IgnoreErrors{}))
                     {
                         print2(Color::warning, "File ", target, " was already present and will be overwritten\n");
                     }
@@ -148,7 +210,11 @@ namespace vcpkg::Install
                 case FileType::symlink:
                 case FileType::junction:
                 {
-                    if (fs.exists(target, IgnoreErrors{}))
+                    if (is_replaced(this_output))
+                    {
+                        fs.remove(target, IgnoreErrors{});
+                    }
+                    else if (fs.exists(target, IgnoreErrors{}))
                     {
                         print2(Color::warning, "File ", target, " was already present and will be overwritten\n");
                     }
@@ -166,95 +232,133 @@ namespace vcpkg::Install
             }
         }
 
-        std::sort(output.begin(), output.end());
-        fs.write_lines(listfile, output, VCPKG_LINE_INFO);
+        write_listfile(fs, listfile, std::move(output));
     }
 
-    static std::vector<file_pack> extract_files_in_triplet(
-        const std::vector<StatusParagraphAndAssociatedFiles>& pgh_and_files,
-        Triplet triplet,
-        const size_t remove_chars = 0)
+    static SortedVector<std::string> build_list_of_package_files(const Filesystem& fs, const Path& package_dir)
     {
-        std::vector<file_pack> output;
-        for (const StatusParagraphAndAssociatedFiles& t : pgh_and_files)
+        std::vector<Path> package_file_paths = fs.get_files_recursive(package_dir, IgnoreErrors{});
+        Util::erase_remove_if(package_file_paths, [](Path& path) { return path.filename() == ".DS_Store"; });
+        const size_t package_remove_char_count = package_dir.native().size() + 1; // +1 for the slash
+        auto package_files = Util::fmap(package_file_paths, [package_remove_char_count](const Path& target) {
+            return std::string(target.generic_u8string(), package_remove_char_count);
+        });
+
+        return SortedVector<std::string>(std::move(package_files));
+    }
+
+    // finds the files of `package_files`, which are relative to the triplet directory, that other packages installed
+    static std::vector<file_pack> find_conflicting_files(
+        const std::vector<StatusParagraphAndListfile>& installed_listfiles,
+        const SortedVector<std::string>& package_files,
+        Triplet triplet)
+    {
+        const auto triplet_prefix = triplet.canonical_name() + '/';
+        std::vector<file_pack> conflicts;
+        std::string installed_path;
+        for (auto&& installed_listfile : installed_listfiles)
         {
-            if (t.pgh.package.spec.triplet() != triplet)
+            const auto& package = installed_listfile.pgh->package;
+            if (package.spec.triplet() != triplet)
             {
                 continue;
             }
 
-            const std::string name = t.pgh.package.displayname();
-
-            for (const std::string& file : t.files)
+            if (auto paths = installed_listfile.listfile.front_coded_paths())
             {
-                output.emplace_back(file_pack{std::string(file, remove_chars), name});
+                // a package has far fewer files than the installed tree, so searching for each of them is cheapest
+                for (auto&& file : package_files)
+                {
+                    installed_path.assign(triplet_prefix).append(file);
+                    if (paths->contains(installed_path))
+                    {
+                        conflicts.emplace_back(file, package.displayname());
+                    }
+                }
+
+                continue;
             }
+
+            installed_listfile.listfile.for_each([&](StringView path) {
+                if (path.back() == '/' || !Strings::starts_with(path, triplet_prefix)) return;
+                const auto file = path.substr(triplet_prefix.size());
+                const auto it = std::lower_bound(package_files.begin(),
+                                                 package_files.end(),
+                                                 file,
+                                                 [](const std::string& lhs, StringView rhs) { return lhs < rhs; });
+                if (it != package_files.end() && *it == file)
+                {
+                    conflicts.emplace_back(*it, package.displayname());
+                }
+            });
         }
 
-        std::sort(output.begin(), output.end(), [](const file_pack& lhs, const file_pack& rhs) {
-            return lhs.first < rhs.first;
+        Util::sort(conflicts, [](const file_pack& lhs, const file_pack& rhs) {
+            return std::tie(lhs.second, lhs.first) < std::tie(rhs.second, rhs.first);
         });
-        return output;
+        return conflicts;
     }
 
-    static SortedVector<std::string> build_list_of_package_files(const Filesystem& fs, const Path& package_dir)
+    // whether another process installed exactly this package, with the same ABI and features, since the plan was made
+    static bool package_already_installed(const StatusParagraphs& status_db, const BinaryControlFile& bcf)
     {
-        std::vector<Path> package_file_paths = fs.get_files_recursive(package_dir, IgnoreErrors{});
-        Util::erase_remove_if(package_file_paths, [](Path& path) { return path.filename() == ".DS_Store"; });
-        const size_t package_remove_char_count = package_dir.native().size() + 1; // +1 for the slash
-        auto package_files = Util::fmap(package_file_paths, [package_remove_char_count](const Path& target) {
-            return std::string(target.generic_u8string(), package_remove_char_count);
+        const auto& core = bcf.core_paragraph;
+        if (core.abi.empty()) return false;
+        const auto it = status_db.find_installed(core.spec);
+        if (it == status_db.end() || (*it)->package.abi != core.abi) return false;
+        return !Util::any_of(bcf.features, [&](const BinaryParagraph& feature) {
+            return !status_db.is_installed(FeatureSpec{core.spec, feature.feature});
         });
-
-        return SortedVector<std::string>(std::move(package_files));
     }
 
-    static SortedVector<file_pack> build_list_of_installed_files(
-        const std::vector<StatusParagraphAndAssociatedFiles>& pgh_and_files, Triplet triplet)
+    // removes the files a replaced version of a package left behind which the installed package, whose listfile is
+    // `listfile_path`, does not have
+    static void remove_replaced_files(Filesystem& fs,
+                                      const InstalledPaths& installed,
+                                      const std::vector<std::string>& replaced_files,
+                                      const Path& listfile_path)
     {
-        const size_t installed_remove_char_count = triplet.canonical_name().size() + 1; // +1 for the slash
-        std::vector<file_pack> installed_files =
-            extract_files_in_triplet(pgh_and_files, triplet, installed_remove_char_count);
+        if (replaced_files.empty()) return;
+        std::vector<std::string> installed_files;
+        {
+            const auto listfile = Listfile::load(fs, listfile_path, VCPKG_LINE_INFO);
+            listfile.for_each([&](StringView path) { installed_files.push_back(path.to_string()); });
+        }
 
-        return SortedVector<file_pack>(std::move(installed_files));
+        Util::sort(installed_files);
+        std::vector<std::string> stale_files;
+        std::set_difference(replaced_files.begin(),
+                            replaced_files.end(),
+                            installed_files.begin(),
+                            installed_files.end(),
+                            std::back_inserter(stale_files));
+        Remove::remove_installed_files(fs, installed.root(), std::move(stale_files));
     }
 
-    InstallResult install_package(const VcpkgPaths& paths, const BinaryControlFile& bcf, StatusParagraphs* status_db)
+    InstallResult install_package(const VcpkgPaths& paths,
+                                  const BinaryControlFile& bcf,
+                                  StatusParagraphs* status_db,
+                                  std::vector<std::string> replaced_files)
     {
         auto& fs = paths.get_filesystem();
         const auto& installed = paths.installed();
         const auto package_dir = paths.package_dir(bcf.core_paragraph.spec);
         Triplet triplet = bcf.core_paragraph.spec.triplet();
-        const std::vector<StatusParagraphAndAssociatedFiles> pgh_and_files =
-            get_installed_files(fs, installed, *status_db);
+        Util::sort(replaced_files);
+        // other vcpkg processes may be installing into the same tree
+        const auto status_lock = lock_status_database(fs, installed);
+        database_refresh(fs, installed, *status_db);
+        if (package_already_installed(*status_db, bcf))
+        {
+            print2("Package ", bcf.core_paragraph.spec, " was installed by another vcpkg process\n");
+            const auto& core = (*status_db->find_installed(bcf.core_paragraph.spec))->package;
+            remove_replaced_files(fs, installed, replaced_files, installed.listfile_path(core));
+            return InstallResult::SUCCESS;
+        }
 
         const SortedVector<std::string> package_files = build_list_of_package_files(fs, package_dir);
-        const SortedVector<file_pack> installed_files = build_list_of_installed_files(pgh_and_files, triplet);
-
-        struct intersection_compare
-        {
-            // The VS2015 standard library requires comparison operators of T and U
-            // to also support comparison of T and T, and of U and U, due to debug checks.
-#if _MSC_VER <= 1910
-            bool operator()(const std::string& lhs, const std::string& rhs) { return lhs < rhs; }
-            bool operator()(const file_pack& lhs, const file_pack& rhs) { return lhs.first < rhs.first; }
-#endif
-            bool operator()(const std::string& lhs, const file_pack& rhs) { return lhs < rhs.first; }
-            bool operator()(const file_pack& lhs, const std::string& rhs) { return lhs.first < rhs; }
-        };
-
-        std::vector<file_pack> intersection;
-
-        std::set_intersection(installed_files.begin(),
-                              installed_files.end(),
-                              package_files.begin(),
-                              package_files.end(),
-                              std::back_inserter(intersection),
-                              intersection_compare());
-
-        std::sort(intersection.begin(), intersection.end(), [](const file_pack& lhs, const file_pack& rhs) {
-            return lhs.second < rhs.second;
-        });
+        const std::vector<file_pack> intersection =
+            find_conflicting_files(get_installed_listfiles(fs, installed, *status_db), package_files, triplet);
 
         if (!intersection.empty())
         {
@@ -277,6 +381,7 @@ namespace vcpkg::Install
                 i = next;
             }
 
+            Remove::remove_installed_files(fs, installed.root(), std::move(replaced_files));
             return InstallResult::FILE_CONFLICTS;
         }
 
@@ -305,7 +410,8 @@ namespace vcpkg::Install
         const InstallDir install_dir =
             InstallDir::from_destination_root(paths.installed(), triplet, bcf.core_paragraph);
 
-        install_package_and_write_listfile(fs, paths.package_dir(bcf.core_paragraph.spec), install_dir);
+        install_package_and_write_listfile(fs, paths.package_dir(bcf.core_paragraph.spec), install_dir, replaced_files);
+        remove_replaced_files(fs, installed, replaced_files, install_dir.listfile());
 
         source_paragraph.state = InstallState::INSTALLED;
         write_update(fs, installed, source_paragraph);
@@ -324,12 +430,168 @@ namespace vcpkg::Install
     using Build::BuildResult;
     using Build::ExtendedBuildResult;
 
+    static bool package_dir_has_abi(const VcpkgPaths& paths, const InstallPlanAction& action)
+    {
+        auto maybe_bcf =
+            Paragraphs::try_load_cached_package(paths.get_filesystem(), paths.package_dir(action.spec), action.spec);
+        const auto bcf = maybe_bcf.get();
+        return bcf && bcf->core_paragraph.abi == action.package_abi().value_or_exit(VCPKG_LINE_INFO);
+    }
+
+    // Prefetching restores many packages at once. Their locks are taken in a fixed order, so that processes
+    // prefetching overlapping sets of packages cannot deadlock.
+    static std::vector<std::unique_ptr<IExclusiveFileLock>> lock_package_dirs(const VcpkgPaths& paths,
+                                                                              View<InstallPlanAction> actions)
+    {
+        std::vector<const PackageSpec*> specs;
+        for (auto&& action : actions)
+        {
+            if (action.plan_type == InstallPlanType::BUILD_AND_INSTALL && action.has_package_abi())
+            {
+                specs.push_back(&action.spec);
+            }
+        }
+
+        Util::sort(specs, [](const PackageSpec* lhs, const PackageSpec* rhs) { return lhs->dir() < rhs->dir(); });
+        return Util::fmap(specs, [&](const PackageSpec* spec) { return paths.lock_package_dir(*spec); });
+    }
+
+    // Prefetches install actions from the binary cache on a background thread as compute_all_abis finishes them, so
+    // that restoring the packages at the front of the plan overlaps computing the ABIs of those after them.
+    struct StreamingPrefetch
+    {
+        StreamingPrefetch(const VcpkgPaths& paths, BinaryCache& binary_cache, View<InstallPlanAction> actions)
+            : m_paths(paths), m_binary_cache(binary_cache), m_actions(actions), m_thread([this] { run(); })
+        {
+        }
+
+        StreamingPrefetch(const StreamingPrefetch&) = delete;
+        StreamingPrefetch& operator=(const StreamingPrefetch&) = delete;
+        ~StreamingPrefetch() { finish(); }
+
+        // the first `count` actions have their ABIs
+        void publish(size_t count)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_published = count;
+            }
+
+            m_cv.notify_one();
+        }
+
+        // waits for every published action to be prefetched
+        void finish()
+        {
+            if (!m_thread.joinable()) return;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_finishing = true;
+            }
+
+            m_cv.notify_one();
+            m_thread.join();
+        }
+
+    private:
+        void run()
+        {
+            size_t prefetched = 0;
+            for (;;)
+            {
+                size_t published;
+                {
+                    std::unique_lock<std::mutex> lock(m_mtx);
+                    m_cv.wait(lock, [&] { return m_finishing || m_published != prefetched; });
+                    published = m_published;
+                }
+
+                if (published == prefetched) return;
+
+                // whatever was published while the previous batch was prefetched becomes the next batch, split so
+                // that each holds a bounded number of locks open (macOS allows only 256 descriptors by default)
+                const auto batch_size = std::min(published - prefetched, MAX_BATCH_SIZE);
+                const View<InstallPlanAction> batch{m_actions.data() + prefetched, batch_size};
+                const auto package_locks = lock_package_dirs(m_paths, batch);
+                m_binary_cache.prefetch(batch);
+                prefetched += batch_size;
+            }
+        }
+
+        static constexpr size_t MAX_BATCH_SIZE = 64;
+
+        const VcpkgPaths& m_paths;
+        BinaryCache& m_binary_cache;
+        View<InstallPlanAction> m_actions;
+        std::mutex m_mtx;
+        std::condition_variable m_cv;
+        size_t m_published = 0;
+        bool m_finishing = false;
+        std::thread m_thread;
+    };
+
+    // The files of packages which the plan removes and then installs again. They are left in the installed tree until
+    // the new package is installed over them, so that only the files which changed are touched. Ports must not be
+    // built while any are left, since builds must see only the packages the status database lists, so the diff only
+    // applies to packages installed before the first port is built, such as those restored from the binary cache.
+    struct ReplacedPackages
+    {
+        ReplacedPackages(Filesystem& fs, const InstalledPaths& installed)
+            : m_fs(fs), m_installed(installed), m_listfiles(fs, installed)
+        {
+        }
+        ReplacedPackages(const ReplacedPackages&) = delete;
+        ReplacedPackages& operator=(const ReplacedPackages&) = delete;
+
+        void replace(const VcpkgPaths& paths, const RemovePlanAction& action, StatusParagraphs& status_db)
+        {
+            m_packages.emplace(action.spec,
+                               Remove::perform_replace_plan_action(paths, action, &status_db, m_listfiles));
+        }
+
+        // the package stays replaced, so that its files are not abandoned, until release() is called once they have
+        // been installed over or removed
+        std::vector<std::string> take(const PackageSpec& spec)
+        {
+            const auto it = m_packages.find(spec);
+            if (it == m_packages.end()) return {};
+            return std::move(it->second);
+        }
+
+        void release(const PackageSpec& spec)
+        {
+            const auto it = m_packages.find(spec);
+            if (it == m_packages.end()) return;
+            m_listfiles.release(spec);
+            m_packages.erase(it);
+        }
+
+        void remove_all()
+        {
+            for (auto&& entry : m_packages)
+            {
+                Remove::remove_installed_files(m_fs, m_installed.root(), std::move(entry.second));
+                m_listfiles.release(entry.first);
+            }
+
+            m_packages.clear();
+        }
+
+    private:
+        Filesystem& m_fs;
+        const InstalledPaths& m_installed;
+        Remove::ReplacedListfiles m_listfiles;
+        std::map<PackageSpec, std::vector<std::string>> m_packages;
+    };
+
     static ExtendedBuildResult perform_install_plan_action(const VcpkgCmdArguments& args,
                                                            const VcpkgPaths& paths,
                                                            InstallPlanAction& action,
                                                            StatusParagraphs& status_db,
                                                            BinaryCache& binary_cache,
-                                                           const Build::IBuildLogsRecorder& build_logs_recorder)
+                                                           const Build::IBuildLogsRecorder& build_logs_recorder,
+                                                           Build::IBuildExecutor& build_executor,
+                                                           ReplacedPackages* replaced)
     {
         auto& fs = paths.get_filesystem();
         const InstallPlanType& plan_type = action.plan_type;
@@ -351,9 +613,16 @@ namespace vcpkg::Install
 
         if (plan_type == InstallPlanType::BUILD_AND_INSTALL)
         {
+            const auto package_lock = paths.lock_package_dir(action.spec);
+            if (binary_cache.is_restored(action) && !package_dir_has_abi(paths, action))
+            {
+                // another process replaced or removed the package while it was not locked
+                binary_cache.refresh_status(action);
+            }
+
             std::unique_ptr<BinaryControlFile> bcf;
-            auto restore = binary_cache.try_restore(action);
-            if (restore == RestoreResult::restored)
+            Optional<ProcessResourceUsage> resource_usage;
+            if (binary_cache.try_restore(action) == RestoreResult::restored)
             {
                 auto maybe_bcf = Paragraphs::try_load_cached_package(fs, paths.package_dir(action.spec), action.spec);
                 bcf = std::make_unique<BinaryControlFile>(std::move(maybe_bcf).value_or_exit(VCPKG_LINE_INFO));
@@ -369,7 +638,15 @@ namespace vcpkg::Install
                 else
                     vcpkg::printf("Building package %s...\n", display_name_with_features);
 
-                auto result = Build::build_package(args, paths, action, binary_cache, build_logs_recorder, status_db);
+                if (replaced)
+                {
+                    replaced->remove_all();
+                }
+
+                auto result = [&] {
+                    const auto build_dir_lock = paths.lock_build_dir(action.spec.name());
+                    return build_executor.build(args, paths, action, binary_cache, build_logs_recorder, status_db);
+                }();
 
                 if (BuildResult::DOWNLOADED == result.code)
                 {
@@ -384,12 +661,19 @@ namespace vcpkg::Install
                 }
 
                 bcf = std::move(result.binary_control_file);
+                resource_usage = std::move(result.resource_usage);
             }
             // Build or restore succeeded and `bcf` is populated with the control file.
             Checks::check_exit(VCPKG_LINE_INFO, bcf != nullptr);
 
             vcpkg::printf("Installing package %s...\n", display_name_with_features);
-            const auto install_result = install_package(paths, *bcf, &status_db);
+            const auto install_result = install_package(
+                paths, *bcf, &status_db, replaced ? replaced->take(action.spec) : std::vector<std::string>{});
+            if (replaced)
+            {
+                replaced->release(action.spec);
+            }
+
             BuildResult code;
             switch (install_result)
             {
@@ -400,7 +684,7 @@ namespace vcpkg::Install
 
             if (action.build_options.clean_packages == Build::CleanPackages::YES)
             {
-                fs.remove_all(paths.package_dir(action.spec), VCPKG_LINE_INFO);
+                fs.remove_all_in_background(paths.package_dir(action.spec), VCPKG_LINE_INFO);
             }
 
             if (action.build_options.clean_downloads == Build::CleanDownloads::YES)
@@ -412,7 +696,9 @@ namespace vcpkg::Install
                 }
             }
 
-            return {code, std::move(bcf)};
+            ExtendedBuildResult result{code, std::move(bcf)};
+            result.resource_usage = std::move(resource_usage);
+            return result;
         }
 
         if (plan_type == InstallPlanType::EXCLUDED)
@@ -434,6 +720,10 @@ namespace vcpkg::Install
                          msg::spec = result.spec,
                          msg::build_result = Build::to_string(result.build_result.code),
                          msg::elapsed = result.timing);
+            if (auto usage = result.build_result.resource_usage.get())
+            {
+                msg::println(msgResultsResourceUsage, msg::value = format_resource_usage(*usage));
+            }
         }
 
         std::map<Triplet, Build::BuildResultCounts> summary;
@@ -476,6 +766,28 @@ namespace vcpkg::Install
         TrackedPackageInstallGuard& operator=(const TrackedPackageInstallGuard&) = delete;
     };
 
+    // estimates from the build history how long building the packages of `remaining_actions` which were not restored
+    // from the binary cache will take
+    static void print_estimated_time_remaining(const BuildHistory& build_history,
+                                               const BinaryCache& binary_cache,
+                                               View<InstallPlanAction> remaining_actions)
+    {
+        uint64_t remaining_us = 0;
+        for (auto&& action : remaining_actions)
+        {
+            if (action.plan_type == InstallPlanType::BUILD_AND_INSTALL && !binary_cache.is_restored(action))
+            {
+                remaining_us += build_history.estimated_build_time_us(action.spec);
+            }
+        }
+
+        if (remaining_us != 0)
+        {
+            const ElapsedTime remaining{std::chrono::microseconds(remaining_us)};
+            print2("Estimated time remaining: ", remaining.to_string(), '\n');
+        }
+    }
+
     InstallSummary perform(const VcpkgCmdArguments& args,
                            ActionPlan& action_plan,
                            const KeepGoing keep_going,
@@ -486,31 +798,75 @@ namespace vcpkg::Install
                            const CMakeVars::CMakeVarProvider& var_provider)
     {
         std::vector<SpecSummary> results;
+        const auto build_executor = Build::make_build_executor(args);
         const size_t action_count = action_plan.remove_actions.size() + action_plan.install_actions.size();
         size_t action_index = 1;
+        const auto build_history = BuildHistory::load(paths.get_filesystem(), paths.installed());
+        if (build_executor->builds_concurrently())
+        {
+            order_by_critical_path(action_plan.install_actions, build_history);
+        }
+
+        // upgrades remove packages and then install them again; their files are diffed rather than removed
+        Remove::remove_abandoned_replaced_files(paths.get_filesystem(), paths.installed(), status_db);
+        ReplacedPackages replaced(paths.get_filesystem(), paths.installed());
+        std::set<PackageSpec> reinstalled_specs;
+        for (auto&& action : action_plan.install_actions)
+        {
+            if (action.plan_type == InstallPlanType::BUILD_AND_INSTALL)
+            {
+                reinstalled_specs.insert(action.spec);
+            }
+        }
 
         for (auto&& action : action_plan.remove_actions)
         {
             TrackedPackageInstallGuard this_install(action_index++, action_count, results, action.spec);
-            Remove::perform_remove_plan_action(paths, action, Remove::Purge::YES, &status_db);
+            if (action.plan_type == RemovePlanType::REMOVE && Util::Sets::contains(reinstalled_specs, action.spec))
+            {
+                replaced.replace(paths, action, status_db);
+            }
+            else
+            {
+                Remove::perform_remove_plan_action(paths, action, Remove::Purge::YES, &status_db);
+            }
         }
 
         for (auto&& action : action_plan.already_installed)
         {
             results.emplace_back(action.spec, &action);
-            results.back().build_result =
-                perform_install_plan_action(args, paths, action, status_db, binary_cache, build_logs_recorder);
+            results.back().build_result = perform_install_plan_action(
+                args, paths, action, status_db, binary_cache, build_logs_recorder, *build_executor, nullptr);
+        }
+
+        {
+            StreamingPrefetch prefetch(paths, binary_cache, action_plan.install_actions);
+            Build::compute_all_abis(
+                paths, action_plan, var_provider, status_db, [&](size_t count) { prefetch.publish(count); });
         }
 
-        Build::compute_all_abis(paths, action_plan, var_provider, status_db);
-        binary_cache.prefetch(action_plan.install_actions);
+        build_executor->prebuild(paths, action_plan.install_actions, binary_cache, status_db);
+
         for (auto&& action : action_plan.install_actions)
         {
+            if (!build_history.empty())
+            {
+                const auto actions_end = action_plan.install_actions.data() + action_plan.install_actions.size();
+                print_estimated_time_remaining(build_history, binary_cache, {&action, actions_end});
+            }
+
             TrackedPackageInstallGuard this_install(action_index++, action_count, results, action.spec);
-            auto result =
-                perform_install_plan_action(args, paths, action, status_db, binary_cache, build_logs_recorder);
+            auto result = perform_install_plan_action(args,
+                                                      paths,
+                                                      action,
+                                                      status_db,
+                                                      binary_cache,
+                                                      build_logs_recorder,
+                                                      *build_executor,
+                                                      &replaced);
             if (result.code != BuildResult::SUCCEEDED && keep_going == KeepGoing::NO)
             {
+                replaced.remove_all();
                 print2(Build::create_user_troubleshooting_message(action, paths), '\n');
                 Checks::exit_fail(VCPKG_LINE_INFO);
             }
@@ -519,6 +875,7 @@ namespace vcpkg::Install
             this_install.current_summary->build_result = std::move(result);
         }
 
+        replaced.remove_all();
         return InstallSummary{std::move(results)};
     }
 
@@ -542,8 +899,10 @@ namespace vcpkg::Install
     static constexpr StringLiteral OPTION_PROHIBIT_BACKCOMPAT_FEATURES = "x-prohibit-backcompat-features";
     static constexpr StringLiteral OPTION_ENFORCE_PORT_CHECKS = "enforce-port-checks";
     static constexpr StringLiteral OPTION_ALLOW_UNSUPPORTED_PORT = "allow-unsupported";
+    static constexpr StringLiteral OPTION_QUIET_BUILD = "x-quiet-build";
+    static constexpr StringLiteral OPTION_EXPECT_ABI = "x-expect-abi";
 
-    static constexpr std::array<CommandSwitch, 17> INSTALL_SWITCHES = {{
+    static constexpr std::array<CommandSwitch, 18> INSTALL_SWITCHES = {{
         {OPTION_DRY_RUN, "Do not actually build or install"},
         {OPTION_USE_HEAD_VERSION,
          "Install the libraries on the command line using the latest upstream sources (classic mode)"},
@@ -566,6 +925,7 @@ namespace vcpkg::Install
          "Fail install if a port has detected problems or attempts to use a deprecated feature"},
         {OPTION_PROHIBIT_BACKCOMPAT_FEATURES, ""},
         {OPTION_ALLOW_UNSUPPORTED_PORT, "Instead of erroring on an unsupported port, continue with a warning."},
+        {OPTION_QUIET_BUILD, "Only print status lines while building, and the end of the log if a build fails"},
     }};
 
     static constexpr std::array<CommandSetting, 2> INSTALL_SETTINGS = {{
@@ -575,8 +935,9 @@ namespace vcpkg::Install
          "binarycaching` for more information."},
     }};
 
-    static constexpr std::array<CommandMultiSetting, 1> INSTALL_MULTISETTINGS = {{
+    static constexpr std::array<CommandMultiSetting, 2> INSTALL_MULTISETTINGS = {{
         {OPTION_MANIFEST_FEATURE, "Additional feature from the top-level manifest to install (manifest mode)."},
+        {OPTION_EXPECT_ABI, ""}, // internal use
     }};
 
     static std::vector<std::string> get_all_port_names(const VcpkgPaths& paths)
@@ -598,6 +959,59 @@ namespace vcpkg::Install
         return ret;
     }
 
+    // Exits if a package in `action_plan` named by one of `expected_abis`, each "<name>:<triplet>=<abi>", has another
+    // ABI, before anything is built. Build workers use this to refuse jobs they would build differently.
+    static void check_expected_abis(const ActionPlan& action_plan, View<std::string> expected_abis)
+    {
+        std::map<std::string, std::string> expected;
+        for (auto&& expected_abi : expected_abis)
+        {
+            const auto equals = expected_abi.find('=');
+            Checks::check_exit(VCPKG_LINE_INFO,
+                               equals != std::string::npos,
+                               "Error: --%s expects <name>:<triplet>=<abi>, but got %s",
+                               OPTION_EXPECT_ABI,
+                               expected_abi);
+            expected.emplace(expected_abi.substr(0, equals), expected_abi.substr(equals + 1));
+        }
+
+        bool mismatched = false;
+        for (auto&& action : action_plan.install_actions)
+        {
+            const auto it = expected.find(action.spec.to_string());
+            if (it == expected.end()) continue;
+
+            const std::string abi =
+                action.has_package_abi() ? action.package_abi().value_or_exit(VCPKG_LINE_INFO) : std::string();
+            if (abi != it->second)
+            {
+                vcpkg::printf(
+                    Color::error, "Error: the ABI of %s is %s, but %s was expected\n", action.spec, abi, it->second);
+                const auto abi_info = action.abi_info.get();
+                if (const auto abi_tag_file = abi_info ? abi_info->abi_tag_file.get() : nullptr)
+                {
+                    vcpkg::printf("The inputs of the ABI are listed in %s\n", *abi_tag_file);
+                }
+
+                mismatched = true;
+            }
+
+            expected.erase(it);
+        }
+
+        for (auto&& missing : expected)
+        {
+            vcpkg::printf(
+                Color::error, "Error: %s was expected to be installed, but is not in the plan\n", missing.first);
+            mismatched = true;
+        }
+
+        if (mismatched)
+        {
+            Checks::exit_fail(VCPKG_LINE_INFO);
+        }
+    }
+
     const CommandStructure COMMAND_STRUCTURE = {
         create_example_string("install zlib zlib:x64-windows curl boost"),
         0,
@@ -700,7 +1114,7 @@ namespace vcpkg::Install
             return ret;
         }
 
-        auto files = fs.read_lines(installed.listfile_path(bpgh), ec);
+        const auto listfile = Listfile::load(fs, installed.listfile_path(bpgh), ec);
         if (!ec)
         {
             std::map<std::string, std::string> config_files;
@@ -708,8 +1122,7 @@ namespace vcpkg::Install
             bool is_header_only = true;
             std::string header_path;
 
-            for (auto&& suffix : files)
-            {
+            listfile.for_each([&](StringView suffix) {
                 if (Strings::contains(suffix, "/share/") && Strings::ends_with(suffix, ".cmake"))
                 {
                     // CMake file is inside the share folder
@@ -749,13 +1162,13 @@ namespace vcpkg::Install
 
                 if (is_header_only && header_path.empty())
                 {
-                    const auto it = suffix.find("/include/");
-                    if (it != std::string::npos && !Strings::ends_with(suffix, "/"))
+                    const auto it = Strings::search(suffix, "/include/");
+                    if (it != suffix.end() && !Strings::ends_with(suffix, "/"))
                     {
-                        header_path = suffix.substr(it + 9);
+                        header_path.assign(it + 9, suffix.end());
                     }
                 }
-            }
+            });
 
             ret.header_only = is_header_only;
 
@@ -851,6 +1264,325 @@ namespace vcpkg::Install
                                  "",
                                  "Error: The option --{option} is not supported in manifest mode.");
 
+    static void append_tree_identity(std::string& key_material, const Filesystem& fs, const Path& dir)
+    {
+        std::error_code ec;
+        auto files = fs.get_regular_files_recursive(dir, ec);
+        if (ec)
+        {
+            Strings::append(key_material, dir, " missing\n");
+            return;
+        }
+
+        Util::sort(files);
+        for (auto&& file : files)
+        {
+            Build::append_file_identity(key_material, fs, file);
+        }
+    }
+
+    static void append_sorted_options(std::string& key_material, const ParsedArguments& options)
+    {
+        std::vector<std::string> lines;
+        for (auto&& sw : options.switches)
+        {
+            lines.push_back(Strings::concat("switch ", sw));
+        }
+
+        for (auto&& setting : options.settings)
+        {
+            lines.push_back(Strings::concat("setting ", setting.first, '=', setting.second));
+        }
+
+        for (auto&& multisetting : options.multisettings)
+        {
+            for (auto&& value : multisetting.second)
+            {
+                lines.push_back(Strings::concat("multisetting ", multisetting.first, '=', value));
+            }
+        }
+
+        Util::sort(lines);
+        for (auto&& line : lines)
+        {
+            Strings::append(key_material, line, '\n');
+        }
+    }
+
+    // Everything a manifest-mode install reads that the install itself does not change, except the ports and registry
+    // files, which are only known once versions are resolved; see ManifestBuildInputs::port_inputs. Directories are
+    // described by file sizes and modification times rather than contents, so this only costs a directory walk.
+    static std::string compute_manifest_inputs_fingerprint(const VcpkgCmdArguments& args,
+                                                           const VcpkgPaths& paths,
+                                                           const ParsedArguments& options,
+                                                           Triplet default_triplet,
+                                                           Triplet host_triplet)
+    {
+        const auto& fs = paths.get_filesystem();
+        const auto& manifest_path = paths.get_manifest_path().value_or_exit(VCPKG_LINE_INFO);
+        std::string key_material;
+        Strings::append(key_material, "vcpkg ", Commands::Version::version(), '\n');
+        Strings::append(key_material, "root ", paths.root, '\n');
+        Strings::append(key_material, "manifest ", manifest_path, '\n');
+        Strings::append(
+            key_material, Json::stringify(paths.get_manifest().value_or_exit(VCPKG_LINE_INFO), Json::JsonStyle{}));
+
+        const auto configuration_path = Path(manifest_path.parent_path()) / "vcpkg-configuration.json";
+        std::error_code ec;
+        auto configuration = fs.read_contents(configuration_path, ec);
+        Strings::append(key_material, "configuration ", configuration_path, ec ? " missing\n" : "\n", configuration);
+
+        Strings::append(key_material, "triplets ", default_triplet, ' ', host_triplet, '\n');
+        const auto& flags = paths.get_feature_flags();
+        for (bool flag : {flags.registries, flags.compiler_tracking, flags.binary_caching, flags.versions})
+        {
+            key_material.push_back(flag ? '1' : '0');
+        }
+
+        key_material.push_back('\n');
+        append_sorted_options(key_material, options);
+        for (auto&& cmake_arg : args.cmake_args)
+        {
+            Strings::append(key_material, "cmake-arg ", cmake_arg, '\n');
+        }
+
+        for (auto&& binary_source : args.binary_sources)
+        {
+            Strings::append(key_material, "binary-source ", binary_source, '\n');
+        }
+
+        Strings::append(key_material, "asset-sources ", args.asset_sources_template().value_or(""), '\n');
+        Strings::append(
+            key_material, "exact-abi-tools ", args.exact_abi_tools_versions.value_or(false) ? "1\n" : "0\n");
+        Strings::append(key_material, "ports ", paths.builtin_ports_directory(), '\n');
+        Strings::append(key_material, "registry-versions ", paths.builtin_registry_versions, '\n');
+        if (args.default_visual_studio_path)
+        {
+            Strings::append(key_material, "visual-studio ", *args.default_visual_studio_path, '\n');
+        }
+
+        for (auto&& overlay : args.overlay_ports)
+        {
+            Strings::append(key_material, "overlay-port ", overlay, '\n');
+            append_tree_identity(key_material, fs, overlay);
+        }
+
+        for (auto&& overlay : args.overlay_triplets)
+        {
+            Strings::append(key_material, "overlay-triplet ", overlay, '\n');
+            append_tree_identity(key_material, fs, overlay);
+        }
+
+        append_tree_identity(key_material, fs, paths.triplets);
+        append_tree_identity(key_material, fs, paths.scripts);
+        return Hash::get_string_hash(key_material, Hash::Algorithm::Sha256);
+    }
+
+    ManifestBuildInputs collect_manifest_build_inputs(const VcpkgPaths& paths,
+                                                      View<Dependencies::InstallPlanAction> actions)
+    {
+        ManifestBuildInputs result;
+        std::vector<Path> port_inputs;
+        for (auto&& action : actions)
+        {
+            if (auto scfl = action.source_control_file_and_location.get())
+            {
+                port_inputs.push_back(scfl->source_location);
+            }
+
+            if (auto registry = paths.get_registry_set().registry_for_port(action.spec.name()))
+            {
+                registry->get_mutable_inputs(action.spec.name(), port_inputs);
+            }
+
+            auto abi_info = action.abi_info.get();
+            if (!abi_info || !abi_info->pre_build_info)
+            {
+                result.complete = false;
+                continue;
+            }
+
+            const auto& env_vars = abi_info->pre_build_info->passthrough_env_vars;
+            result.env_vars.insert(env_vars.begin(), env_vars.end());
+            if (auto compiler_info = abi_info->compiler_info.get())
+            {
+                if (!compiler_info->hash.empty() && compiler_info->paths.empty())
+                {
+                    result.complete = false;
+                }
+
+                result.compilers.insert(compiler_info->paths.begin(), compiler_info->paths.end());
+            }
+        }
+
+        for (auto&& port_input : port_inputs)
+        {
+            result.port_inputs.insert(port_input.native());
+        }
+
+        return result;
+    }
+
+    // Combines the inputs with the state of the installed tree, which the install itself changes, and with the build
+    // inputs the install found: the values of the triplets' passthrough variables and the identity of their compilers.
+    static std::string compute_manifest_install_fingerprint(const VcpkgPaths& paths,
+                                                            StringView inputs_fingerprint,
+                                                            const ManifestBuildInputs& build_inputs)
+    {
+        const auto& fs = paths.get_filesystem();
+        const auto& installed = paths.installed();
+        std::string key_material;
+        Strings::append(key_material, "inputs ", inputs_fingerprint, '\n');
+        Build::append_file_identity(key_material, fs, installed.lockfile_path());
+        Build::append_file_identity(key_material, fs, installed.vcpkg_dir_status_file());
+        append_tree_identity(key_material, fs, installed.vcpkg_dir_updates());
+        const std::vector<std::string> env_vars(build_inputs.env_vars.begin(), build_inputs.env_vars.end());
+        Build::append_build_environment_identity(key_material, env_vars);
+        for (auto&& compiler : build_inputs.compilers)
+        {
+            Build::append_file_identity(key_material, fs, compiler);
+        }
+
+        for (auto&& port_input : build_inputs.port_inputs)
+        {
+            if (fs.is_directory(port_input))
+            {
+                append_tree_identity(key_material, fs, port_input);
+            }
+            else
+            {
+                Build::append_file_identity(key_material, fs, port_input);
+            }
+        }
+
+        return Hash::get_string_hash(key_material, Hash::Algorithm::Sha256);
+    }
+
+    static constexpr int MANIFEST_FINGERPRINT_VERSION = 2;
+
+    void write_manifest_install_fingerprint(const VcpkgPaths& paths,
+                                            StringView inputs_fingerprint,
+                                            const ManifestBuildInputs& build_inputs)
+    {
+        auto& fs = paths.get_filesystem();
+        const auto fingerprint_path = paths.installed().manifest_fingerprint_path();
+        if (!build_inputs.complete)
+        {
+            Debug::print("Not writing ", fingerprint_path, ": the compilers in use are not known\n");
+            fs.remove(fingerprint_path, IgnoreErrors{});
+            return;
+        }
+
+        // the build inputs are recorded so that the next run can check them without computing ABIs
+        Json::Object root;
+        root.insert("version", Json::Value::integer(MANIFEST_FINGERPRINT_VERSION));
+        root.insert("fingerprint",
+                    Json::Value::string(compute_manifest_install_fingerprint(paths, inputs_fingerprint, build_inputs)));
+        auto& env_vars = root.insert("env", Json::Array{});
+        for (auto&& env_var : build_inputs.env_vars)
+        {
+            env_vars.push_back(Json::Value::string(env_var));
+        }
+
+        auto& compilers = root.insert("compilers", Json::Array{});
+        for (auto&& compiler : build_inputs.compilers)
+        {
+            compilers.push_back(Json::Value::string(compiler));
+        }
+
+        auto& port_inputs = root.insert("ports", Json::Array{});
+        for (auto&& port_input : build_inputs.port_inputs)
+        {
+            port_inputs.push_back(Json::Value::string(port_input));
+        }
+
+        std::error_code ec;
+        const auto temp_file = fingerprint_path + Strings::concat(".", get_process_id(), ".tmp");
+        fs.write_contents(temp_file, Json::stringify(root, {}), ec);
+        if (!ec)
+        {
+            fs.rename(temp_file, fingerprint_path, ec);
+        }
+
+        if (ec)
+        {
+            Debug::print("Failed to write manifest install fingerprint ", fingerprint_path, ": ", ec.message(), '\n');
+            fs.remove(temp_file, IgnoreErrors{});
+        }
+    }
+
+    // returns the recorded build inputs and the fingerprint computed from them
+    static Optional<std::pair<ManifestBuildInputs, std::string>> parse_manifest_fingerprint(const Json::Value& json)
+    {
+        if (!json.is_object())
+        {
+            return nullopt;
+        }
+
+        const auto& obj = json.object();
+        auto version = obj.get("version");
+        auto fingerprint = obj.get("fingerprint");
+        auto env_vars = obj.get("env");
+        auto compilers = obj.get("compilers");
+        auto port_inputs = obj.get("ports");
+        if (!version || !version->is_integer() || version->integer() != MANIFEST_FINGERPRINT_VERSION ||
+            !fingerprint || !fingerprint->is_string() || !env_vars || !env_vars->is_array() || !compilers ||
+            !compilers->is_array() || !port_inputs || !port_inputs->is_array())
+        {
+            return nullopt;
+        }
+
+        std::pair<ManifestBuildInputs, std::string> result;
+        result.second = fingerprint->string().to_string();
+        for (auto&& env_var : env_vars->array())
+        {
+            if (!env_var.is_string()) return nullopt;
+            result.first.env_vars.insert(env_var.string().to_string());
+        }
+
+        for (auto&& compiler : compilers->array())
+        {
+            if (!compiler.is_string()) return nullopt;
+            result.first.compilers.insert(compiler.string().to_string());
+        }
+
+        for (auto&& port_input : port_inputs->array())
+        {
+            if (!port_input.is_string()) return nullopt;
+            result.first.port_inputs.insert(port_input.string().to_string());
+        }
+
+        return result;
+    }
+
+    static bool manifest_install_is_up_to_date(const VcpkgPaths& paths, StringView inputs_fingerprint)
+    {
+        auto& fs = paths.get_filesystem();
+        const auto fingerprint_path = paths.installed().manifest_fingerprint_path();
+        std::error_code ec;
+        const auto previous = fs.read_contents(fingerprint_path, ec);
+        if (!ec)
+        {
+            auto maybe_json = Json::parse(previous, fingerprint_path);
+            if (auto json = maybe_json.get())
+            {
+                auto maybe_build_inputs = parse_manifest_fingerprint(json->first);
+                if (auto build_inputs = maybe_build_inputs.get())
+                {
+                    if (build_inputs->second ==
+                        compute_manifest_install_fingerprint(paths, inputs_fingerprint, build_inputs->first))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        // a failed install must not leave a fingerprint behind that a later run could match
+        fs.remove(fingerprint_path, IgnoreErrors{});
+        return false;
+    }
+
     void perform_and_exit(const VcpkgCmdArguments& args,
                           const VcpkgPaths& paths,
                           Triplet default_triplet,
@@ -880,6 +1612,7 @@ namespace vcpkg::Install
         const bool prohibit_backcompat_features =
             Util::Sets::contains(options.switches, (OPTION_PROHIBIT_BACKCOMPAT_FEATURES)) ||
             Util::Sets::contains(options.switches, (OPTION_ENFORCE_PORT_CHECKS));
+        const bool quiet_build = Util::Sets::contains(options.switches, OPTION_QUIET_BUILD);
         const auto unsupported_port_action = Util::Sets::contains(options.switches, OPTION_ALLOW_UNSUPPORTED_PORT)
                                                  ? Dependencies::UnsupportedPortAction::Warn
                                                  : Dependencies::UnsupportedPortAction::Error;
@@ -961,6 +1694,7 @@ namespace vcpkg::Install
             Build::PurgeDecompressFailure::NO,
             Util::Enum::to_enum<Build::Editable>(is_editable),
             prohibit_backcompat_features ? Build::BackcompatFeatures::PROHIBIT : Build::BackcompatFeatures::ALLOW,
+            quiet_build ? Build::BuildOutput::TAIL : Build::BuildOutput::FULL,
         };
 
         auto var_provider_storage = CMakeVars::make_triplet_cmake_var_provider(paths);
@@ -975,6 +1709,19 @@ namespace vcpkg::Install
                 LockGuardPtr<Metrics>(g_metrics)->track_property("x-write-nuget-packages-config", "defined");
                 pkgsconfig = Path(it_pkgsconfig->second);
             }
+
+            Optional<std::string> manifest_inputs_fingerprint;
+            if (!dry_run && !only_downloads && !pkgsconfig.has_value())
+            {
+                manifest_inputs_fingerprint =
+                    compute_manifest_inputs_fingerprint(args, paths, options, default_triplet, host_triplet);
+                if (manifest_install_is_up_to_date(paths, *manifest_inputs_fingerprint.get()))
+                {
+                    print2("All requested packages are currently installed.\n");
+                    Checks::exit_success(VCPKG_LINE_INFO);
+                }
+            }
+
             const auto& manifest_path = paths.get_manifest_path().value_or_exit(VCPKG_LINE_INFO);
             auto maybe_manifest_scf = SourceControlFile::parse_manifest_object(manifest_path, *manifest);
             if (!maybe_manifest_scf)
@@ -1048,6 +1795,9 @@ namespace vcpkg::Install
                 LockGuardPtr<Metrics>(g_metrics)->track_property("manifest_overrides", "defined");
             }
 
+            // fetch all registries up front, rather than one at a time as resolution reaches them
+            paths.get_registry_set().prefetch();
+
             auto verprovider = PortFileProvider::make_versioned_portfile_provider(paths);
             auto baseprovider = PortFileProvider::make_baseline_provider(paths);
 
@@ -1096,7 +1846,8 @@ namespace vcpkg::Install
                                                         std::move(install_plan),
                                                         dry_run ? Commands::DryRun::Yes : Commands::DryRun::No,
                                                         pkgsconfig,
-                                                        host_triplet);
+                                                        host_triplet,
+                                                        manifest_inputs_fingerprint);
         }
 
         PortFileProvider::PathsPortFileProvider provider(paths, args.overlay_ports);
@@ -1168,6 +1919,13 @@ namespace vcpkg::Install
 
         Dependencies::print_plan(action_plan, is_recursive, paths.builtin_ports_directory());
 
+        auto it_expected_abis = options.multisettings.find(OPTION_EXPECT_ABI);
+        if (it_expected_abis != options.multisettings.end())
+        {
+            Build::compute_all_abis(paths, action_plan, var_provider, status_db);
+            check_expected_abis(action_plan, it_expected_abis->second);
+        }
+
         auto it_pkgsconfig = options.settings.find(OPTION_WRITE_PACKAGES_CONFIG);
         if (it_pkgsconfig != options.settings.end())
         {
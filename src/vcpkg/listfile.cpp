@@ -0,0 +1,333 @@
+#include <vcpkg/base/checks.h>
+#include <vcpkg/base/span.h>
+#include <vcpkg/base/system.debug.h>
+#include <vcpkg/base/system.h>
+#include <vcpkg/base/util.h>
+
+#include <vcpkg/listfile.h>
+
+#include <algorithm>
+
+namespace
+{
+    using namespace vcpkg;
+
+    // The front-coded copy of a listfile is this magic, the size and last write time of the listfile it was made from,
+    // each a little-endian uint64_t, and the FrontCodedPaths encoding of the listfile's paths.
+    constexpr StringLiteral FRONT_CODED_LISTFILE_MAGIC = "vcpkg front-coded listfile 1\n";
+
+    // the FrontCodedPaths encoding is a little-endian uint32_t count of paths, the restart offsets, then the paths,
+    // each of which is a LEB128 length of the prefix shared with the previous path, a LEB128 length of the rest of the
+    // path, and the rest of the path
+    void append_u32(std::string& out, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+
+    void append_u64(std::string& out, uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+
+    uint64_t read_little_endian(const char* first, int size)
+    {
+        uint64_t result = 0;
+        for (int i = 0; i < size; ++i)
+        {
+            result |= static_cast<uint64_t>(static_cast<unsigned char>(first[i])) << (8 * i);
+        }
+
+        return result;
+    }
+
+    void append_varint(std::string& out, size_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<char>(0x80 | (value & 0x7F)));
+            value >>= 7;
+        }
+
+        out.push_back(static_cast<char>(value));
+    }
+
+    bool read_varint(const char*& first, const char* last, size_t& value)
+    {
+        value = 0;
+        for (int shift = 0; first != last && shift < 35; shift += 7)
+        {
+            const auto byte = static_cast<unsigned char>(*first++);
+            value |= static_cast<size_t>(byte & 0x7F) << shift;
+            if (byte < 0x80)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // restart paths are stored whole, so they can be viewed where they are
+    StringView whole_path(const char* entry)
+    {
+        size_t shared;
+        size_t rest;
+        read_varint(entry, entry + 10, shared);
+        read_varint(entry, entry + 10, rest);
+        return StringView{entry, rest};
+    }
+
+    uint32_t restart_count(uint32_t count)
+    {
+        return (count + FrontCodedPaths::RESTART_INTERVAL - 1) / FrontCodedPaths::RESTART_INTERVAL;
+    }
+}
+
+namespace vcpkg
+{
+    std::string FrontCodedPaths::encode(View<std::string> sorted_paths)
+    {
+        Checks::check_exit(VCPKG_LINE_INFO, sorted_paths.size() <= UINT32_MAX);
+        const auto count = static_cast<uint32_t>(sorted_paths.size());
+        std::string restarts;
+        std::string entries;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const auto& path = sorted_paths[i];
+            size_t shared = 0;
+            if (i % RESTART_INTERVAL == 0)
+            {
+                Checks::check_exit(VCPKG_LINE_INFO, entries.size() <= UINT32_MAX);
+                append_u32(restarts, static_cast<uint32_t>(entries.size()));
+            }
+            else
+            {
+                const auto& previous = sorted_paths[i - 1];
+                const auto max_shared = std::min(previous.size(), path.size());
+                while (shared < max_shared && previous[shared] == path[shared])
+                {
+                    ++shared;
+                }
+            }
+
+            append_varint(entries, shared);
+            append_varint(entries, path.size() - shared);
+            entries.append(path, shared, std::string::npos);
+        }
+
+        std::string result;
+        append_u32(result, count);
+        result.append(restarts);
+        result.append(entries);
+        return result;
+    }
+
+    Optional<FrontCodedPaths> FrontCodedPaths::decode(StringView bytes)
+    {
+        if (bytes.size() < 4) return nullopt;
+        const auto count = static_cast<uint32_t>(read_little_endian(bytes.data(), 4));
+        const auto restarts_size = static_cast<size_t>(restart_count(count)) * 4;
+        if (bytes.size() - 4 < restarts_size) return nullopt;
+
+        const auto restarts = bytes.substr(4, restarts_size);
+        const auto entries = bytes.substr(4 + restarts_size);
+        const char* next = entries.begin();
+        size_t previous_size = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            size_t shared;
+            size_t rest;
+            if (i % RESTART_INTERVAL == 0 &&
+                read_little_endian(restarts.data() + (i / RESTART_INTERVAL) * 4, 4) !=
+                    static_cast<uint64_t>(next - entries.begin()))
+            {
+                return nullopt;
+            }
+
+            if (!read_varint(next, entries.end(), shared) || !read_varint(next, entries.end(), rest) ||
+                shared > previous_size || (i % RESTART_INTERVAL == 0 && shared != 0) ||
+                rest > static_cast<size_t>(entries.end() - next))
+            {
+                return nullopt;
+            }
+
+            next += rest;
+            previous_size = shared + rest;
+        }
+
+        if (next != entries.end()) return nullopt;
+        return FrontCodedPaths{count, restarts, entries};
+    }
+
+    FrontCodedPaths::const_iterator::const_iterator(const char* next, uint32_t index, uint32_t count)
+        : m_next(next), m_index(index), m_count(count)
+    {
+        if (m_index < m_count)
+        {
+            decode_path();
+        }
+    }
+
+    FrontCodedPaths::const_iterator& FrontCodedPaths::const_iterator::operator++()
+    {
+        if (++m_index < m_count)
+        {
+            decode_path();
+        }
+
+        return *this;
+    }
+
+    void FrontCodedPaths::const_iterator::decode_path()
+    {
+        // decode validated the encoding
+        size_t shared;
+        size_t rest;
+        read_varint(m_next, m_next + 10, shared);
+        read_varint(m_next, m_next + 10, rest);
+        m_path.resize(shared);
+        m_path.append(m_next, rest);
+        m_next += rest;
+    }
+
+    bool FrontCodedPaths::contains(StringView path) const
+    {
+        // finds the last restart path which is not after `path`, then decodes the paths after it
+        const auto restart_entry = [this](uint32_t restart) {
+            return m_entries.data() + read_little_endian(m_restarts.data() + restart * 4, 4);
+        };
+
+        uint32_t first = 0;
+        uint32_t last = restart_count(m_count);
+        while (first != last)
+        {
+            const auto middle = first + (last - first) / 2;
+            if (whole_path(restart_entry(middle)) <= path)
+            {
+                first = middle + 1;
+            }
+            else
+            {
+                last = middle;
+            }
+        }
+
+        if (first == 0) return false;
+        const auto restart = first - 1;
+        const auto block_end = std::min(m_count, (restart + 1) * RESTART_INTERVAL);
+        for (const_iterator it{restart_entry(restart), restart * RESTART_INTERVAL, block_end}; it.m_index < block_end;
+             ++it)
+        {
+            if (*it == path) return true;
+            if (path < *it) return false;
+        }
+
+        return false;
+    }
+
+    Listfile Listfile::load(const Filesystem& fs, const Path& listfile_path, std::error_code& ec)
+    {
+        Listfile result;
+        std::error_code front_coded_ec;
+        auto front_coded = fs.map_for_read(front_coded_listfile_path(listfile_path), front_coded_ec);
+        const auto bytes = front_coded.bytes();
+        if (!front_coded_ec && Strings::starts_with(bytes, FRONT_CODED_LISTFILE_MAGIC) &&
+            bytes.size() >= FRONT_CODED_LISTFILE_MAGIC.size() + 16)
+        {
+            // the copy is up to date if it was made from the listfile as it is now
+            const char* header = bytes.data() + FRONT_CODED_LISTFILE_MAGIC.size();
+            std::error_code stat_ec;
+            const auto size = fs.file_size(listfile_path, stat_ec);
+            const auto write_time = stat_ec ? 0 : fs.last_write_time(listfile_path, stat_ec);
+            if (!stat_ec && read_little_endian(header, 8) == size &&
+                read_little_endian(header + 8, 8) == static_cast<uint64_t>(write_time))
+            {
+                auto paths = FrontCodedPaths::decode(bytes.substr(FRONT_CODED_LISTFILE_MAGIC.size() + 16));
+                if (paths)
+                {
+                    result.m_file = std::move(front_coded);
+                    result.m_paths = std::move(paths);
+                    ec.clear();
+                    return result;
+                }
+
+                Debug::print("Ignoring the corrupted front-coded listfile for ", listfile_path, '\n');
+            }
+        }
+
+        result.m_file = fs.map_for_read(listfile_path, ec);
+        return result;
+    }
+
+    Listfile Listfile::load(const Filesystem& fs, const Path& listfile_path, LineInfo li)
+    {
+        std::error_code ec;
+        auto result = Listfile::load(fs, listfile_path, ec);
+        if (ec)
+        {
+            Checks::exit_with_message(li, "Error: failed to read the listfile %s: %s", listfile_path, ec.message());
+        }
+
+        return result;
+    }
+
+    Path front_coded_listfile_path(const Path& listfile_path) { return listfile_path + ".fc"; }
+
+    void write_listfile(Filesystem& fs, const Path& listfile_path, std::vector<std::string> paths)
+    {
+        Util::sort(paths);
+        // other processes may have the listfile mapped, so it is replaced rather than truncated
+        const auto temp_path = listfile_path + Strings::concat(".", get_process_id(), ".tmp");
+        fs.write_lines(temp_path, paths, VCPKG_LINE_INFO);
+        fs.rename(temp_path, listfile_path, VCPKG_LINE_INFO);
+        std::error_code ec;
+        write_front_coded_listfile(fs, listfile_path, std::move(paths), ec);
+        if (ec)
+        {
+            // the listfile itself is still usable
+            Debug::print("Failed to write the front-coded copy of ", listfile_path, ": ", ec.message(), '\n');
+        }
+    }
+
+    void write_front_coded_listfile(Filesystem& fs,
+                                    const Path& listfile_path,
+                                    std::vector<std::string> paths,
+                                    std::error_code& ec)
+    {
+        Util::sort_unique_erase(paths);
+        const auto size = fs.file_size(listfile_path, ec);
+        if (ec) return;
+        const auto write_time = fs.last_write_time(listfile_path, ec);
+        if (ec) return;
+
+        std::string contents = FRONT_CODED_LISTFILE_MAGIC.to_string();
+        append_u64(contents, size);
+        append_u64(contents, static_cast<uint64_t>(write_time));
+        contents.append(FrontCodedPaths::encode(paths));
+
+        const auto front_coded_path = front_coded_listfile_path(listfile_path);
+        const auto temp_path = front_coded_path + Strings::concat(".", get_process_id(), ".tmp");
+        fs.write_contents(temp_path, contents, ec);
+        if (!ec)
+        {
+            fs.rename(temp_path, front_coded_path, ec);
+        }
+
+        if (ec)
+        {
+            fs.remove(temp_path, IgnoreErrors{});
+        }
+    }
+
+    void remove_listfile(Filesystem& fs, const Path& listfile_path, LineInfo li)
+    {
+        fs.remove(front_coded_listfile_path(listfile_path), IgnoreErrors{});
+        fs.remove(listfile_path, li);
+    }
+}
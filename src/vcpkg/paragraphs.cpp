@@ -9,6 +9,7 @@
 #include <vcpkg/paragraphparser.h>
 #include <vcpkg/paragraphs.h>
 #include <vcpkg/registries.h>
+#include <vcpkg/versiondeserializers.h>
 
 static std::atomic<uint64_t> g_load_ports_stats(0);
 
@@ -312,6 +313,62 @@ namespace vcpkg::Paragraphs
         return error_info;
     }
 
+    Optional<Version> try_load_port_version(const Filesystem& fs, const Path& port_directory)
+    {
+        StatsTimer timer(g_load_ports_stats);
+
+        std::error_code ec;
+        const auto manifest_path = port_directory / "vcpkg.json";
+        const auto manifest = fs.read_contents(manifest_path, ec);
+        if (!ec)
+        {
+            auto maybe_json = Json::parse(manifest, manifest_path);
+            auto json = maybe_json.get();
+            if (!json || !json->first.is_object())
+            {
+                return nullopt;
+            }
+
+            Json::Reader r;
+            auto schemed_version = visit_required_schemed_deserializer("a manifest", r, json->first.object());
+            if (!r.errors().empty())
+            {
+                return nullopt;
+            }
+
+            return std::move(schemed_version.version);
+        }
+
+        auto maybe_pghs = get_paragraphs(fs, port_directory / "CONTROL");
+        auto pghs = maybe_pghs.get();
+        if (!pghs || pghs->empty())
+        {
+            return nullopt;
+        }
+
+        const auto& core = pghs->front();
+        const auto version = core.find("Version");
+        if (version == core.end())
+        {
+            return nullopt;
+        }
+
+        int port_version = 0;
+        const auto port_version_field = core.find("Port-Version");
+        if (port_version_field != core.end())
+        {
+            auto maybe_port_version = Strings::strto<int>(port_version_field->second.first);
+            if (!maybe_port_version)
+            {
+                return nullopt;
+            }
+
+            port_version = *maybe_port_version.get();
+        }
+
+        return Version{version->second.first, port_version};
+    }
+
     ParseExpected<SourceControlFile> try_load_port(const Filesystem& fs, const Path& port_directory)
     {
         StatsTimer timer(g_load_ports_stats);
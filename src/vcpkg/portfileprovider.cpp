@@ -1,5 +1,6 @@
 #include <vcpkg/base/json.h>
 #include <vcpkg/base/messages.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/system.debug.h>
 
 #include <vcpkg/configuration.h>
@@ -37,6 +38,19 @@ namespace
 
 namespace vcpkg::PortFileProvider
 {
+    std::vector<Optional<Version>> PortFileProvider::get_versions(View<std::string> port_names) const
+    {
+        return Util::fmap(port_names, [this](const std::string& port_name) -> Optional<Version> {
+            auto maybe_scfl = get_control_file(port_name);
+            if (auto scfl = maybe_scfl.get())
+            {
+                return scfl->source_control_file->to_version();
+            }
+
+            return nullopt;
+        });
+    }
+
     MapPortFileProvider::MapPortFileProvider(const std::unordered_map<std::string, SourceControlFileAndLocation>& map)
         : ports(map)
     {
@@ -80,6 +94,56 @@ namespace vcpkg::PortFileProvider
         }
     }
 
+    std::vector<Optional<Version>> PathsPortFileProvider::get_versions(View<std::string> port_names) const
+    {
+        // overlays replace the registries' ports, so they are loaded first; only the baseline versions of the rest
+        // are needed, which the registries can find without loading those ports
+        std::vector<Optional<Version>> versions(port_names.size());
+        std::vector<size_t> registry_indices;
+        std::vector<std::string> registry_names;
+        for (size_t i = 0; i < port_names.size(); ++i)
+        {
+            auto maybe_scfl = m_overlay->get_control_file(port_names[i]);
+            if (auto scfl = maybe_scfl.get())
+            {
+                versions[i] = scfl->source_control_file->to_version();
+            }
+            else
+            {
+                registry_indices.push_back(i);
+                registry_names.push_back(port_names[i]);
+            }
+        }
+
+        auto registry_versions = m_baseline->get_baseline_versions(registry_names);
+        for (size_t i = 0; i < registry_indices.size(); ++i)
+        {
+            versions[registry_indices[i]] = std::move(registry_versions[i]);
+        }
+
+        return versions;
+    }
+
+    std::vector<Optional<Version>> IBaselineProvider::get_baseline_versions(View<std::string> port_names) const
+    {
+        return Util::fmap(port_names, [this](const std::string& port_name) { return get_baseline_version(port_name); });
+    }
+
+    std::vector<const SourceControlFileAndLocation*> IVersionedPortfileProvider::prefetch_control_files(
+        View<VersionSpec> version_specs) const
+    {
+        return Util::fmap(version_specs, [this](const VersionSpec& version_spec) {
+            const SourceControlFileAndLocation* ret = nullptr;
+            auto maybe_scfl = get_control_file(version_spec);
+            if (auto scfl = maybe_scfl.get())
+            {
+                ret = scfl;
+            }
+
+            return ret;
+        });
+    }
+
     std::vector<const SourceControlFileAndLocation*> PathsPortFileProvider::load_all_control_files() const
     {
         std::map<std::string, const SourceControlFileAndLocation*> m;
@@ -102,6 +166,29 @@ namespace vcpkg::PortFileProvider
             BaselineProviderImpl(const BaselineProviderImpl&) = delete;
             BaselineProviderImpl& operator=(const BaselineProviderImpl&) = delete;
 
+            virtual std::vector<Optional<Version>> get_baseline_versions(View<std::string> port_names) const override
+            {
+                std::vector<std::string> uncached;
+                for (auto&& port_name : port_names)
+                {
+                    if (m_baseline_cache.find(port_name) == m_baseline_cache.end())
+                    {
+                        uncached.push_back(port_name);
+                    }
+                }
+
+                Util::sort_unique_erase(uncached);
+                auto versions = paths.get_registry_set().baseline_for_ports(uncached);
+                for (size_t i = 0; i < uncached.size(); ++i)
+                {
+                    m_baseline_cache.emplace(std::move(uncached[i]), std::move(versions[i]));
+                }
+
+                return Util::fmap(port_names, [this](const std::string& port_name) {
+                    return m_baseline_cache.find(port_name)->second;
+                });
+            }
+
             virtual Optional<Version> get_baseline_version(StringView port_name) const override
             {
                 auto it = m_baseline_cache.find(port_name);
@@ -224,6 +311,88 @@ namespace vcpkg::PortFileProvider
                 return it->second.map([](const auto& x) -> const SourceControlFileAndLocation& { return *x.get(); });
             }
 
+            virtual std::vector<const SourceControlFileAndLocation*> prefetch_control_files(
+                View<VersionSpec> version_specs) const override
+            {
+                // Registry entries are not thread safe, so all the versions of one port are loaded by the same task.
+                // Entries themselves are created up front on this thread.
+                struct PortWork
+                {
+                    const RegistryEntry* entry;
+                    std::vector<const VersionSpec*> version_specs;
+                    std::vector<std::unique_ptr<SourceControlFileAndLocation>> loaded;
+                };
+
+                std::map<StringView, PortWork> work_by_port;
+                for (auto&& version_spec : version_specs)
+                {
+                    if (Util::Sets::contains(m_control_cache, version_spec))
+                    {
+                        continue;
+                    }
+
+                    if (auto ent = entry(version_spec.port_name).get())
+                    {
+                        auto& work = work_by_port[version_spec.port_name];
+                        work.entry = ent->get();
+                        if (std::none_of(work.version_specs.begin(),
+                                         work.version_specs.end(),
+                                         [&](const VersionSpec* v) { return *v == version_spec; }))
+                        {
+                            work.version_specs.push_back(&version_spec);
+                        }
+                    }
+                }
+
+                auto work = Util::fmap(work_by_port, [](auto&& kv) { return std::move(kv.second); });
+                parallel_for_each_n(work.begin(), work.size(), [this](PortWork& port_work) {
+                    for (auto version_spec : port_work.version_specs)
+                    {
+                        std::unique_ptr<SourceControlFileAndLocation> scfl;
+                        auto maybe_path = port_work.entry->get_path_to_version(version_spec->version);
+                        if (auto path = maybe_path.get())
+                        {
+                            auto maybe_control_file = Paragraphs::try_load_port(m_fs, *path);
+                            if (auto scf = maybe_control_file.get())
+                            {
+                                if (scf->get()->to_version_spec() == *version_spec)
+                                {
+                                    scfl.reset(new SourceControlFileAndLocation{std::move(*scf), std::move(*path)});
+                                }
+                            }
+                        }
+
+                        port_work.loaded.push_back(std::move(scfl));
+                    }
+                });
+
+                // merge on this thread, in a deterministic order; only successes are cached
+                for (auto&& port_work : work)
+                {
+                    for (size_t idx = 0; idx < port_work.version_specs.size(); ++idx)
+                    {
+                        if (port_work.loaded[idx])
+                        {
+                            m_control_cache.emplace(*port_work.version_specs[idx], std::move(port_work.loaded[idx]));
+                        }
+                    }
+                }
+
+                return Util::fmap(version_specs, [this](const VersionSpec& version_spec) {
+                    const SourceControlFileAndLocation* ret = nullptr;
+                    auto it = m_control_cache.find(version_spec);
+                    if (it != m_control_cache.end())
+                    {
+                        if (auto scfl = it->second.get())
+                        {
+                            ret = scfl->get();
+                        }
+                    }
+
+                    return ret;
+                });
+            }
+
             virtual void load_all_control_files(
                 std::map<std::string, const SourceControlFileAndLocation*>& out) const override
             {
@@ -2,8 +2,11 @@
 #include <vcpkg/base/json.h>
 #include <vcpkg/base/jsonreader.h>
 #include <vcpkg/base/messages.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/system.debug.h>
+#include <vcpkg/base/system.h>
 #include <vcpkg/base/system.print.h>
+#include <vcpkg/base/util.h>
 
 #include <vcpkg/metrics.h>
 #include <vcpkg/paragraphs.h>
@@ -15,6 +18,7 @@
 #include <vcpkg/versions.h>
 
 #include <map>
+#include <mutex>
 
 namespace
 {
@@ -34,7 +38,7 @@ namespace
         ExpectedS<Path> get_path_to_version(const Version& version) const override;
 
     private:
-        void fill_data_from_path(const Filesystem& fs, const Path& port_versions_path) const;
+        void fill_data_from_path(const Path& port_versions_path) const;
 
         std::string port_name;
 
@@ -67,6 +71,8 @@ namespace
 
         Optional<Version> get_baseline_version(StringView) const override;
 
+        void prefetch() const override;
+
     private:
         friend struct GitRegistryEntry;
 
@@ -139,12 +145,20 @@ namespace
             return {*m_stale_versions_tree.get(), true};
         }
 
+        // the packed database of the versions tree at `versions_tree`, or nullptr if it can't be built
+        const PackedVersionsDb* get_versions_db(const Path& versions_tree) const;
+        ExpectedS<std::vector<VersionDbEntry>> load_port_versions(const Path& versions_tree,
+                                                                  StringView port_name) const;
+
         const VcpkgPaths& m_paths;
 
         std::string m_repo;
         std::string m_reference;
         std::string m_baseline_identifier;
         DelayedInit<LockFile::Entry> m_lock_entry;
+        // get_versions_db may be called from several threads at once
+        mutable std::mutex m_versions_dbs_mtx;
+        Cache<std::string, ExpectedS<PackedVersionsDb>> m_versions_dbs;
         mutable Optional<Path> m_stale_versions_tree;
         DelayedInit<Path> m_versions_tree;
         DelayedInit<Baseline> m_baseline;
@@ -236,11 +250,18 @@ namespace
 
         Optional<Version> get_baseline_version(StringView port_name) const override;
 
+        std::vector<Optional<Version>> get_baseline_versions(View<std::string> port_names) const override;
+
         Optional<Path> get_path_to_baseline_version(StringView port_name) const override
         {
             return m_builtin_ports_directory / port_name;
         }
 
+        void get_mutable_inputs(StringView port_name, std::vector<Path>& out) const override
+        {
+            out.push_back(m_builtin_ports_directory / port_name);
+        }
+
         ~BuiltinFilesRegistry() = default;
 
         DelayedInit<Baseline> m_baseline;
@@ -284,6 +305,8 @@ namespace
 
         Optional<Version> get_baseline_version(StringView port_name) const override;
 
+        void get_mutable_inputs(StringView port_name, std::vector<Path>& out) const override;
+
         ~BuiltinGitRegistry() = default;
 
         std::string m_baseline_identifier;
@@ -344,6 +367,8 @@ namespace
 
         Optional<Version> get_baseline_version(StringView) const override;
 
+        void get_mutable_inputs(StringView port_name, std::vector<Path>& out) const override;
+
     private:
         const Filesystem& m_fs;
 
@@ -494,6 +519,26 @@ namespace
         Checks::exit_maybe_upgrade(VCPKG_LINE_INFO, "Error: failed to load port from %s", port_path);
     }
 
+    std::vector<Optional<Version>> BuiltinFilesRegistry::get_baseline_versions(View<std::string> port_names) const
+    {
+        // Only the versions are needed, so read them without loading the rest of each port, in parallel. Ports whose
+        // versions can't be read that way are loaded as usual, which reports why they failed.
+        std::vector<Optional<Version>> versions(port_names.size());
+        parallel_transform(port_names.begin(), port_names.size(), versions.begin(), [this](const std::string& name) {
+            return Paragraphs::try_load_port_version(m_fs, m_builtin_ports_directory / name);
+        });
+
+        for (size_t i = 0; i < versions.size(); ++i)
+        {
+            if (!versions[i])
+            {
+                versions[i] = get_baseline_version(port_names[i]);
+            }
+        }
+
+        return versions;
+    }
+
     void BuiltinFilesRegistry::get_all_port_names(std::vector<std::string>& out) const
     {
         std::error_code ec;
@@ -577,6 +622,13 @@ namespace
 
         m_files_impl->get_all_port_names(out);
     }
+
+    void BuiltinGitRegistry::get_mutable_inputs(StringView port_name, std::vector<Path>& out) const
+    {
+        // the baseline comes from a commit, but the versions files and ports are read from the working tree
+        out.push_back(m_paths.builtin_registry_versions / relative_path_to_versions(port_name));
+        m_files_impl->get_mutable_inputs(port_name, out);
+    }
     // } BuiltinGitRegistry::RegistryImplementation
 
     // { FilesystemRegistry::RegistryImplementation
@@ -639,6 +691,12 @@ namespace
     {
         load_all_port_names_from_registry_versions(out, m_fs, m_path / registry_versions_dir_name);
     }
+
+    void FilesystemRegistry::get_mutable_inputs(StringView port_name, std::vector<Path>& out) const
+    {
+        out.push_back(m_path / registry_versions_dir_name / "baseline.json");
+        out.push_back(m_path / registry_versions_dir_name / relative_path_to_versions(port_name));
+    }
     // } FilesystemRegistry::RegistryImplementation
 
     // { GitRegistry::RegistryImplementation
@@ -652,7 +710,7 @@ namespace
     {
         auto vtp = parent.get_stale_versions_tree_path();
         stale = vtp.stale;
-        fill_data_from_path(parent.m_paths.get_filesystem(), vtp.p);
+        fill_data_from_path(vtp.p);
     }
 
     Optional<Version> GitRegistry::get_baseline_version(StringView port_name) const
@@ -746,11 +804,106 @@ namespace
         return nullopt;
     }
 
+    void GitRegistry::prefetch() const
+    {
+        auto maybe_lock_entry = m_paths.get_installed_lockfile().try_get_or_fetch(m_paths, m_repo, m_reference);
+        auto lock_entry = maybe_lock_entry.get();
+        if (!lock_entry)
+        {
+            Debug::print("Failed to prefetch registry ", m_repo, ":\n", maybe_lock_entry.error(), '\n');
+            return;
+        }
+
+        m_lock_entry.get([lock_entry]() { return *lock_entry; });
+
+        if (is_git_commit_sha(m_baseline_identifier))
+        {
+            auto path_to_baseline = Path(registry_versions_dir_name.to_string()) / "baseline.json";
+            auto maybe_contents = m_paths.git_show_from_remote_registry(m_baseline_identifier, path_to_baseline);
+            if (!maybe_contents.has_value())
+            {
+                print2("Fetching baseline information from ", m_repo, "...\n");
+                if (!m_paths.git_fetch(m_repo, m_baseline_identifier).has_value())
+                {
+                    maybe_contents = m_paths.git_show_from_remote_registry(m_baseline_identifier, path_to_baseline);
+                }
+            }
+
+            if (auto contents = maybe_contents.get())
+            {
+                auto res_baseline = parse_baseline_versions(*contents, "default", path_to_baseline);
+                if (auto opt_baseline = res_baseline.get())
+                {
+                    if (auto p = opt_baseline->get())
+                    {
+                        m_baseline.get([p]() { return std::move(*p); });
+                    }
+                }
+            }
+        }
+
+        auto maybe_tree = m_paths.git_find_object_id_for_remote_registry_path(
+            lock_entry->commit_id(), registry_versions_dir_name.to_string());
+        if (auto tree = maybe_tree.get())
+        {
+            auto maybe_path = m_paths.git_checkout_object_from_remote_registry(*tree);
+            if (auto path = maybe_path.get())
+            {
+                if (lock_entry->stale())
+                {
+                    m_stale_versions_tree = std::move(*path);
+                }
+                else
+                {
+                    m_versions_tree.get([path]() { return std::move(*path); });
+                }
+            }
+        }
+    }
+
     void GitRegistry::get_all_port_names(std::vector<std::string>& out) const
     {
         auto versions_path = get_stale_versions_tree_path();
+        if (auto db = get_versions_db(versions_path.p))
+        {
+            Util::Vectors::append(&out, db->port_names());
+            return;
+        }
+
         load_all_port_names_from_registry_versions(out, m_paths.get_filesystem(), versions_path.p);
     }
+
+    const PackedVersionsDb* GitRegistry::get_versions_db(const Path& versions_tree) const
+    {
+        std::lock_guard<std::mutex> lock(m_versions_dbs_mtx);
+        const auto& maybe_db = m_versions_dbs.get_lazy(versions_tree.native(), [&]() {
+            auto db = PackedVersionsDb::load_or_build(m_paths.get_filesystem(), versions_tree);
+            if (!db.has_value())
+            {
+                Debug::print("Reading the versions files of ", versions_tree, " one by one: ", db.error(), '\n');
+            }
+
+            return db;
+        });
+
+        return maybe_db.get();
+    }
+
+    ExpectedS<std::vector<VersionDbEntry>> GitRegistry::load_port_versions(const Path& versions_tree,
+                                                                           StringView port_name) const
+    {
+        if (auto db = get_versions_db(versions_tree))
+        {
+            auto maybe_entries = db->find(port_name);
+            if (auto entries = maybe_entries.get())
+            {
+                return std::move(*entries);
+            }
+        }
+
+        // also reports why the port has no versions
+        return load_versions_file(m_paths.get_filesystem(), VersionDbType::Git, versions_tree, port_name);
+    }
     // } GitRegistry::RegistryImplementation
 
     // } RegistryImplementation
@@ -798,7 +951,7 @@ namespace
     {
         if (stale)
         {
-            fill_data_from_path(parent.m_paths.get_filesystem(), parent.get_versions_tree_path());
+            fill_data_from_path(parent.get_versions_tree_path());
             stale = false;
         }
         return port_versions;
@@ -808,7 +961,7 @@ namespace
         auto it = std::find(port_versions.begin(), port_versions.end(), version);
         if (it == port_versions.end() && stale)
         {
-            fill_data_from_path(parent.m_paths.get_filesystem(), parent.get_versions_tree_path());
+            fill_data_from_path(parent.get_versions_tree_path());
             stale = false;
             it = std::find(port_versions.begin(), port_versions.end(), version);
         }
@@ -830,9 +983,9 @@ namespace
         return parent.m_paths.git_checkout_object_from_remote_registry(git_tree);
     }
 
-    void GitRegistryEntry::fill_data_from_path(const Filesystem& fs, const Path& port_versions_path) const
+    void GitRegistryEntry::fill_data_from_path(const Path& port_versions_path) const
     {
-        auto maybe_version_entries = load_versions_file(fs, VersionDbType::Git, port_versions_path, port_name);
+        auto maybe_version_entries = parent.load_port_versions(port_versions_path, port_name);
         Checks::check_maybe_upgrade(
             VCPKG_LINE_INFO, maybe_version_entries.has_value(), "Error: " + maybe_version_entries.error());
         auto version_entries = std::move(maybe_version_entries).value_or_exit(VCPKG_LINE_INFO);
@@ -1021,6 +1174,15 @@ Optional<Path> RegistryImplementation::get_path_to_baseline_version(StringView p
     return nullopt;
 }
 
+std::vector<Optional<Version>> RegistryImplementation::get_baseline_versions(View<std::string> port_names) const
+{
+    return Util::fmap(port_names, [this](const std::string& port_name) { return get_baseline_version(port_name); });
+}
+
+void RegistryImplementation::prefetch() const { }
+
+void RegistryImplementation::get_mutable_inputs(StringView, std::vector<Path>&) const { }
+
 namespace vcpkg
 {
     constexpr StringLiteral VersionDbEntryDeserializer::GIT_TREE;
@@ -1140,35 +1302,74 @@ namespace vcpkg
 
     LockFile::Entry LockFile::get_or_fetch(const VcpkgPaths& paths, StringView repo, StringView reference)
     {
-        auto range = lockdata.equal_range(repo);
-        auto it = std::find_if(range.first, range.second, [&reference](const LockDataType::value_type& repo2entry) {
-            return repo2entry.second.reference == reference;
-        });
+        return try_get_or_fetch(paths, repo, reference).value_or_exit(VCPKG_LINE_INFO);
+    }
+
+    ExpectedS<LockFile::Entry> LockFile::try_get_or_fetch(const VcpkgPaths& paths,
+                                                          StringView repo,
+                                                          StringView reference)
+    {
+        const auto find_entry = [this, repo, reference]() {
+            auto range = lockdata.equal_range(repo);
+            auto it =
+                std::find_if(range.first, range.second, [&reference](const LockDataType::value_type& repo2entry) {
+                    return repo2entry.second.reference == reference;
+                });
+            return it == range.second ? lockdata.end() : it;
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(*m_mutex);
+            auto it = find_entry();
+            if (it != lockdata.end())
+            {
+                return Entry{this, it};
+            }
+        }
 
-        if (it == range.second)
+        // fetch without holding the lock, so that other registries can be fetched at the same time
+        print2("Fetching registry information from ", repo, " (", reference, ")...\n");
+        auto maybe_commit_id = paths.git_fetch_from_remote_registry(repo, reference);
+        auto commit_id = maybe_commit_id.get();
+        if (!commit_id)
         {
-            print2("Fetching registry information from ", repo, " (", reference, ")...\n");
-            auto x = paths.git_fetch_from_remote_registry(repo, reference);
-            it = lockdata.emplace(repo.to_string(),
-                                  EntryData{reference.to_string(), x.value_or_exit(VCPKG_LINE_INFO), false});
+            return {std::move(maybe_commit_id).error(), expected_right_tag};
+        }
+
+        std::lock_guard<std::mutex> lock(*m_mutex);
+        // another thread may have fetched the same reference in the meantime
+        auto it = find_entry();
+        if (it == lockdata.end())
+        {
+            it = lockdata.emplace(repo.to_string(), EntryData{reference.to_string(), std::move(*commit_id), false});
             modified = true;
         }
 
-        return {this, it};
+        return Entry{this, it};
     }
+
     void LockFile::Entry::ensure_up_to_date(const VcpkgPaths& paths) const
     {
-        if (data->second.stale)
+        StringView repo;
+        StringView reference;
         {
-            StringView repo(data->first);
-            StringView reference(data->second.reference);
-            print2("Fetching registry information from ", repo, " (", reference, ")...\n");
+            std::lock_guard<std::mutex> lock(*lockfile->m_mutex);
+            if (!data->second.stale)
+            {
+                return;
+            }
 
-            data->second.commit_id =
-                paths.git_fetch_from_remote_registry(repo, reference).value_or_exit(VCPKG_LINE_INFO);
-            data->second.stale = false;
-            lockfile->modified = true;
+            repo = data->first;
+            reference = data->second.reference;
         }
+
+        print2("Fetching registry information from ", repo, " (", reference, ")...\n");
+        auto commit_id = paths.git_fetch_from_remote_registry(repo, reference).value_or_exit(VCPKG_LINE_INFO);
+
+        std::lock_guard<std::mutex> lock(*lockfile->m_mutex);
+        data->second.commit_id = std::move(commit_id);
+        data->second.stale = false;
+        lockfile->modified = true;
     }
 
     Registry::Registry(std::vector<std::string>&& packages, std::unique_ptr<RegistryImplementation>&& impl)
@@ -1191,6 +1392,24 @@ namespace vcpkg
         return default_registry();
     }
 
+    void RegistrySet::prefetch() const
+    {
+        std::vector<const RegistryImplementation*> implementations;
+        if (default_registry_)
+        {
+            implementations.push_back(default_registry_.get());
+        }
+
+        for (auto&& registry : registries_)
+        {
+            implementations.push_back(&registry.implementation());
+        }
+
+        parallel_for_each_n(implementations.begin(),
+                            implementations.size(),
+                            [](const RegistryImplementation* implementation) { implementation->prefetch(); });
+    }
+
     Optional<Version> RegistrySet::baseline_for_port(StringView port_name) const
     {
         auto impl = registry_for_port(port_name);
@@ -1198,6 +1417,31 @@ namespace vcpkg
         return impl->get_baseline_version(port_name);
     }
 
+    std::vector<Optional<Version>> RegistrySet::baseline_for_ports(View<std::string> port_names) const
+    {
+        std::map<const RegistryImplementation*, std::vector<size_t>> indices_by_registry;
+        for (size_t i = 0; i < port_names.size(); ++i)
+        {
+            if (auto impl = registry_for_port(port_names[i]))
+            {
+                indices_by_registry[impl].push_back(i);
+            }
+        }
+
+        std::vector<Optional<Version>> versions(port_names.size());
+        for (auto&& registry : indices_by_registry)
+        {
+            const auto names = Util::fmap(registry.second, [&](size_t i) { return port_names[i]; });
+            auto registry_versions = registry.first->get_baseline_versions(names);
+            for (size_t i = 0; i < registry.second.size(); ++i)
+            {
+                versions[registry.second[i]] = std::move(registry_versions[i]);
+            }
+        }
+
+        return versions;
+    }
+
     bool RegistrySet::is_default_builtin_registry() const
     {
         return default_registry_ && default_registry_->kind() == BuiltinFilesRegistry::s_kind;
@@ -1279,4 +1523,278 @@ namespace vcpkg
     {
         return std::make_unique<FilesystemRegistry>(fs, std::move(path), std::move(baseline));
     }
+
+    // A packed versions database is:
+    //   the magic string, the number of ports, and the number of entries;
+    //   the ports, sorted by name: name offset, name size, first entry, entry count;
+    //   the entries of every port in order: version offset, version size, port version, scheme, git tree offset,
+    //   git tree size;
+    //   the strings, at which the offsets point.
+    // Every number is a little-endian 32-bit unsigned integer.
+    static constexpr StringLiteral packed_versions_db_magic = "vcpkg packed versions database v1\n";
+    static constexpr size_t packed_port_size = 4 * 4;
+    static constexpr size_t packed_entry_size = 6 * 4;
+
+    static void append_u32(std::string& out, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    static uint32_t read_u32(const char* p)
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            value |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+        }
+
+        return value;
+    }
+
+    static Optional<StringView> packed_string(StringView strings, const char* offset_and_size)
+    {
+        const uint64_t offset = read_u32(offset_and_size);
+        const uint64_t size = read_u32(offset_and_size + 4);
+        if (offset + size > strings.size())
+        {
+            return nullopt;
+        }
+
+        return StringView{strings.data() + offset, static_cast<size_t>(size)};
+    }
+
+    ExpectedS<std::string> PackedVersionsDb::pack(const Filesystem& fs, const Path& registry_versions)
+    {
+        std::error_code ec;
+        std::vector<std::string> names;
+        for (auto&& super_directory : fs.get_directories_non_recursive(registry_versions, ec))
+        {
+            for (auto&& file : fs.get_regular_files_non_recursive(super_directory, ec))
+            {
+                auto filename = file.filename();
+                if (!Strings::case_insensitive_ascii_ends_with(filename, ".json")) continue;
+
+                auto port_name = filename.substr(0, filename.size() - 5);
+                if (!Strings::ends_with(filename, ".json") ||
+                    !Json::PackageNameDeserializer::is_package_name(port_name))
+                {
+                    return {Strings::concat("Error: found invalid port version file name: `", file, "`."),
+                            expected_right_tag};
+                }
+
+                names.push_back(port_name.to_string());
+            }
+
+            if (ec) break;
+        }
+
+        if (ec)
+        {
+            return {Strings::concat("Error: failed to enumerate ", registry_versions, ": ", ec.message()),
+                    expected_right_tag};
+        }
+
+        Util::sort_unique_erase(names);
+        std::vector<ExpectedS<std::vector<VersionDbEntry>>> versions(names.size());
+        parallel_transform(names.begin(), names.size(), versions.begin(), [&](const std::string& name) {
+            return load_versions_file(fs, VersionDbType::Git, registry_versions, name);
+        });
+
+        std::string ports;
+        std::string entries;
+        std::string strings;
+        uint32_t entry_count = 0;
+        const auto append_string = [&](std::string& out, StringView sv) {
+            append_u32(out, static_cast<uint32_t>(strings.size()));
+            append_u32(out, static_cast<uint32_t>(sv.size()));
+            strings.append(sv.data(), sv.size());
+        };
+
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            auto port_entries = versions[i].get();
+            if (!port_entries)
+            {
+                return {std::move(versions[i]).error(), expected_right_tag};
+            }
+
+            append_string(ports, names[i]);
+            append_u32(ports, entry_count);
+            append_u32(ports, static_cast<uint32_t>(port_entries->size()));
+            for (auto&& entry : *port_entries)
+            {
+                append_string(entries, entry.version.text());
+                append_u32(entries, static_cast<uint32_t>(entry.version.port_version()));
+                append_u32(entries, static_cast<uint32_t>(entry.scheme));
+                append_string(entries, entry.git_tree);
+                ++entry_count;
+            }
+        }
+
+        if (strings.size() > UINT32_MAX)
+        {
+            return {Strings::concat("Error: the versions database of ", registry_versions, " is too large to pack."),
+                    expected_right_tag};
+        }
+
+        std::string db = packed_versions_db_magic.to_string();
+        append_u32(db, static_cast<uint32_t>(names.size()));
+        append_u32(db, entry_count);
+        db.append(ports);
+        db.append(entries);
+        db.append(strings);
+        return {std::move(db), expected_left_tag};
+    }
+
+    ExpectedS<PackedVersionsDb> PackedVersionsDb::open(const Filesystem& fs, const Path& db_path)
+    {
+        std::error_code ec;
+        PackedVersionsDb db(fs.map_for_read(db_path, ec));
+        if (ec)
+        {
+            return Strings::concat("Error: failed to open ", db_path, ": ", ec.message());
+        }
+
+        const auto invalid = Strings::concat("Error: ", db_path, " is not a valid versions database.");
+        const auto bytes = db.m_file.bytes();
+        const auto header_size = packed_versions_db_magic.size() + 8;
+        if (bytes.size() < header_size || !Strings::starts_with(bytes, packed_versions_db_magic))
+        {
+            return invalid;
+        }
+
+        db.m_port_count = read_u32(bytes.data() + packed_versions_db_magic.size());
+        db.m_entry_count = read_u32(bytes.data() + packed_versions_db_magic.size() + 4);
+        const uint64_t tables_size =
+            uint64_t(db.m_port_count) * packed_port_size + uint64_t(db.m_entry_count) * packed_entry_size;
+        if (bytes.size() - header_size < tables_size)
+        {
+            return invalid;
+        }
+
+        db.m_ports = bytes.data() + header_size;
+        db.m_entries = db.m_ports + uint64_t(db.m_port_count) * packed_port_size;
+        db.m_strings = StringView{db.m_entries + uint64_t(db.m_entry_count) * packed_entry_size, bytes.end()};
+
+        // checking everything once, without parsing anything, lets lookups trust the database
+        for (uint32_t port = 0; port < db.m_port_count; ++port)
+        {
+            const auto p = db.m_ports + uint64_t(port) * packed_port_size;
+            if (!packed_string(db.m_strings, p) || uint64_t(read_u32(p + 8)) + read_u32(p + 12) > db.m_entry_count ||
+                (port != 0 && !(db.port_name(port - 1) < db.port_name(port))))
+            {
+                return invalid;
+            }
+        }
+
+        for (uint32_t entry = 0; entry < db.m_entry_count; ++entry)
+        {
+            const auto p = db.m_entries + uint64_t(entry) * packed_entry_size;
+            if (!packed_string(db.m_strings, p) || !packed_string(db.m_strings, p + 16) ||
+                read_u32(p + 12) > static_cast<uint32_t>(VersionScheme::String))
+            {
+                return invalid;
+            }
+        }
+
+        return db;
+    }
+
+    Path PackedVersionsDb::path_for(const Path& registry_versions) { return registry_versions + ".versions.db"; }
+
+    ExpectedS<PackedVersionsDb> PackedVersionsDb::load_or_build(Filesystem& fs, const Path& registry_versions)
+    {
+        const auto db_path = path_for(registry_versions);
+        auto maybe_db = open(fs, db_path);
+        if (maybe_db.has_value())
+        {
+            return maybe_db;
+        }
+
+        Debug::print("Building the versions database ", db_path, '\n');
+        auto maybe_packed = pack(fs, registry_versions);
+        if (!maybe_packed.has_value())
+        {
+            return std::move(maybe_packed).error();
+        }
+
+        // concurrent builders write the same contents, so whichever rename comes last is fine
+        std::error_code ec;
+        // the store of git trees removes temporaries which were left behind, by the ".tmp" in their names
+        const auto temp_path = db_path + Strings::concat(".tmp", get_process_id());
+        fs.write_contents(temp_path, *maybe_packed.get(), ec);
+        if (!ec)
+        {
+            fs.rename(temp_path, db_path, ec);
+        }
+
+        if (ec)
+        {
+            fs.remove(temp_path, IgnoreErrors{});
+            return Strings::concat("Error: failed to write ", db_path, ": ", ec.message());
+        }
+
+        return open(fs, db_path);
+    }
+
+    StringView PackedVersionsDb::port_name(uint32_t port) const
+    {
+        return packed_string(m_strings, m_ports + uint64_t(port) * packed_port_size).value_or_exit(VCPKG_LINE_INFO);
+    }
+
+    Optional<std::vector<VersionDbEntry>> PackedVersionsDb::find(StringView name) const
+    {
+        uint32_t first = 0;
+        uint32_t last = m_port_count;
+        while (first < last)
+        {
+            const uint32_t middle = first + (last - first) / 2;
+            if (port_name(middle) < name)
+            {
+                first = middle + 1;
+            }
+            else
+            {
+                last = middle;
+            }
+        }
+
+        if (first == m_port_count || port_name(first) != name)
+        {
+            return nullopt;
+        }
+
+        const auto port = m_ports + uint64_t(first) * packed_port_size;
+        const uint32_t first_entry = read_u32(port + 8);
+        const uint32_t entry_count = read_u32(port + 12);
+        std::vector<VersionDbEntry> entries;
+        entries.reserve(entry_count);
+        for (uint32_t i = 0; i < entry_count; ++i)
+        {
+            const auto p = m_entries + (uint64_t(first_entry) + i) * packed_entry_size;
+            VersionDbEntry entry;
+            entry.version = Version{packed_string(m_strings, p).value_or_exit(VCPKG_LINE_INFO).to_string(),
+                                    static_cast<int>(read_u32(p + 8))};
+            entry.scheme = static_cast<VersionScheme>(read_u32(p + 12));
+            entry.git_tree = packed_string(m_strings, p + 16).value_or_exit(VCPKG_LINE_INFO).to_string();
+            entries.push_back(std::move(entry));
+        }
+
+        return entries;
+    }
+
+    std::vector<std::string> PackedVersionsDb::port_names() const
+    {
+        std::vector<std::string> names;
+        names.reserve(m_port_count);
+        for (uint32_t port = 0; port < m_port_count; ++port)
+        {
+            names.push_back(port_name(port).to_string());
+        }
+
+        return names;
+    }
 }
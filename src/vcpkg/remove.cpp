@@ -1,3 +1,5 @@
+#include <vcpkg/base/parallel-algorithms.h>
+#include <vcpkg/base/system.h>
 #include <vcpkg/base/system.print.h>
 #include <vcpkg/base/util.h>
 
@@ -6,6 +8,7 @@
 #include <vcpkg/help.h>
 #include <vcpkg/input.h>
 #include <vcpkg/installedpaths.h>
+#include <vcpkg/listfile.h>
 #include <vcpkg/paragraphs.h>
 #include <vcpkg/portfileprovider.h>
 #include <vcpkg/remove.h>
@@ -13,6 +16,9 @@
 #include <vcpkg/vcpkglib.h>
 #include <vcpkg/vcpkgpaths.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace vcpkg::Remove
 {
     using Dependencies::RemovePlanAction;
@@ -20,11 +26,116 @@ namespace vcpkg::Remove
     using Dependencies::RequestType;
     using Update::OutdatedPackage;
 
-    static void remove_package(Filesystem& fs,
-                               const InstalledPaths& installed,
-                               const PackageSpec& spec,
-                               StatusParagraphs* status_db)
+    namespace
+    {
+        struct FileRemoval
+        {
+            bool removed = false;
+            std::error_code ec;
+        };
+    }
+
+    void remove_installed_files(Filesystem& fs, const Path& installed_root, std::vector<std::string> paths)
+    {
+        std::vector<std::string> dirs;
+        Util::erase_remove_if(paths, [&](std::string& path) {
+            if (path.empty() || path.back() != '/') return false;
+            dirs.push_back(std::move(path));
+            return true;
+        });
+
+        std::vector<FileRemoval> removals(paths.size());
+        parallel_transform(paths.begin(), paths.size(), removals.begin(), [&](const std::string& path) {
+            FileRemoval removal;
+            removal.removed = fs.remove(installed_root / path, removal.ec);
+            return removal;
+        });
+
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            const auto& removal = removals[i];
+            if (removal.removed)
+            {
+                continue;
+            }
+
+            if (removal.ec == std::errc::directory_not_empty)
+            {
+                // listfiles written by old vcpkg versions do not mark directories with a trailing '/'
+                dirs.push_back(std::move(paths[i]));
+            }
+            else if (removal.ec)
+            {
+                vcpkg::printf(
+                    Color::error, "failed: remove(%s): %s\n", installed_root / paths[i], removal.ec.message());
+            }
+            else
+            {
+                vcpkg::printf(Color::warning, "Warning: %s: file not found\n", installed_root / paths[i]);
+            }
+        }
+
+        // a directory sorts before everything in it, so in reverse order each directory is visited after its contents
+        Util::sort(dirs, std::greater<std::string>());
+        for (auto&& dir : dirs)
+        {
+            std::error_code ec;
+            fs.remove(installed_root / dir, ec);
+            if (ec && ec != std::errc::directory_not_empty)
+            {
+                vcpkg::printf(Color::error, "failed: remove(%s): %s\n", installed_root / dir, ec.message());
+            }
+        }
+    }
+
+    static Path replaced_listfiles_lock(const Path& replaced_listfiles_dir) { return replaced_listfiles_dir + ".lock"; }
+
+    ReplacedListfiles::ReplacedListfiles(Filesystem& fs, const InstalledPaths& installed)
+        : m_fs(fs), m_dir(installed.vcpkg_dir_replaced() / Strings::concat(get_process_id()))
+    {
+    }
+
+    ReplacedListfiles::~ReplacedListfiles()
+    {
+        if (!m_lock) return;
+        // left behind if some listfile was not released, for remove_abandoned_replaced_files to find
+        std::error_code ec;
+        m_fs.remove(m_dir, ec);
+        if (ec) return;
+        m_lock.reset();
+        m_fs.remove(replaced_listfiles_lock(m_dir), IgnoreErrors{});
+    }
+
+    Path ReplacedListfiles::listfile_path(const PackageSpec& spec)
     {
+        if (!m_lock)
+        {
+            // the lock is taken first so that remove_abandoned_replaced_files never sees the directory unlocked while
+            // this process still needs the files; a directory left by an earlier process with the same id is taken over
+            m_fs.create_directory(m_dir.parent_path(), VCPKG_LINE_INFO);
+            m_lock = m_fs.take_exclusive_file_lock(replaced_listfiles_lock(m_dir), VCPKG_LINE_INFO);
+            m_fs.create_directory(m_dir, VCPKG_LINE_INFO);
+        }
+
+        return m_dir / (spec.dir() + ".list");
+    }
+
+    void ReplacedListfiles::release(const PackageSpec& spec)
+    {
+        if (!m_lock) return;
+        m_fs.remove(m_dir / (spec.dir() + ".list"), VCPKG_LINE_INFO);
+    }
+
+    // the package's files are kept and their listfile paths returned if `replaced_listfiles` is not null
+    static std::vector<std::string> remove_package(Filesystem& fs,
+                                                   const InstalledPaths& installed,
+                                                   const PackageSpec& spec,
+                                                   StatusParagraphs* status_db,
+                                                   ReplacedListfiles* replaced_listfiles)
+    {
+        // other vcpkg processes may be changing the same tree
+        const auto status_lock = lock_status_database(fs, installed);
+        database_refresh(fs, installed, *status_db);
         auto maybe_ipv = status_db->get_installed_package_view(spec);
 
         Checks::check_exit(
@@ -46,59 +157,30 @@ namespace vcpkg::Remove
             write_update(fs, installed, spgh);
         }
 
+        std::vector<std::string> replaced_files;
+        std::vector<std::string> paths;
         std::error_code ec;
-        auto lines = fs.read_lines(installed.listfile_path(ipv.core->package), ec);
+        const auto listfile_path = installed.listfile_path(ipv.core->package);
+        {
+            // the listfile cannot be removed while it is mapped on Windows
+            const auto listfile = Listfile::load(fs, listfile_path, ec);
+            listfile.for_each([&](StringView path) { paths.push_back(path.to_string()); });
+        }
+
         if (!ec)
         {
-            std::vector<Path> dirs_touched;
-            for (auto&& suffix : lines)
+            if (replaced_listfiles)
             {
-                auto target = installed.root() / suffix;
-
-                const auto status = fs.symlink_status(target, ec);
-                if (ec)
-                {
-                    print2(Color::error, "failed: symlink_status(", target, "): ", ec.message(), "\n");
-                    continue;
-                }
-
-                if (vcpkg::is_directory(status))
-                {
-                    dirs_touched.push_back(target);
-                }
-                else if (vcpkg::is_regular_file(status) || vcpkg::is_symlink(status))
-                {
-                    fs.remove(target, ec);
-                    if (ec)
-                    {
-                        vcpkg::printf(Color::error, "failed: remove(%s): %s\n", target, ec.message());
-                    }
-                }
-                else if (vcpkg::exists(status))
-                {
-                    vcpkg::printf(Color::warning, "Warning: %s: cannot handle file type\n", target);
-                }
-                else
-                {
-                    vcpkg::printf(Color::warning, "Warning: %s: file not found\n", target);
-                }
+                fs.rename(listfile_path, replaced_listfiles->listfile_path(spec), VCPKG_LINE_INFO);
+                fs.remove(front_coded_listfile_path(listfile_path), IgnoreErrors{});
+                Util::sort(paths);
+                replaced_files = std::move(paths);
             }
-
-            auto b = dirs_touched.rbegin();
-            const auto e = dirs_touched.rend();
-            for (; b != e; ++b)
+            else
             {
-                if (fs.is_empty(*b, IgnoreErrors{}))
-                {
-                    fs.remove(*b, ec);
-                    if (ec)
-                    {
-                        print2(Color::error, "failed: ", ec.message(), "\n");
-                    }
-                }
+                remove_installed_files(fs, installed.root(), std::move(paths));
+                remove_listfile(fs, listfile_path, VCPKG_LINE_INFO);
             }
-
-            fs.remove(installed.listfile_path(ipv.core->package), VCPKG_LINE_INFO);
         }
 
         for (auto&& spgh : spghs)
@@ -108,6 +190,8 @@ namespace vcpkg::Remove
 
             status_db->insert(std::make_unique<StatusParagraph>(std::move(spgh)));
         }
+
+        return replaced_files;
     }
 
     static void print_plan(const std::map<RemovePlanType, std::vector<const RemovePlanAction*>>& group_by_plan_type)
@@ -157,7 +241,7 @@ namespace vcpkg::Remove
                 break;
             case RemovePlanType::REMOVE:
                 vcpkg::printf("Removing package %s...\n", display_name);
-                remove_package(fs, paths.installed(), action.spec, status_db);
+                remove_package(fs, paths.installed(), action.spec, status_db, nullptr);
                 break;
             case RemovePlanType::UNKNOWN:
             default: Checks::unreachable(VCPKG_LINE_INFO);
@@ -169,6 +253,74 @@ namespace vcpkg::Remove
         }
     }
 
+    std::vector<std::string> perform_replace_plan_action(const VcpkgPaths& paths,
+                                                         const RemovePlanAction& action,
+                                                         StatusParagraphs* status_db,
+                                                         ReplacedListfiles& replaced_listfiles)
+    {
+        Checks::check_exit(VCPKG_LINE_INFO, action.plan_type == RemovePlanType::REMOVE);
+        vcpkg::printf("Removing package %s...\n", action.spec.to_string());
+        auto& fs = paths.get_filesystem();
+        auto replaced_files = remove_package(fs, paths.installed(), action.spec, status_db, &replaced_listfiles);
+        fs.remove_all(paths.packages() / action.spec.dir(), VCPKG_LINE_INFO);
+        return replaced_files;
+    }
+
+    static void remove_abandoned_replaced_package(Filesystem& fs,
+                                                  const InstalledPaths& installed,
+                                                  StatusParagraphs& status_db,
+                                                  const Path& replaced_listfile)
+    {
+        std::vector<std::string> abandoned_files;
+        {
+            const auto listfile = Listfile::load(fs, replaced_listfile, VCPKG_LINE_INFO);
+            listfile.for_each([&](StringView path) { abandoned_files.push_back(path.to_string()); });
+        }
+
+        // the new package, or another which took over some of the files, may have been installed since
+        const auto status_lock = lock_status_database(fs, installed);
+        database_refresh(fs, installed, status_db);
+        std::vector<std::string> owned_files;
+        for (auto&& installed_listfile : get_installed_listfiles(fs, installed, status_db))
+        {
+            installed_listfile.listfile.for_each([&](StringView path) { owned_files.push_back(path.to_string()); });
+        }
+
+        Util::sort(abandoned_files);
+        Util::sort(owned_files);
+        std::vector<std::string> stale_files;
+        std::set_difference(abandoned_files.begin(),
+                            abandoned_files.end(),
+                            owned_files.begin(),
+                            owned_files.end(),
+                            std::back_inserter(stale_files));
+        print2("Removing files left behind by an interrupted replacement of ", replaced_listfile.stem(), '\n');
+        remove_installed_files(fs, installed.root(), std::move(stale_files));
+    }
+
+    void remove_abandoned_replaced_files(Filesystem& fs, const InstalledPaths& installed, StatusParagraphs& status_db)
+    {
+        std::error_code ec;
+        const auto replaced_listfiles_dirs = fs.get_directories_non_recursive(installed.vcpkg_dir_replaced(), ec);
+        if (ec) return;
+        for (auto&& replaced_listfiles_dir : replaced_listfiles_dirs)
+        {
+            const auto lock_path = replaced_listfiles_lock(replaced_listfiles_dir);
+            auto lock = fs.try_take_exclusive_file_lock(lock_path, ec);
+            // held by a vcpkg process which replaced packages, which may yet install them; the directory may also have
+            // been removed since it was listed
+            if (ec || !lock || !fs.exists(replaced_listfiles_dir, IgnoreErrors{})) continue;
+
+            for (auto&& replaced_listfile : fs.get_regular_files_non_recursive(replaced_listfiles_dir, VCPKG_LINE_INFO))
+            {
+                remove_abandoned_replaced_package(fs, installed, status_db, replaced_listfile);
+            }
+
+            fs.remove_all(replaced_listfiles_dir, VCPKG_LINE_INFO);
+            lock.reset();
+            fs.remove(lock_path, IgnoreErrors{});
+        }
+    }
     static constexpr StringLiteral OPTION_PURGE = "purge";
     static constexpr StringLiteral OPTION_NO_PURGE = "no-purge";
     static constexpr StringLiteral OPTION_RECURSE = "recurse";
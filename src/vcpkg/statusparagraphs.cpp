@@ -2,6 +2,7 @@
 
 #include <vcpkg/install.h>
 #include <vcpkg/installedpaths.h>
+#include <vcpkg/listfile.h>
 #include <vcpkg/statusparagraphs.h>
 #include <vcpkg/vcpkgpaths.h>
 
@@ -175,10 +176,9 @@ namespace vcpkg
         {
             iobj.insert("usage", Json::Value::string(std::move(usage.message)));
         }
-        auto owns_files = fs.read_lines(installed.listfile_path(ipv.core->package), VCPKG_LINE_INFO);
+        const auto listfile = Listfile::load(fs, installed.listfile_path(ipv.core->package), VCPKG_LINE_INFO);
         Json::Array owns;
-        for (auto&& owns_file : owns_files)
-            owns.push_back(Json::Value::string(std::move(owns_file)));
+        listfile.for_each([&](StringView owns_file) { owns.push_back(Json::Value::string(owns_file.to_string())); });
 
         iobj.insert("owns", std::move(owns));
         return Json::Value::object(std::move(iobj));
@@ -12,6 +12,7 @@
 #include <vcpkg/tools.h>
 #include <vcpkg/vcpkgpaths.h>
 
+#include <mutex>
 #include <regex>
 
 namespace vcpkg
@@ -214,6 +215,13 @@ namespace vcpkg
                       tool_name,
                       version_as_string);
         auto& fs = paths.get_filesystem();
+        const auto download_lock = lock_download(fs, tool_data.download_path, tool_data.sha512);
+        if (fs.exists(tool_data.exe_path, IgnoreErrors{}))
+        {
+            // another process fetched it while we waited
+            return tool_data.exe_path;
+        }
+
         if (!fs.exists(tool_data.download_path, IgnoreErrors{}))
         {
             print2("Downloading ", tool_name, "...\n");
@@ -684,11 +692,15 @@ aws-cli/2.4.4 Python/3.8.8 Windows/10 exe/AMD64 prompt/off
         vcpkg::Cache<std::string, Path> system_cache;
         vcpkg::Cache<std::string, Path> path_only_cache;
         vcpkg::Cache<std::string, PathAndVersion> path_version_cache;
+        // tools may be requested from several threads at once, for example by parallel registry fetches; the lookups
+        // are recursive (IFW tools depend on the IFW installer base)
+        mutable std::recursive_mutex m_mutex;
 
         ToolCacheImpl(RequireExactVersions abiToolVersionHandling) : abiToolVersionHandling(abiToolVersionHandling) { }
 
         virtual const Path& get_tool_path_from_system(const Filesystem& fs, StringView tool) const override
         {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
             return system_cache.get_lazy(tool, [&] {
                 if (tool == Tools::TAR)
                 {
@@ -716,6 +728,7 @@ aws-cli/2.4.4 Python/3.8.8 Windows/10 exe/AMD64 prompt/off
 
         virtual const Path& get_tool_path(const VcpkgPaths& paths, StringView tool) const override
         {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
             return path_only_cache.get_lazy(tool, [&]() {
                 if (tool == Tools::IFW_BINARYCREATOR)
                 {
@@ -737,6 +750,7 @@ aws-cli/2.4.4 Python/3.8.8 Windows/10 exe/AMD64 prompt/off
 
         const PathAndVersion& get_tool_pathversion(const VcpkgPaths& paths, StringView tool) const
         {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
             return path_version_cache.get_lazy(tool, [&]() -> PathAndVersion {
                 // First deal with specially handled tools.
                 // For these we may look in locations like Program Files, the PATH etc as well as the auto-downloaded
@@ -21,20 +21,22 @@ namespace vcpkg::Update
     {
         auto installed_packages = get_installed_ports(status_db);
 
+        // only the versions are compared, so the ports themselves need not be loaded
+        const auto port_names =
+            Util::fmap(installed_packages, [](const InstalledPackageView& ipv) { return ipv.spec().name(); });
+        auto latest_versions = provider.get_versions(port_names);
+
         std::vector<OutdatedPackage> output;
-        for (auto&& ipv : installed_packages)
+        for (size_t i = 0; i < installed_packages.size(); ++i)
         {
-            const auto& pgh = ipv.core;
-            auto maybe_scfl = provider.get_control_file(pgh->package.spec.name());
-            if (auto p_scfl = maybe_scfl.get())
+            const auto& pgh = installed_packages[i].core;
+            if (auto latest_version = latest_versions[i].get())
             {
-                const auto& latest_pgh = *p_scfl->source_control_file->core_paragraph;
-                auto latest_version = Version(latest_pgh.raw_version, latest_pgh.port_version);
                 auto installed_version = Version(pgh->package.version, pgh->package.port_version);
-                if (latest_version != installed_version)
+                if (*latest_version != installed_version)
                 {
                     output.push_back(
-                        {pgh->package.spec, VersionDiff(std::move(installed_version), std::move(latest_version))});
+                        {pgh->package.spec, VersionDiff(std::move(installed_version), std::move(*latest_version))});
                 }
             }
             else
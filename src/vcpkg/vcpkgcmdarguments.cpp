@@ -9,6 +9,8 @@
 #include <vcpkg/metrics.h>
 #include <vcpkg/vcpkgcmdarguments.h>
 
+#include <limits>
+
 namespace vcpkg
 {
     static void set_from_feature_flag(const std::vector<std::string>& flags, StringView flag, Optional<bool>& place)
@@ -293,6 +295,7 @@ namespace vcpkg
                     {BUILTIN_PORTS_ROOT_DIR_ARG, &VcpkgCmdArguments::builtin_ports_root_dir},
                     {BUILTIN_REGISTRY_VERSIONS_DIR_ARG, &VcpkgCmdArguments::builtin_registry_versions_dir},
                     {ASSET_SOURCES_ARG, &VcpkgCmdArguments::asset_sources_template_arg},
+                    {BUILD_MEMORY_BUDGET_ARG, &VcpkgCmdArguments::build_memory_budget},
                 };
 
             constexpr static std::pair<StringView, std::vector<std::string> VcpkgCmdArguments::*>
@@ -301,6 +304,7 @@ namespace vcpkg
                     {OVERLAY_TRIPLETS_ARG, &VcpkgCmdArguments::overlay_triplets},
                     {BINARY_SOURCES_ARG, &VcpkgCmdArguments::binary_sources},
                     {CMAKE_SCRIPT_ARG, &VcpkgCmdArguments::cmake_args},
+                    {BUILD_WORKER_ARG, &VcpkgCmdArguments::build_workers},
                 };
 
             constexpr static std::pair<StringView, Optional<bool> VcpkgCmdArguments::*> switches[] = {
@@ -383,6 +387,24 @@ namespace vcpkg
 
         parse_feature_flags(feature_flags, args);
 
+        if (auto budget = args.build_memory_budget.get())
+        {
+            // larger budgets would overflow when converted to bytes
+            constexpr long long MAX_BUDGET_MIB = static_cast<long long>(std::numeric_limits<uint64_t>::max() >> 20);
+            const auto maybe_budget_mib = Strings::strto<long long>(*budget);
+            const auto budget_mib = maybe_budget_mib.get();
+            if (!budget_mib || *budget_mib <= 0 || *budget_mib > MAX_BUDGET_MIB)
+            {
+                LockGuardPtr<Metrics>(g_metrics)->track_property("error", "error invalid build memory budget");
+                Checks::exit_with_message(VCPKG_LINE_INFO,
+                                          "Error: --%s must be a positive number of MiB, not \"%s\"",
+                                          BUILD_MEMORY_BUDGET_ARG,
+                                          *budget);
+            }
+
+            args.build_memory_budget_mib = static_cast<uint64_t>(*budget_mib);
+        }
+
         return args;
     }
 
@@ -1020,6 +1042,8 @@ namespace vcpkg
     constexpr StringLiteral VcpkgCmdArguments::OVERLAY_TRIPLETS_ARG;
 
     constexpr StringLiteral VcpkgCmdArguments::BINARY_SOURCES_ARG;
+    constexpr StringLiteral VcpkgCmdArguments::BUILD_WORKER_ARG;
+    constexpr StringLiteral VcpkgCmdArguments::BUILD_MEMORY_BUDGET_ARG;
 
     constexpr StringLiteral VcpkgCmdArguments::DEBUG_SWITCH;
     constexpr StringLiteral VcpkgCmdArguments::SEND_METRICS_SWITCH;
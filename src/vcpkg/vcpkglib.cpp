@@ -1,5 +1,6 @@
 #include <vcpkg/base/files.h>
 #include <vcpkg/base/strings.h>
+#include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/util.h>
 
 #include <vcpkg/installedpaths.h>
@@ -36,15 +37,18 @@ namespace vcpkg
         return StatusParagraphs(std::move(status_pghs));
     }
 
-    StatusParagraphs database_load_check(Filesystem& fs, const InstalledPaths& installed)
+    static void create_database_directories(Filesystem& fs, const InstalledPaths& installed)
     {
-        const auto updates_dir = installed.vcpkg_dir_updates();
-
         fs.create_directories(installed.root(), VCPKG_LINE_INFO);
         fs.create_directory(installed.vcpkg_dir(), VCPKG_LINE_INFO);
         fs.create_directory(installed.vcpkg_dir_info(), VCPKG_LINE_INFO);
-        fs.create_directory(updates_dir, VCPKG_LINE_INFO);
+        fs.create_directory(installed.vcpkg_dir_updates(), VCPKG_LINE_INFO);
+    }
 
+    // folds pending updates into the status file; requires lock_status_database
+    static StatusParagraphs load_and_compact_database(Filesystem& fs, const InstalledPaths& installed)
+    {
+        const auto updates_dir = installed.vcpkg_dir_updates();
         const auto status_file = installed.vcpkg_dir_status_file();
         const auto status_parent = Path(status_file.parent_path());
         const auto status_file_old = status_parent / "status-old";
@@ -82,6 +86,29 @@ namespace vcpkg
         return current_status_db;
     }
 
+    std::unique_ptr<IExclusiveFileLock> lock_status_database(Filesystem& fs, const InstalledPaths& installed)
+    {
+        create_database_directories(fs, installed);
+        return fs.take_exclusive_file_lock(installed.vcpkg_dir_status_lock(), VCPKG_LINE_INFO);
+    }
+
+    StatusParagraphs database_load_check(Filesystem& fs, const InstalledPaths& installed)
+    {
+        const auto lock = lock_status_database(fs, installed);
+        return load_and_compact_database(fs, installed);
+    }
+
+    void database_refresh(Filesystem& fs, const InstalledPaths& installed, StatusParagraphs& status_db)
+    {
+        auto current = load_and_compact_database(fs, installed);
+        // StatusParagraphs iterates newest first; insert oldest first to keep the order of new paragraphs
+        for (auto it = current.end(); it != current.begin();)
+        {
+            --it;
+            status_db.insert(std::move(*it));
+        }
+    }
+
     void write_update(Filesystem& fs, const InstalledPaths& installed, const StatusParagraph& p)
     {
         static std::atomic<int> update_id = 0;
@@ -191,11 +218,11 @@ namespace vcpkg
         return Util::fmap(ipv_map, [](auto&& p) -> InstalledPackageView { return std::move(p.second); });
     }
 
-    std::vector<StatusParagraphAndAssociatedFiles> get_installed_files(Filesystem& fs,
-                                                                       const InstalledPaths& installed,
-                                                                       const StatusParagraphs& status_db)
+    std::vector<StatusParagraphAndListfile> get_installed_listfiles(Filesystem& fs,
+                                                                    const InstalledPaths& installed,
+                                                                    const StatusParagraphs& status_db)
     {
-        std::vector<StatusParagraphAndAssociatedFiles> installed_files;
+        std::vector<StatusParagraphAndListfile> installed_listfiles;
 
         for (const std::unique_ptr<StatusParagraph>& pgh : status_db)
         {
@@ -205,20 +232,32 @@ namespace vcpkg
             }
 
             const auto listfile_path = installed.listfile_path(pgh->package);
-            std::vector<std::string> installed_files_of_current_pgh = fs.read_lines(listfile_path, VCPKG_LINE_INFO);
-            Strings::trim_all_and_remove_whitespace_strings(&installed_files_of_current_pgh);
-            upgrade_to_slash_terminated_sorted_format(fs, &installed_files_of_current_pgh, listfile_path);
-
-            // Remove the directories
-            Util::erase_remove_if(installed_files_of_current_pgh,
-                                  [](const std::string& file) { return file.back() == '/'; });
+            auto listfile = Listfile::load(fs, listfile_path, VCPKG_LINE_INFO);
+            if (!listfile.front_coded_paths())
+            {
+                std::vector<std::string> paths;
+                listfile.for_each([&](StringView path) { paths.push_back(path.to_string()); });
+                // the mapping must be gone before the listfile can be rewritten
+                listfile = Listfile{};
+                if (!paths.empty() && paths.front().back() != '/')
+                {
+                    upgrade_to_slash_terminated_sorted_format(fs, &paths, listfile_path);
+                }
+
+                std::error_code ec;
+                write_front_coded_listfile(fs, listfile_path, std::move(paths), ec);
+                if (ec)
+                {
+                    Debug::print("Failed to write the front-coded copy of ", listfile_path, ": ", ec.message(), '\n');
+                }
+
+                listfile = Listfile::load(fs, listfile_path, VCPKG_LINE_INFO);
+            }
 
-            StatusParagraphAndAssociatedFiles pgh_and_files = {
-                *pgh, SortedVector<std::string>(std::move(installed_files_of_current_pgh))};
-            installed_files.push_back(std::move(pgh_and_files));
+            installed_listfiles.push_back({pgh.get(), std::move(listfile)});
         }
 
-        return installed_files;
+        return installed_listfiles;
     }
 
     std::string shorten_text(const std::string& desc, const size_t length)
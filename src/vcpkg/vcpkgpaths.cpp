@@ -362,6 +362,7 @@ namespace vcpkg
             Lazy<std::string> ports_cmake_hash;
             Cache<Triplet, Path> m_triplets_cache;
             Optional<LockFile> m_installed_lock;
+            std::mutex m_installed_lock_mutex;
         };
 
         // This structure holds members that
@@ -473,15 +474,18 @@ namespace vcpkg
                 {
                     Debug::print("Using manifest-root: ", m_manifest_dir, '\n');
 
+                    // Shared directories are guarded by finer-grained locks (see lock_package_dir), so manifest
+                    // installs only share this lock. It still excludes older versions of vcpkg, which take it
+                    // exclusively and know nothing of the finer-grained locks.
                     std::error_code ec;
                     const auto vcpkg_root_file = root / ".vcpkg-root";
                     if (args.wait_for_lock.value_or(false))
                     {
-                        file_lock_handle = fs.take_exclusive_file_lock(vcpkg_root_file, ec);
+                        file_lock_handle = fs.take_shared_file_lock(vcpkg_root_file, ec);
                     }
                     else
                     {
-                        file_lock_handle = fs.try_take_exclusive_file_lock(vcpkg_root_file, ec);
+                        file_lock_handle = fs.try_take_shared_file_lock(vcpkg_root_file, ec);
                     }
 
                     if (ec)
@@ -696,6 +700,23 @@ namespace vcpkg
     Path VcpkgPaths::build_dir(const PackageSpec& spec) const { return this->buildtrees() / spec.name(); }
     Path VcpkgPaths::build_dir(const std::string& package_name) const { return this->buildtrees() / package_name; }
 
+    static std::unique_ptr<IExclusiveFileLock> take_directory_lock(Filesystem& fs, const Path& root, StringView name)
+    {
+        const auto locks_dir = root / ".vcpkg-locks";
+        fs.create_directories(locks_dir, VCPKG_LINE_INFO);
+        return fs.take_exclusive_file_lock(locks_dir / name, VCPKG_LINE_INFO);
+    }
+
+    std::unique_ptr<IExclusiveFileLock> VcpkgPaths::lock_package_dir(const PackageSpec& spec) const
+    {
+        return take_directory_lock(get_filesystem(), packages(), spec.dir());
+    }
+
+    std::unique_ptr<IExclusiveFileLock> VcpkgPaths::lock_build_dir(const std::string& package_name) const
+    {
+        return take_directory_lock(get_filesystem(), buildtrees(), package_name);
+    }
+
     Path VcpkgPaths::build_info_file_path(const PackageSpec& spec) const
     {
         return this->package_dir(spec) / "BUILD_INFO";
@@ -858,6 +879,8 @@ namespace vcpkg
 
     LockFile& VcpkgPaths::get_installed_lockfile() const
     {
+        // registries may be prefetched concurrently
+        std::lock_guard<std::mutex> lock(m_pimpl->m_installed_lock_mutex);
         if (!m_pimpl->m_installed_lock.has_value())
         {
             m_pimpl->m_installed_lock = load_lockfile(get_filesystem(), installed().lockfile_path());
@@ -1041,97 +1064,350 @@ namespace vcpkg
         return ret;
     }
 
-    ExpectedS<Path> VcpkgPaths::git_checkout_port(StringView port_name,
-                                                  StringView git_tree,
-                                                  const Path& dot_git_dir) const
+    // distinguishes temporary files and refs created by concurrent operations, in this or other vcpkg processes
+    static std::string get_unique_operation_suffix()
     {
-        /* Check out a git tree into the versioned port recipes folder
-         *
-         * Since we are checking a git tree object, all files will be checked out to the root of `work-tree`.
-         * Because of that, it makes sense to use the git hash as the name for the directory.
-         */
-        Filesystem& fs = get_filesystem();
-        auto destination = this->versions_output() / port_name / git_tree;
-        if (fs.exists(destination, IgnoreErrors{}))
+        static std::atomic<unsigned int> counter{0};
+        return Strings::concat(get_process_id(), '-', counter.fetch_add(1));
+    }
+
+    // Trees extracted from git are kept in a content-addressed store, <registries cache>/git-trees/<tree SHA>,
+    // shared by every vcpkg root and user pointing at the same registries cache (see X_VCPKG_REGISTRIES_CACHE).
+    // Trees are published by renaming a completely extracted temporary directory into place, while holding a shared
+    // lock on the store. Every lookup of a tree refreshes "<tree SHA>.last-used", at most once a minute per process,
+    // and the first one takes a shared lock on that marker which the process holds until it exits. The store is
+    // trimmed to the max_git_trees most recently used trees under an exclusive lock on the store, skipping trees whose
+    // markers it cannot lock exclusively because some process is still using them. The lock and marker files are
+    // writable by all users, so that several users can share the store.
+    static constexpr size_t max_git_trees = 4096;
+    static constexpr int64_t git_tree_temporary_grace_ns = int64_t(60) * 60 * 1000 * 1000 * 1000;
+    static constexpr auto git_tree_mark_interval = std::chrono::minutes(1);
+
+    static Path git_tree_marker(const Path& git_tree) { return Strings::concat(git_tree, ".last-used"); }
+
+    // must be called while holding a shared lock on the store, so that the tree cannot be trimmed before it is locked
+    static void mark_git_tree_used(Filesystem& fs, const Path& git_tree)
+    {
+        struct MarkedTree
+        {
+            std::chrono::steady_clock::time_point marked;
+            std::unique_ptr<IExclusiveFileLock> lock;
+        };
+
+        static std::mutex marked_mutex;
+        static std::map<std::string, MarkedTree> marked;
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(marked_mutex);
+        auto it = marked.find(git_tree.native());
+        if (it != marked.end() && now - it->second.marked < git_tree_mark_interval)
         {
-            return destination;
+            return;
         }
 
-        const auto destination_tmp = this->versions_output() / port_name / Strings::concat(git_tree, ".tmp");
-        const auto destination_tar = this->versions_output() / port_name / Strings::concat(git_tree, ".tar");
-#define PRELUDE "Error: while checking out port ", port_name, " with git tree ", git_tree, "\n"
+        auto& marked_tree = marked[git_tree.native()];
+        marked_tree.marked = now;
+        // best effort; an unmarked tree is merely more likely to be evicted
         std::error_code ec;
-        Path failure_point;
-        fs.remove_all(destination_tmp, ec, failure_point);
+        const auto marker = git_tree_marker(git_tree);
+        fs.touch_shared(marker, ec);
+        if (!marked_tree.lock)
+        {
+            marked_tree.lock = fs.try_take_shared_file_lock(marker, ec);
+            if (ec)
+            {
+                // an unlocked tree may be trimmed while this process is using it, like before trees were locked
+                Debug::print("Failed to lock git tree ", git_tree, ": ", ec.message(), '\n');
+                marked_tree.lock.reset();
+            }
+        }
+    }
+
+    static Path git_trees_lock_file(Filesystem& fs, const Path& git_trees)
+    {
+        auto lock_file = git_trees / ".vcpkg-lock";
+        if (!fs.exists(lock_file, IgnoreErrors{}))
+        {
+            // if this fails, locking reports why
+            std::error_code ec;
+            fs.touch_shared(lock_file, ec);
+        }
+
+        return lock_file;
+    }
+
+    static void trim_git_trees(Filesystem& fs, const Path& git_trees)
+    {
+        std::error_code ec;
+        auto lock = fs.try_take_exclusive_file_lock(git_trees_lock_file(fs, git_trees), ec);
         if (ec)
         {
-            return {Strings::concat(PRELUDE, "Error: while removing ", failure_point, ": ", ec.message()),
-                    expected_right_tag};
+            Debug::print("Not trimming ", git_trees, ", it is in use: ", ec.message(), '\n');
+            return;
         }
-        fs.create_directories(destination_tmp, ec);
+
+        auto entries = fs.get_directories_non_recursive(git_trees, ec);
         if (ec)
         {
-            return {Strings::concat(PRELUDE, "Error: while creating directories ", destination_tmp, ": ", ec.message()),
-                    expected_right_tag};
+            return;
         }
 
-        auto tar_cmd_builder = git_cmd_builder(dot_git_dir, dot_git_dir)
-                                   .string_arg("archive")
-                                   .string_arg(git_tree)
-                                   .string_arg("-o")
-                                   .string_arg(destination_tar);
-        const auto tar_output = cmd_execute_and_capture_output(tar_cmd_builder);
-        if (tar_output.exit_code != 0)
+        struct UsedTree
         {
-            return {Strings::concat(PRELUDE, "Error: Failed to tar port directory\n", tar_output.output),
-                    expected_right_tag};
+            int64_t last_used;
+            Path path;
+        };
+
+        std::vector<UsedTree> trees;
+        std::vector<UsedTree> temporaries;
+        int64_t newest = 0;
+        for (auto&& entry : entries)
+        {
+            std::error_code time_ec;
+            auto last_used = fs.last_write_time(git_tree_marker(entry), time_ec);
+            if (time_ec)
+            {
+                last_used = fs.last_write_time(entry, time_ec);
+            }
+
+            if (time_ec)
+            {
+                last_used = 0;
+            }
+
+            newest = std::max(newest, last_used);
+            if (Strings::contains(entry.filename(), ".tmp"))
+            {
+                temporaries.push_back({last_used, std::move(entry)});
+            }
+            else
+            {
+                trees.push_back({last_used, std::move(entry)});
+            }
+        }
+
+        // archives and versions databases whose writers were interrupted, among others
+        for (auto&& file : fs.get_regular_files_non_recursive(git_trees, IgnoreErrors{}))
+        {
+            if (!Strings::contains(file.filename(), ".tmp")) continue;
+            std::error_code time_ec;
+            const auto last_used = fs.last_write_time(file, time_ec);
+            temporaries.push_back({time_ec ? 0 : last_used, std::move(file)});
+        }
+
+        // the caller just marked a tree, so the newest mark stands in for the current time on the store's clock
+        for (auto&& temporary : temporaries)
+        {
+            // left behind by an interrupted extraction
+            if (newest - temporary.last_used > git_tree_temporary_grace_ns)
+            {
+                fs.remove_all(temporary.path, ec);
+            }
         }
 
-        extract_tar_cmake(this->get_tool_exe(Tools::CMAKE), destination_tar, destination_tmp);
-        fs.remove(destination_tar, ec);
+        if (trees.size() > max_git_trees)
+        {
+            std::sort(trees.begin(), trees.end(), [](const UsedTree& lhs, const UsedTree& rhs) {
+                return lhs.last_used > rhs.last_used;
+            });
+            for (auto it = trees.begin() + max_git_trees; it != trees.end(); ++it)
+            {
+                const auto marker = git_tree_marker(it->path);
+                auto tree_lock = fs.try_take_exclusive_file_lock(marker, ec);
+                if (ec || !tree_lock)
+                {
+                    Debug::print("Not removing git tree ", it->path, ", it is in use\n");
+                    continue;
+                }
+
+                Debug::print("Removing unused git tree ", it->path, '\n');
+                // rename first so that nobody observes a partially removed tree
+                const Path trash = Strings::concat(it->path, ".tmp", get_unique_operation_suffix());
+                fs.rename(it->path, trash, ec);
+                if (!ec)
+                {
+                    fs.remove_all(trash, ec);
+                }
+
+                // nobody can lock the marker again before it is removed, since lookups hold the store's lock
+                tree_lock.reset();
+                fs.remove(marker, ec);
+                fs.remove(PackedVersionsDb::path_for(it->path), ec);
+            }
+        }
+    }
+
+    // Extracts git_tree from the repository at dot_git_dir into the shared store of git trees, unless it is already
+    // there, and returns its path in the store. Safe to call from several threads at once; threads extracting the same
+    // tree wait for each other rather than extracting it twice.
+    static ExpectedS<Path> git_checkout_tree_to_store(const VcpkgPaths& paths,
+                                                      const Path& git_trees,
+                                                      const Path& dot_git_dir,
+                                                      const Path& work_tree,
+                                                      StringView git_tree)
+    {
+        auto& fs = paths.get_filesystem();
+        std::error_code ec;
+        fs.create_directories(git_trees, ec);
         if (ec)
         {
-            return {Strings::concat(PRELUDE, "Error: while removing ", destination_tar, ": ", ec.message()),
+            return {Strings::concat("Error: while creating directories ", git_trees, ": ", ec.message()),
                     expected_right_tag};
         }
-        fs.rename_with_retry(destination_tmp, destination, ec);
-        if (ec)
+
+        const auto git_tree_final = git_trees / git_tree;
         {
-            return {Strings::concat(
-                        PRELUDE, "Error: while renaming ", destination_tmp, " to ", destination, ": ", ec.message()),
+            static std::mutex extraction_mutexes[16];
+            std::lock_guard<std::mutex> extracting(
+                extraction_mutexes[std::hash<std::string>{}(git_tree_final.native()) % 16]);
+
+            // prevents trim_git_trees from removing the tree between publishing and marking it
+            auto lock = fs.take_shared_file_lock(git_trees_lock_file(fs, git_trees), ec);
+            if (ec)
+            {
+                return {Strings::concat("Error: while locking ", git_trees, ": ", ec.message()), expected_right_tag};
+            }
+
+            if (fs.exists(git_tree_final, IgnoreErrors{}))
+            {
+                mark_git_tree_used(fs, git_tree_final);
+                return git_tree_final;
+            }
+
+            const auto suffix = get_unique_operation_suffix();
+            const Path git_tree_temp = Strings::concat(git_tree_final, ".tmp", suffix);
+            const Path git_tree_temp_tar = Strings::concat(git_tree_final, ".tmp", suffix, ".tar");
+            fs.remove_all(git_tree_temp, VCPKG_LINE_INFO);
+            fs.create_directory(git_tree_temp, VCPKG_LINE_INFO);
+
+            Command git_archive = paths.git_cmd_builder(dot_git_dir, work_tree)
+                                      .string_arg("archive")
+                                      .string_arg("--format")
+                                      .string_arg("tar")
+                                      .string_arg(git_tree)
+                                      .string_arg("--output")
+                                      .string_arg(git_tree_temp_tar);
+            auto git_archive_output = cmd_execute_and_capture_output(git_archive);
+            if (git_archive_output.exit_code != 0)
+            {
+                fs.remove_all(git_tree_temp, IgnoreErrors{});
+                fs.remove(git_tree_temp_tar, IgnoreErrors{});
+                return {Strings::format("git archive failed with message:\n%s", git_archive_output.output),
+                        expected_right_tag};
+            }
+
+            extract_tar_cmake(paths.get_tool_exe(Tools::CMAKE), git_tree_temp_tar, git_tree_temp);
+            // Attempt to remove temporary files, though non-critical.
+            fs.remove(git_tree_temp_tar, IgnoreErrors{});
+
+            fs.rename_with_retry(git_tree_temp, git_tree_final, ec);
+            if (ec)
+            {
+                // another process may have published the same tree first
+                fs.remove_all(git_tree_temp, IgnoreErrors{});
+            }
+
+            if (!fs.exists(git_tree_final, IgnoreErrors{}))
+            {
+                return {Strings::format("rename to %s failed with message:\n%s",
+                                        git_tree_final,
+                                        ec ? ec.message() : std::string("Unknown error")),
+                        expected_right_tag};
+            }
+
+            mark_git_tree_used(fs, git_tree_final);
+        }
+
+        // a new tree was added, so check the size of the store once per process
+        static std::atomic<bool> trimmed{false};
+        if (!trimmed.exchange(true))
+        {
+            trim_git_trees(fs, git_trees);
+        }
+
+        return git_tree_final;
+    }
+
+    ExpectedS<Path> VcpkgPaths::git_checkout_port(StringView port_name,
+                                                  StringView git_tree,
+                                                  const Path& dot_git_dir) const
+    {
+        /* Check out a git tree into the shared store of git trees
+         *
+         * Since we are checking a git tree object, all files will be checked out to the root of the destination.
+         * Because of that, it makes sense to use the git hash as the name for the directory.
+         */
+        auto maybe_path =
+            git_checkout_tree_to_store(*this, m_pimpl->m_registries_git_trees, dot_git_dir, dot_git_dir, git_tree);
+        if (!maybe_path)
+        {
+            return {Strings::concat("Error: while checking out port ",
+                                    port_name,
+                                    " with git tree ",
+                                    git_tree,
+                                    "\n",
+                                    maybe_path.error()),
                     expected_right_tag};
         }
 
-        return destination;
-#undef PRELUDE
+        return maybe_path;
     }
 
-    ExpectedS<std::string> VcpkgPaths::git_fetch_from_remote_registry(StringView repo, StringView treeish) const
+    enum class RegistriesGitAccess
     {
-        auto& fs = get_filesystem();
+        Read,
+        Fetch,
+    };
+
+    // Initializes the registries git repository if necessary, then locks it. Fetches change refs, the shallow file
+    // and the object store, so they take an exclusive lock; reading objects takes a shared one.
+    static ExpectedS<std::unique_ptr<IExclusiveFileLock>> lock_registries_git_dir(const VcpkgPaths& paths,
+                                                                                 const Path& dot_git_dir,
+                                                                                 const Path& work_tree,
+                                                                                 RegistriesGitAccess access)
+    {
+        auto& fs = paths.get_filesystem();
+        fs.create_directories(work_tree, VCPKG_LINE_INFO);
+        const auto lock_file = work_tree / ".vcpkg-lock";
+
+        if (!fs.exists(dot_git_dir / "HEAD", IgnoreErrors{}))
+        {
+            auto guard = fs.take_exclusive_file_lock(lock_file, IgnoreErrors{});
+            Command init_registries_git_dir = paths.git_cmd_builder(dot_git_dir, work_tree).string_arg("init");
+            auto init_output = cmd_execute_and_capture_output(init_registries_git_dir);
+            if (init_output.exit_code != 0)
+            {
+                return {Strings::format(
+                            "Error: Failed to initialize local repository %s.\n%s\n", work_tree, init_output.output),
+                        expected_right_tag};
+            }
+        }
+
+        if (access == RegistriesGitAccess::Fetch)
+        {
+            return fs.take_exclusive_file_lock(lock_file, IgnoreErrors{});
+        }
+
+        return fs.take_shared_file_lock(lock_file, IgnoreErrors{});
+    }
 
+    ExpectedS<std::string> VcpkgPaths::git_fetch_from_remote_registry(StringView repo, StringView treeish) const
+    {
         const auto& work_tree = m_pimpl->m_registries_work_tree_dir;
-        fs.create_directories(work_tree, VCPKG_LINE_INFO);
         const auto& dot_git_dir = m_pimpl->m_registries_dot_git_dir;
 
-        Command init_registries_git_dir = git_cmd_builder(dot_git_dir, work_tree).string_arg("init");
-        auto init_output = cmd_execute_and_capture_output(init_registries_git_dir);
-        if (init_output.exit_code != 0)
+        auto maybe_guard = lock_registries_git_dir(*this, dot_git_dir, work_tree, RegistriesGitAccess::Fetch);
+        if (!maybe_guard.has_value())
         {
-            return {Strings::format(
-                        "Error: Failed to initialize local repository %s.\n%s\n", work_tree, init_output.output),
-                    expected_right_tag};
+            return {std::move(maybe_guard).error(), expected_right_tag};
         }
 
-        auto lock_file = work_tree / ".vcpkg-lock";
-
-        auto guard = fs.take_exclusive_file_lock(lock_file, IgnoreErrors{});
+        const auto fetch_ref = Strings::concat("refs/vcpkg/fetch/", get_unique_operation_suffix());
         Command fetch_git_ref = git_cmd_builder(dot_git_dir, work_tree)
                                     .string_arg("fetch")
                                     .string_arg("--update-shallow")
                                     .string_arg("--")
                                     .string_arg(repo)
-                                    .string_arg(treeish);
+                                    .string_arg(Strings::concat('+', treeish, ':', fetch_ref));
 
         auto fetch_output = cmd_execute_and_capture_output(fetch_git_ref);
         if (fetch_output.exit_code != 0)
@@ -1141,37 +1417,33 @@ namespace vcpkg
                     expected_right_tag};
         }
 
-        Command get_fetch_head =
-            git_cmd_builder(dot_git_dir, work_tree).string_arg("rev-parse").string_arg("FETCH_HEAD");
-        auto fetch_head_output = cmd_execute_and_capture_output(get_fetch_head);
-        if (fetch_head_output.exit_code != 0)
+        Command get_fetch_ref = git_cmd_builder(dot_git_dir, work_tree).string_arg("rev-parse").string_arg(fetch_ref);
+        auto fetch_ref_output = cmd_execute_and_capture_output(get_fetch_ref);
+
+        // the ref only exists to identify this fetch's result; remove it so it doesn't keep objects alive
+        Command delete_fetch_ref =
+            git_cmd_builder(dot_git_dir, work_tree).string_arg("update-ref").string_arg("-d").string_arg(fetch_ref);
+        cmd_execute_and_capture_output(delete_fetch_ref);
+
+        if (fetch_ref_output.exit_code != 0)
         {
-            return {Strings::format("Error: Failed to rev-parse FETCH_HEAD.\n%s\n", fetch_head_output.output),
+            return {Strings::format("Error: Failed to rev-parse %s.\n%s\n", fetch_ref, fetch_ref_output.output),
                     expected_right_tag};
         }
-        return {Strings::trim(fetch_head_output.output).to_string(), expected_left_tag};
+        return {Strings::trim(fetch_ref_output.output).to_string(), expected_left_tag};
     }
 
     Optional<std::string> VcpkgPaths::git_fetch(StringView repo, StringView treeish) const
     {
-        auto& fs = get_filesystem();
-
         const auto& work_tree = m_pimpl->m_registries_work_tree_dir;
-        fs.create_directories(work_tree, VCPKG_LINE_INFO);
-
-        auto lock_file = work_tree / ".vcpkg-lock";
-
-        auto guard = fs.take_exclusive_file_lock(lock_file, IgnoreErrors{});
-
         const auto& dot_git_dir = m_pimpl->m_registries_dot_git_dir;
 
-        Command init_registries_git_dir = git_cmd_builder(dot_git_dir, work_tree).string_arg("init");
-        auto init_output = cmd_execute_and_capture_output(init_registries_git_dir);
-        if (init_output.exit_code != 0)
+        auto maybe_guard = lock_registries_git_dir(*this, dot_git_dir, work_tree, RegistriesGitAccess::Fetch);
+        if (!maybe_guard.has_value())
         {
-            return Strings::format(
-                "Error: Failed to initialize local repository %s.\n%s\n", work_tree, init_output.output);
+            return std::move(maybe_guard).error();
         }
+
         Command fetch_git_ref = git_cmd_builder(dot_git_dir, work_tree)
                                     .string_arg("fetch")
                                     .string_arg("--update-shallow")
@@ -1192,6 +1464,13 @@ namespace vcpkg
     // hash
     ExpectedS<std::string> VcpkgPaths::git_show_from_remote_registry(StringView hash, const Path& relative_path) const
     {
+        auto maybe_guard = lock_registries_git_dir(
+            *this, m_pimpl->m_registries_dot_git_dir, m_pimpl->m_registries_work_tree_dir, RegistriesGitAccess::Read);
+        if (!maybe_guard.has_value())
+        {
+            return {std::move(maybe_guard).error(), expected_right_tag};
+        }
+
         auto revision = Strings::format("%s:%s", hash, relative_path.generic_u8string());
         Command git_show = git_cmd_builder(m_pimpl->m_registries_dot_git_dir, m_pimpl->m_registries_work_tree_dir)
                                .string_arg("show")
@@ -1207,6 +1486,13 @@ namespace vcpkg
     ExpectedS<std::string> VcpkgPaths::git_find_object_id_for_remote_registry_path(StringView hash,
                                                                                    const Path& relative_path) const
     {
+        auto maybe_guard = lock_registries_git_dir(
+            *this, m_pimpl->m_registries_dot_git_dir, m_pimpl->m_registries_work_tree_dir, RegistriesGitAccess::Read);
+        if (!maybe_guard.has_value())
+        {
+            return {std::move(maybe_guard).error(), expected_right_tag};
+        }
+
         auto revision = Strings::format("%s:%s", hash, relative_path.generic_u8string());
         Command git_rev_parse = git_cmd_builder(m_pimpl->m_registries_dot_git_dir, m_pimpl->m_registries_work_tree_dir)
                                     .string_arg("rev-parse")
@@ -1221,57 +1507,18 @@ namespace vcpkg
     }
     ExpectedS<Path> VcpkgPaths::git_checkout_object_from_remote_registry(StringView object) const
     {
-        auto& fs = get_filesystem();
-        fs.create_directories(m_pimpl->m_registries_git_trees, VCPKG_LINE_INFO);
-
-        auto git_tree_final = m_pimpl->m_registries_git_trees / object;
-        if (fs.exists(git_tree_final, IgnoreErrors{}))
-        {
-            return git_tree_final;
-        }
-
-        auto pid = get_process_id();
-
-        Path git_tree_temp = Strings::format("%s.tmp%ld", git_tree_final, pid);
-        Path git_tree_temp_tar = Strings::format("%s.tmp%ld.tar", git_tree_final, pid);
-        fs.remove_all(git_tree_temp, VCPKG_LINE_INFO);
-        fs.create_directory(git_tree_temp, VCPKG_LINE_INFO);
-
-        const auto& dot_git_dir = m_pimpl->m_registries_dot_git_dir;
-        Command git_archive = git_cmd_builder(dot_git_dir, m_pimpl->m_registries_work_tree_dir)
-                                  .string_arg("archive")
-                                  .string_arg("--format")
-                                  .string_arg("tar")
-                                  .string_arg(object)
-                                  .string_arg("--output")
-                                  .string_arg(git_tree_temp_tar);
-        auto git_archive_output = cmd_execute_and_capture_output(git_archive);
-        if (git_archive_output.exit_code != 0)
-        {
-            return {Strings::format("git archive failed with message:\n%s", git_archive_output.output),
-                    expected_right_tag};
-        }
-
-        extract_tar_cmake(get_tool_exe(Tools::CMAKE), git_tree_temp_tar, git_tree_temp);
-        // Attempt to remove temporary files, though non-critical.
-        fs.remove(git_tree_temp_tar, IgnoreErrors{});
-
-        std::error_code ec;
-        fs.rename_with_retry(git_tree_temp, git_tree_final, ec);
-        if (fs.exists(git_tree_final, IgnoreErrors{}))
+        auto maybe_guard = lock_registries_git_dir(
+            *this, m_pimpl->m_registries_dot_git_dir, m_pimpl->m_registries_work_tree_dir, RegistriesGitAccess::Read);
+        if (!maybe_guard.has_value())
         {
-            return git_tree_final;
+            return {std::move(maybe_guard).error(), expected_right_tag};
         }
 
-        if (ec)
-        {
-            return {Strings::format("rename to %s failed with message:\n%s", git_tree_final, ec.message()),
-                    expected_right_tag};
-        }
-        else
-        {
-            return {"Unknown error", expected_right_tag};
-        }
+        return git_checkout_tree_to_store(*this,
+                                          m_pimpl->m_registries_git_trees,
+                                          m_pimpl->m_registries_dot_git_dir,
+                                          m_pimpl->m_registries_work_tree_dir,
+                                          object);
     }
 
     Optional<const Json::Object&> VcpkgPaths::get_manifest() const
@@ -402,6 +402,154 @@ namespace vcpkg
         return static_cast<VerComp>(Util::range_lexcomp(a.identifiers, b.identifiers, uint64_comp));
     }
 
+    // bits per component packed into VersionKey::prefix
+    static constexpr int version_key_prefix_bits = 21;
+
+    static void pack_version_key_prefix(VersionKey& key)
+    {
+        constexpr uint64_t limit = uint64_t(1) << version_key_prefix_bits;
+        key.prefix = 0;
+        key.has_prefix = true;
+        for (size_t idx = 0; idx < 3; ++idx)
+        {
+            // missing components pack as 0; this preserves ordering because a shorter list of components with an
+            // equal prefix compares less
+            const uint64_t component = idx < key.numbers.size() ? key.numbers[idx] : 0;
+            if (component >= limit)
+            {
+                key.has_prefix = false;
+                key.prefix = 0;
+                return;
+            }
+
+            key.prefix = (key.prefix << version_key_prefix_bits) | component;
+        }
+    }
+
+    ExpectedL<VersionKey> VersionKey::try_parse(StringView text, VersionScheme scheme)
+    {
+        VersionKey ret;
+        ret.scheme = scheme;
+        switch (scheme)
+        {
+            case VersionScheme::String: ret.text.assign(text.data(), text.size()); return ret;
+            case VersionScheme::Relaxed:
+            case VersionScheme::Semver:
+            {
+                auto maybe_dot = DotVersion::try_parse(text, scheme);
+                auto dot = maybe_dot.get();
+                if (!dot)
+                {
+                    return std::move(maybe_dot).error();
+                }
+
+                ret.text = std::move(dot->original_string);
+                ret.numbers = std::move(dot->version);
+                ret.identifiers.reserve(dot->identifiers.size());
+                for (auto&& identifier : dot->identifiers)
+                {
+                    auto& id = ret.identifiers.emplace_back();
+                    if (auto number = as_numeric(identifier).get())
+                    {
+                        id.is_numeric = true;
+                        id.number = *number;
+                    }
+
+                    id.text = std::move(identifier);
+                }
+                break;
+            }
+            case VersionScheme::Date:
+            {
+                auto maybe_date = DateVersion::try_parse(text);
+                auto date = maybe_date.get();
+                if (!date)
+                {
+                    return std::move(maybe_date).error();
+                }
+
+                // yyyy-mm-dd was validated to be all digits, so comparing the components numerically matches comparing
+                // version_string
+                const StringView date_text = date->version_string;
+                ret.numbers.reserve(3 + date->identifiers.size());
+                ret.numbers.push_back(as_numeric(date_text.substr(0, 4)).value_or_exit(VCPKG_LINE_INFO));
+                ret.numbers.push_back(as_numeric(date_text.substr(5, 2)).value_or_exit(VCPKG_LINE_INFO));
+                ret.numbers.push_back(as_numeric(date_text.substr(8, 2)).value_or_exit(VCPKG_LINE_INFO));
+                ret.numbers.insert(ret.numbers.end(), date->identifiers.begin(), date->identifiers.end());
+                ret.text = std::move(date->original_string);
+                break;
+            }
+            default: Checks::unreachable(VCPKG_LINE_INFO);
+        }
+
+        pack_version_key_prefix(ret);
+        return ret;
+    }
+
+    static int prerelease_identifier_comp(const VersionKey::PrereleaseIdentifier& a,
+                                          const VersionKey::PrereleaseIdentifier& b)
+    {
+        // same ordering as semver_id_comp
+        if (a.is_numeric)
+        {
+            return b.is_numeric ? uint64_comp(a.number, b.number) : -1;
+        }
+
+        if (b.is_numeric)
+        {
+            return 1;
+        }
+
+        return strcmp(a.text.c_str(), b.text.c_str());
+    }
+
+    static bool is_dot_version_scheme(VersionScheme scheme)
+    {
+        return scheme == VersionScheme::Relaxed || scheme == VersionScheme::Semver;
+    }
+
+    VerComp compare(const VersionKey& a, const VersionKey& b)
+    {
+        if (a.scheme != b.scheme && !(is_dot_version_scheme(a.scheme) && is_dot_version_scheme(b.scheme)))
+        {
+            return VerComp::unk;
+        }
+
+        if (a.scheme == VersionScheme::String)
+        {
+            return int_to_vercomp(a.text.compare(b.text));
+        }
+
+        if (a.text == b.text) return VerComp::eq;
+
+        if (a.has_prefix && b.has_prefix && a.prefix != b.prefix)
+        {
+            return a.prefix < b.prefix ? VerComp::lt : VerComp::gt;
+        }
+
+        if (auto x = Util::range_lexcomp(a.numbers, b.numbers, uint64_comp))
+        {
+            return static_cast<VerComp>(x);
+        }
+
+        // 'empty' is special and sorts before everything else
+        // 1.0.0 > 1.0.0-1
+        if (a.identifiers.empty() || b.identifiers.empty())
+        {
+            return static_cast<VerComp>(!b.identifiers.empty() - !a.identifiers.empty());
+        }
+
+        return int_to_vercomp(Util::range_lexcomp(a.identifiers, b.identifiers, prerelease_identifier_comp));
+    }
+
+    const VersionKey& VersionKeyCache::get(VersionScheme scheme, const std::string& text) const
+    {
+        const auto idx = static_cast<size_t>(scheme);
+        Checks::check_exit(VCPKG_LINE_INFO, idx < sizeof(m_keys) / sizeof(m_keys[0]));
+        return m_keys[idx].get_lazy(
+            text, [&]() { return VersionKey::try_parse(text, scheme).value_or_exit(VCPKG_LINE_INFO); });
+    }
+
     StringView normalize_external_version_zeros(StringView sv)
     {
         if (sv.empty()) return "0";